@@ -0,0 +1,453 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <gflags/gflags.h>
+
+#include "tateyama/datastore/archive.h"
+#include "tateyama/datastore/chunk_repository.h"
+#include "tateyama/datastore/compression.h"
+#include "tateyama/datastore/copy_engine.h"
+#include "tateyama/datastore/file_descriptor.h"
+#include "tateyama/datastore/parallel_copy.h"
+
+DEFINE_string(directory, "", "the directory where the files are generated and copied, a directory under the temporary directory if empty");  // NOLINT
+DEFINE_int32(small_files, 2000, "the number of the small files");  // NOLINT
+DEFINE_int64(small_size, 64L * 1024L, "the size of each small file");  // NOLINT
+DEFINE_int32(large_files, 2, "the number of the large files");  // NOLINT
+DEFINE_int64(large_size, 256L * 1024L * 1024L, "the size of each large file");  // NOLINT
+DEFINE_int32(sparse_files, 4, "the number of the sparse files");  // NOLINT
+DEFINE_int64(sparse_size, 256L * 1024L * 1024L, "the size of each sparse file, one sixteenth of which has data");  // NOLINT
+DEFINE_string(cases, "", "the comma separated cases to run, all if empty");  // NOLINT
+DEFINE_string(compress, "zstd", "the compression of the compress case");  // NOLINT
+DEFINE_int32(parallelism, 0, "the number of threads of the parallel cases, 0 means the default of tgctl");  // NOLINT
+DEFINE_bool(cold, true, "evicts the source files from the page cache before each case");  // NOLINT
+DEFINE_bool(keep, false, "keeps the generated files");  // NOLINT
+
+namespace tateyama::datastore::bench {
+
+namespace fs = std::filesystem;
+
+static constexpr std::size_t block_size = 4096;
+static constexpr std::size_t write_size = 1024UL * 1024UL;
+static constexpr std::uintmax_t sparse_stride = 16UL * 1024UL * 1024UL;  // a segment of write_size has data in each stride
+
+/**
+ * @brief the files generated for a case, resembling those in a datastore
+ */
+struct data_set {
+    std::string name;
+    fs::path directory;
+    std::vector<fs::path> files{};
+    std::uintmax_t bytes{};       // the sum of the file sizes
+    std::uintmax_t data_bytes{};  // the bytes excluding the holes
+};
+
+/**
+ * @brief generates the contents, half of each block being random and the other half repeating, which
+ * compress to about a half as the log records and the pages do
+ */
+class content_generator {
+public:
+    void fill(char* buffer, std::size_t length) {
+        for (std::size_t offset = 0; offset < length; offset += block_size) {
+            char* block = buffer + offset;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            std::size_t half = std::min(block_size, length - offset) / 2;
+            for (std::size_t i = 0; i + sizeof(std::uint64_t) <= half; i += sizeof(std::uint64_t)) {
+                auto value = next();
+                std::memcpy(block + i, &value, sizeof(value));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            }
+            for (std::size_t i = half; i < std::min(block_size, length - offset); i++) {
+                block[i] = block[i % 64];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            }
+        }
+    }
+
+private:
+    std::uint64_t state_{0x5453555255474900ULL};
+
+    std::uint64_t next() noexcept {  // splitmix64
+        std::uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27U)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31U);
+    }
+};
+
+static void write_all(int fd, const char* data, std::size_t length, off_t offset, const fs::path& file) {
+    while (length > 0) {
+        auto written = ::pwrite(fd, data, length, offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "could not write " + file.string());
+        }
+        data += written;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        length -= static_cast<std::size_t>(written);
+        offset += written;
+    }
+}
+
+/**
+ * @brief writes a file, which has a hole between each segment of data if sparse
+ * @return the bytes of data written
+ */
+static std::uintmax_t generate_file(const fs::path& file, std::uintmax_t size, bool sparse, content_generator& generator, std::vector<char>& buffer) {
+    file_descriptor fd(::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));  // NOLINT
+    if (fd.get() < 0) {
+        throw std::system_error(errno, std::generic_category(), "could not create " + file.string());
+    }
+    std::uintmax_t data_bytes{};
+    std::uintmax_t step = sparse ? sparse_stride : write_size;
+    for (std::uintmax_t offset = 0; offset < size; offset += step) {
+        auto length = static_cast<std::size_t>(std::min(static_cast<std::uintmax_t>(write_size), size - offset));
+        generator.fill(buffer.data(), length);
+        write_all(fd.get(), buffer.data(), length, static_cast<off_t>(offset), file);
+        data_bytes += length;
+    }
+    if (::ftruncate(fd.get(), static_cast<off_t>(size)) != 0 || ::fdatasync(fd.get()) != 0) {
+        throw std::system_error(errno, std::generic_category(), "could not write " + file.string());
+    }
+    return data_bytes;
+}
+
+static data_set generate(const fs::path& base, const std::string& name, std::int32_t count, std::int64_t size, bool sparse) {
+    data_set set{name, base / name};
+    fs::create_directories(set.directory);
+    content_generator generator{};
+    std::vector<char> buffer(write_size);
+    for (std::int32_t i = 0; i < count; i++) {
+        std::ostringstream file_name{};
+        file_name << name << '_' << std::setw(6) << std::setfill('0') << i;
+        auto file = set.directory / file_name.str();
+        set.data_bytes += generate_file(file, static_cast<std::uintmax_t>(size), sparse, generator, buffer);
+        set.bytes += static_cast<std::uintmax_t>(size);
+        set.files.emplace_back(std::move(file));
+    }
+    return set;
+}
+
+/**
+ * @brief drops the clean pages of the files from the page cache, so that each case reads from the device
+ */
+static void evict(const data_set& set) {
+    for (auto&& file : set.files) {
+        file_descriptor fd(::open(file.c_str(), O_RDONLY | O_CLOEXEC));  // NOLINT
+        if (fd.get() >= 0) {
+            ::posix_fadvise(fd.get(), 0, 0, POSIX_FADV_DONTNEED);
+        }
+    }
+}
+
+/**
+ * @brief flushes the file system holding the directory, so that the time includes writing back the copies
+ */
+static void flush(const fs::path& directory) {
+    file_descriptor fd(::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));  // NOLINT
+    if (fd.get() >= 0) {
+        ::syncfs(fd.get());
+    }
+}
+
+/**
+ * @brief the measurement of a case
+ */
+struct case_result {
+    double wall_seconds{};
+    double cpu_seconds{};  // user and system time of all the threads
+    std::uintmax_t output_bytes{};
+    std::map<std::string, std::size_t> strategies{};
+    std::string note{};
+
+    void count(copy_strategy strategy) {
+        strategies[std::string(to_string_view(strategy))]++;
+    }
+};
+
+class stopwatch {
+public:
+    stopwatch() : wall_(std::chrono::steady_clock::now()), cpu_(cpu_seconds()) {
+    }
+    void stop(case_result& result) const {
+        result.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_).count();
+        result.cpu_seconds = cpu_seconds() - cpu_;
+    }
+
+private:
+    std::chrono::steady_clock::time_point wall_;
+    double cpu_;
+
+    static double cpu_seconds() {
+        struct rusage usage{};
+        ::getrusage(RUSAGE_SELF, &usage);
+        auto seconds = [](const struct timeval& tv) { return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1e6; };
+        return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+    }
+};
+
+/**
+ * @brief a copy path of tgctl backup create
+ */
+struct bench_case {
+    std::string name;
+    std::string description;
+    // prepares the output directory before the measurement, if needed
+    std::function<void(const data_set& set, const fs::path& output)> setup;
+    // copies the files of the data set into the output directory
+    std::function<void(const data_set& set, const fs::path& output, case_result& result)> run;
+};
+
+static std::size_t parallelism() {
+    return static_cast<std::size_t>(std::max(FLAGS_parallelism, 0));
+}
+
+static void copy_sequentially(const data_set& set, const fs::path& output, case_result& result, const copy_options& options) {
+    for (auto&& file : set.files) {
+        result.count(fast_copy_file(file, output / file.filename(), options).strategy);
+    }
+}
+
+static void copy_in_parallel(parallel_copy& copy, case_result& result) {
+    std::mutex mtx{};
+    copy.run([&mtx, &result](const fs::path&, copy_result r, std::uintmax_t, std::uintmax_t) {
+        std::unique_lock<std::mutex> lock(mtx);
+        result.count(r.strategy);
+    });
+    std::ostringstream note{};
+    note << copy.parallelism() << " threads";
+    result.note = note.str();
+}
+
+static std::vector<bench_case> all_cases() {
+    std::vector<bench_case> cases{};
+    cases.emplace_back(bench_case{"copy_file", "std::filesystem::copy_file() sequentially, as tgctl did before the copy engine", nullptr,
+        [](const data_set& set, const fs::path& output, case_result& result) {
+            for (auto&& file : set.files) {
+                fs::copy_file(file, output / file.filename());
+            }
+            result.strategies["copy_file"] = set.files.size();
+        }});
+    cases.emplace_back(bench_case{"fast_copy", "fast_copy_file() sequentially, reflink or copy_file_range as the file system allows", nullptr,
+        [](const data_set& set, const fs::path& output, case_result& result) {
+            copy_sequentially(set, output, result, copy_options{});
+        }});
+    cases.emplace_back(bench_case{"checksum", "fast_copy_file() sequentially with CRC32C", nullptr,
+        [](const data_set& set, const fs::path& output, case_result& result) {
+            copy_sequentially(set, output, result, copy_options{true});
+        }});
+    cases.emplace_back(bench_case{"direct_io", "fast_copy_file() sequentially with CRC32C and O_DIRECT, as --direct-io", nullptr,
+        [](const data_set& set, const fs::path& output, case_result& result) {
+            copy_sequentially(set, output, result, copy_options{true, nullptr, false, true});
+        }});
+    cases.emplace_back(bench_case{"parallel", "parallel_copy with CRC32C, as backup create", nullptr,
+        [](const data_set& set, const fs::path& output, case_result& result) {
+            parallel_copy copy(parallelism());
+            copy.compute_checksum(true);
+            for (auto&& file : set.files) {
+                copy.add(file, output / file.filename());
+            }
+            copy_in_parallel(copy, result);
+        }});
+    cases.emplace_back(bench_case{"clone", "parallel_copy cloning the unchanged files from the previous backup by FICLONE, or copying them where the file system does not support it, as backup create --incremental-from",
+        [](const data_set& set, const fs::path& output) {
+            fs::create_directories(output / "previous");
+            for (auto&& file : set.files) {
+                fast_copy_file(file, output / "previous" / file.filename());
+            }
+            fs::create_directories(output / "current");
+        },
+        [](const data_set& set, const fs::path& output, case_result& result) {
+            parallel_copy copy(parallelism());
+            copy.compute_checksum(true);
+            for (auto&& file : set.files) {
+                copy.add(file, output / "current" / file.filename(), output / "previous" / file.filename());
+            }
+            copy_in_parallel(copy, result);
+        }});
+    cases.emplace_back(bench_case{"compress", "parallel_copy compressing the files, as backup create --compress", nullptr,
+        [](const data_set& set, const fs::path& output, case_result& result) {
+            auto comp = parse_compression(FLAGS_compress);
+            if (!comp || !compression_available(comp->codec)) {
+                result.note = "skipped, as " + FLAGS_compress + " is not available";
+                return;
+            }
+            parallel_copy copy(parallelism());
+            copy.compress(comp.value());
+            for (auto&& file : set.files) {
+                copy.add(file, output / (file.filename().string() + std::string(compressed_suffix)));
+            }
+            copy_in_parallel(copy, result);
+            result.note += ", " + to_string(comp.value());
+        }});
+    cases.emplace_back(bench_case{"stream", "archive_writer into a file, as backup create --stream", nullptr,
+        [](const data_set& set, const fs::path& output, case_result& result) {
+            auto archive = output / "backup.tar";
+            file_descriptor fd(::open(archive.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));  // NOLINT
+            if (fd.get() < 0) {
+                throw std::system_error(errno, std::generic_category(), "could not create " + archive.string());
+            }
+            archive_writer writer(fd.get());
+            for (auto&& file : set.files) {
+                result.count(writer.add(file, file.filename().string()).strategy);
+            }
+            writer.finish();
+        }});
+    cases.emplace_back(bench_case{"repository", "chunk_repository storing a first generation, as backup create --repository", nullptr,
+        [](const data_set& set, const fs::path& output, case_result& result) {
+            chunk_repository repository{output / "repository"};
+            std::vector<repository_source> sources{};
+            for (auto&& file : set.files) {
+                sources.emplace_back(repository_source{file, file.filename().string(), false, false});
+            }
+            repository.store(sources, std::nullopt, parallelism(), copy_options{}, nullptr);
+            result.strategies["chunk"] = set.files.size();
+            std::ostringstream note{};
+            note << repository.stats().new_chunks << " new chunks";
+            result.note = note.str();
+        }});
+    return cases;
+}
+
+static std::set<std::string> selected_cases() {
+    std::set<std::string> selected{};
+    std::istringstream strm(FLAGS_cases);
+    std::string name{};
+    while (std::getline(strm, name, ',')) {
+        if (!name.empty()) {
+            selected.emplace(name);
+        }
+    }
+    return selected;
+}
+
+static std::string mebibytes(std::uintmax_t bytes) {
+    std::ostringstream strm{};
+    strm << std::fixed << std::setprecision(1) << static_cast<double>(bytes) / (1024.0 * 1024.0) << " MiB";
+    return strm.str();
+}
+
+static void report_header(const data_set& set) {
+    std::cout << '\n' << set.name << ": " << set.files.size() << " files, " << mebibytes(set.bytes)
+              << " (data " << mebibytes(set.data_bytes) << ")\n";
+    std::cout << std::left << std::setw(12) << "case" << std::right
+              << std::setw(10) << "wall[s]" << std::setw(10) << "MiB/s" << std::setw(10) << "cpu[s]" << std::setw(8) << "cpu[%]"
+              << "  strategies\n";
+}
+
+static void report(const data_set& set, const bench_case& c, const case_result& result) {
+    std::cout << std::left << std::setw(12) << c.name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << result.wall_seconds
+              << std::setprecision(1)
+              << std::setw(10) << (result.wall_seconds > 0 ? static_cast<double>(set.bytes) / (1024.0 * 1024.0) / result.wall_seconds : 0.0)
+              << std::setprecision(3)
+              << std::setw(10) << result.cpu_seconds
+              << std::setprecision(0)
+              << std::setw(8) << (result.wall_seconds > 0 ? result.cpu_seconds / result.wall_seconds * 100.0 : 0.0)
+              << ' ';
+    for (auto&& [strategy, count] : result.strategies) {
+        std::cout << ' ' << strategy << ':' << count;
+    }
+    if (!result.note.empty()) {
+        std::cout << " (" << result.note << ')';
+    }
+    std::cout << std::endl;
+}
+
+static int run() {
+    auto base = FLAGS_directory.empty()
+        ? fs::temp_directory_path() / ("tgctl-bench-" + std::to_string(::getpid()))
+        : fs::path(FLAGS_directory);
+    auto selected = selected_cases();
+    auto cases = all_cases();
+    for (auto&& name : selected) {
+        if (std::none_of(cases.begin(), cases.end(), [&name](const bench_case& c) { return c.name == name; })) {
+            std::cerr << "could not run the case " << name << ", as it is unknown\n" << std::flush;
+            return 1;
+        }
+    }
+
+    std::cout << "generating the files in " << base.string() << std::endl;
+    std::vector<data_set> sets{};
+    sets.emplace_back(generate(base / "source", "small", FLAGS_small_files, FLAGS_small_size, false));
+    sets.emplace_back(generate(base / "source", "large", FLAGS_large_files, FLAGS_large_size, false));
+    sets.emplace_back(generate(base / "source", "sparse", FLAGS_sparse_files, FLAGS_sparse_size, true));
+
+    for (auto&& set : sets) {
+        if (set.files.empty()) {
+            continue;
+        }
+        report_header(set);
+        for (auto&& c : cases) {
+            if (!selected.empty() && selected.find(c.name) == selected.end()) {
+                continue;
+            }
+            auto output = base / "output";
+            fs::remove_all(output);
+            fs::create_directories(output);
+            if (c.setup) {
+                c.setup(set, output);
+                flush(output);
+            }
+            if (FLAGS_cold) {
+                evict(set);
+            }
+            case_result result{};
+            stopwatch watch{};
+            c.run(set, output, result);
+            flush(output);
+            watch.stop(result);
+            report(set, c, result);
+            fs::remove_all(output);
+        }
+    }
+    if (!FLAGS_keep) {
+        fs::remove_all(base);
+    }
+    return 0;
+}
+
+}  // tateyama::datastore::bench
+
+int main(int argc, char* argv[]) {
+    gflags::SetUsageMessage("benchmark of the copy paths of tgctl backup create");
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    try {
+        return tateyama::datastore::bench::run();
+    } catch (std::exception const& e) {
+        std::cerr << "could not run the benchmark, as " << e.what() << '\n' << std::flush;
+        return 1;
+    }
+}
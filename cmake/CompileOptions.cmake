@@ -42,3 +42,8 @@ if(ENABLE_ALTIMETER)
     add_definitions(-DENABLE_ALTIMETER)
 endif()
 
+if(ENABLE_BACKUP_COMPRESSION)
+    message("backup compression enabled")
+    add_definitions(-DENABLE_BACKUP_COMPRESSION)
+endif()
+
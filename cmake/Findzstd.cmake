@@ -0,0 +1,38 @@
+# Copyright 2026-2026 Project Tsurugi.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+if(TARGET zstd::zstd)
+    return()
+endif()
+
+find_library(zstd_LIBRARY_FILE NAMES zstd)
+find_path(zstd_INCLUDE_DIR NAMES zstd.h)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(zstd DEFAULT_MSG
+    zstd_LIBRARY_FILE
+    zstd_INCLUDE_DIR)
+
+if(zstd_LIBRARY_FILE AND zstd_INCLUDE_DIR)
+    set(zstd_FOUND ON)
+    add_library(zstd::zstd SHARED IMPORTED)
+    set_target_properties(zstd::zstd PROPERTIES
+        IMPORTED_LOCATION "${zstd_LIBRARY_FILE}"
+        INTERFACE_INCLUDE_DIRECTORIES "${zstd_INCLUDE_DIR}")
+else()
+    set(zstd_FOUND OFF)
+endif()
+
+unset(zstd_LIBRARY_FILE CACHE)
+unset(zstd_INCLUDE_DIR CACHE)
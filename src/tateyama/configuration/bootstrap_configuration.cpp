@@ -101,6 +101,12 @@ static constexpr std::string_view default_configuration {  // NOLINT
     "[system]\n"
         "pid_directory=/var/lock\n"
         "instance_id=\n"  // update to default value later
+        "cpu_affinity=\n"
+        "numa_memory_policy=default\n"
+        "numa_nodes=\n"
+        "memory_lock=false\n"
+        "transparent_huge_pages=false\n"
+        "prefault_memory=false\n"
 
     "[authentication]\n"
         "enabled=false\n"
@@ -0,0 +1,443 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "archive.h"
+#include "crc32c.h"
+#include "file_descriptor.h"
+#include "io_control.h"
+#include "progress_meter.h"
+
+namespace tateyama::datastore {
+
+constexpr std::size_t block_size = 512;
+constexpr std::size_t end_of_archive_blocks = 2;
+constexpr std::uintmax_t extended_header_max = 1024UL * 1024UL;
+
+// the fields of the ustar header
+constexpr std::size_t name_offset = 0;
+constexpr std::size_t name_length = 100;
+constexpr std::size_t mode_offset = 100;
+constexpr std::size_t uid_offset = 108;
+constexpr std::size_t gid_offset = 116;
+constexpr std::size_t id_length = 8;
+constexpr std::size_t size_offset = 124;
+constexpr std::size_t size_length = 12;
+constexpr std::size_t mtime_offset = 136;
+constexpr std::size_t mtime_length = 12;
+constexpr std::size_t checksum_offset = 148;
+constexpr std::size_t checksum_length = 8;
+constexpr std::size_t typeflag_offset = 156;
+constexpr std::size_t magic_offset = 257;
+constexpr std::size_t prefix_offset = 345;
+constexpr std::size_t prefix_length = 155;
+
+using header_block = std::array<char, block_size>;
+
+static std::uintmax_t padding_of(std::uintmax_t size) noexcept {
+    return (block_size - size % block_size) % block_size;
+}
+
+// writes the value in octal digits followed by NUL, returns false if it does not fit
+static bool put_octal(char* field, std::size_t width, std::uintmax_t value) noexcept {
+    field[width - 1] = '\0';  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    for (std::size_t i = width - 1; i > 0; i--) {
+        field[i - 1] = static_cast<char>('0' + (value & 7U));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        value >>= 3U;
+    }
+    return value == 0;
+}
+
+// the size larger than 11 octal digits allow is written in the base-256 encoding of GNU tar
+static void put_size(char* field, std::uintmax_t size) noexcept {
+    if (put_octal(field, size_length, size)) {
+        return;
+    }
+    for (std::size_t i = size_length; i > 1; i--) {
+        field[i - 1] = static_cast<char>(size & 0xffU);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        size >>= 8U;
+    }
+    field[0] = static_cast<char>(0x80U);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+static std::uintmax_t parse_number(const char* field, std::size_t width) {
+    std::uintmax_t value = 0;
+    if ((static_cast<unsigned char>(field[0]) & 0x80U) != 0) {  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        for (std::size_t i = 1; i < width; i++) {
+            value = (value << 8U) | static_cast<unsigned char>(field[i]);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+        return value;
+    }
+    std::size_t i = 0;
+    while (i < width && field[i] == ' ') {  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        i++;
+    }
+    for (; i < width && field[i] >= '0' && field[i] <= '7'; i++) {  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        value = (value << 3U) | static_cast<unsigned>(field[i] - '0');  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    return value;
+}
+
+// the sum of the bytes of the header, in which the checksum field is regarded as spaces
+static std::uintmax_t header_checksum(const header_block& header) noexcept {
+    std::uintmax_t sum = 0;
+    for (std::size_t i = 0; i < block_size; i++) {
+        sum += (i >= checksum_offset && i < checksum_offset + checksum_length) ? ' ' : static_cast<unsigned char>(header.at(i));
+    }
+    return sum;
+}
+
+[[noreturn]] static void throw_stream_error(int err, const std::string& what) {
+    throw std::system_error(err, std::system_category(), what);
+}
+
+archive_writer::archive_writer(int fd) : fd_(fd), buffer_(buffer_size) {
+}
+
+void archive_writer::flush() {
+    for (std::size_t written = 0; written < used_; ) {
+        auto n = write(fd_, buffer_.data() + written, used_ - written);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_stream_error(errno, "cannot write the stream");
+        }
+        written += n;
+    }
+    written_ += used_;
+    used_ = 0;
+}
+
+void archive_writer::put(const char* data, std::size_t length) {
+    while (length > 0) {
+        if (used_ == buffer_.size()) {
+            flush();
+        }
+        auto n = std::min(length, buffer_.size() - used_);
+        std::memcpy(buffer_.data() + used_, data, n);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        used_ += n;
+        data += n;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        length -= n;
+    }
+}
+
+void archive_writer::pad() {
+    static const header_block zeros{};
+    put(zeros.data(), padding_of(written_ + used_));
+}
+
+void archive_writer::put_header(const std::string& name, std::uintmax_t size, std::uint32_t mode, std::int64_t mtime) {
+    if (name.empty() || name.size() > name_length) {
+        throw std::filesystem::filesystem_error("cannot archive the file, as the name is too long", name, std::error_code(ENAMETOOLONG, std::system_category()));
+    }
+    header_block header{};
+    std::memcpy(header.data() + name_offset, name.data(), name.size());  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    put_octal(header.data() + mode_offset, id_length, mode & 07777U);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    put_octal(header.data() + uid_offset, id_length, geteuid());  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    put_octal(header.data() + gid_offset, id_length, getegid());  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    put_size(header.data() + size_offset, size);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    put_octal(header.data() + mtime_offset, mtime_length, static_cast<std::uintmax_t>(std::max(mtime, static_cast<std::int64_t>(0))));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    header.at(typeflag_offset) = '0';
+    std::memcpy(header.data() + magic_offset, "ustar\0" "00", 8);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    put_octal(header.data() + checksum_offset, checksum_length - 1, header_checksum(header));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    header.at(checksum_offset + checksum_length - 1) = ' ';
+    put(header.data(), header.size());
+}
+
+copy_result archive_writer::add(const std::filesystem::path& src, const std::string& name, const copy_options& options) {
+    file_descriptor in(open(src.c_str(), O_RDONLY | O_CLOEXEC));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    if (in.get() < 0) {
+        throw std::filesystem::filesystem_error("cannot open the file", src, std::error_code(errno, std::system_category()));
+    }
+    struct stat st{};
+    if (fstat(in.get(), &st) != 0) {
+        throw std::filesystem::filesystem_error("cannot stat the file", src, std::error_code(errno, std::system_category()));
+    }
+    if (!S_ISREG(st.st_mode)) {  // NOLINT(hicpp-signed-bitwise)
+        throw std::filesystem::filesystem_error("not a regular file", src, std::error_code(EINVAL, std::system_category()));
+    }
+    posix_fadvise(in.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // the size is fixed by the header, thus the data appended during the backup is not archived
+    auto size = static_cast<off_t>(st.st_size);
+    put_header(name, static_cast<std::uintmax_t>(size), st.st_mode, st.st_mtim.tv_sec);
+    std::uint32_t crc = 0;
+    for (off_t offset = 0; offset < size; ) {
+        if (used_ == buffer_.size()) {
+            flush();
+        }
+        // read directly into the buffer of the stream
+        auto length = std::min(buffer_.size() - used_, static_cast<std::size_t>(size - offset));
+        if (options.limiter != nullptr) {
+            options.limiter->acquire(length);
+        }
+        auto n = pread(in.get(), buffer_.data() + used_, length, offset);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::filesystem::filesystem_error("cannot read the file", src, std::error_code(errno, std::system_category()));
+        }
+        if (n == 0) {
+            throw std::filesystem::filesystem_error("the file has been truncated while being archived", src, std::error_code(EIO, std::system_category()));
+        }
+        crc = crc32c(crc, buffer_.data() + used_, static_cast<std::size_t>(n));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (options.drop_cache) {
+            posix_fadvise(in.get(), offset, n, POSIX_FADV_DONTNEED);
+        }
+        if (options.meter != nullptr) {
+            options.meter->add(static_cast<std::uintmax_t>(n));
+        }
+        used_ += n;
+        offset += n;
+    }
+    pad();
+    return copy_result{copy_strategy::stream, static_cast<std::uintmax_t>(size), crc};
+}
+
+void archive_writer::add_data(const std::string& name, std::string_view data) {
+    put_header(name, data.size(), 0644, static_cast<std::int64_t>(time(nullptr)));
+    put(data.data(), data.size());
+    pad();
+}
+
+void archive_writer::finish() {
+    static const header_block zeros{};
+    for (std::size_t i = 0; i < end_of_archive_blocks; i++) {
+        put(zeros.data(), zeros.size());
+    }
+    flush();
+}
+
+archive_reader::archive_reader(int fd) : fd_(fd), buffer_(archive_writer::buffer_size) {
+}
+
+// reads the stream until the buffer becomes full, so that the files are written in large blocks
+bool archive_reader::fill() {
+    if (begin_ < end_) {
+        return true;
+    }
+    begin_ = 0;
+    end_ = 0;
+    while (!eof_ && end_ < buffer_.size()) {
+        auto n = read(fd_, buffer_.data() + end_, buffer_.size() - end_);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_stream_error(errno, "cannot read the stream");
+        }
+        if (n == 0) {
+            eof_ = true;
+            break;
+        }
+        end_ += n;
+        read_ += n;
+    }
+    return begin_ < end_;
+}
+
+bool archive_reader::read_block(char* block) {
+    for (std::size_t copied = 0; copied < block_size; ) {
+        if (!fill()) {
+            if (copied == 0) {
+                return false;
+            }
+            throw std::runtime_error("the stream ends in the middle of a header");
+        }
+        auto n = std::min(block_size - copied, end_ - begin_);
+        std::memcpy(block + copied, buffer_.data() + begin_, n);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        begin_ += n;
+        copied += n;
+    }
+    return true;
+}
+
+void archive_reader::skip(std::uintmax_t length) {
+    while (length > 0) {
+        if (!fill()) {
+            throw std::runtime_error("the stream ends unexpectedly");
+        }
+        auto n = std::min(length, static_cast<std::uintmax_t>(end_ - begin_));
+        begin_ += n;
+        length -= n;
+    }
+}
+
+std::string archive_reader::read_string(std::uintmax_t length) {
+    if (length > extended_header_max) {
+        throw std::runtime_error("the extended header is too large");
+    }
+    std::string data{};
+    while (data.size() < length) {
+        if (!fill()) {
+            throw std::runtime_error("the stream ends in the middle of an extended header");
+        }
+        auto n = std::min(length - data.size(), static_cast<std::uintmax_t>(end_ - begin_));
+        data.append(buffer_.data() + begin_, n);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        begin_ += n;
+    }
+    skip(padding_of(length));
+    return data;
+}
+
+// parses the records of a pax extended header, "<length> <key>=<value>\n"
+static void parse_pax_header(const std::string& data, std::string& path, std::uintmax_t& size, bool& has_size) {
+    std::size_t position = 0;
+    while (position < data.size()) {
+        auto space = data.find(' ', position);
+        if (space == std::string::npos) {
+            throw std::runtime_error("the pax extended header is broken");
+        }
+        std::size_t length = 0;
+        try {
+            length = std::stoul(data.substr(position, space - position));
+        } catch (std::logic_error const& e) {
+            throw std::runtime_error("the pax extended header is broken");
+        }
+        if (length <= space - position + 1 || position + length > data.size() || data.at(position + length - 1) != '\n') {
+            throw std::runtime_error("the pax extended header is broken");
+        }
+        auto record = data.substr(space + 1, position + length - 1 - (space + 1));
+        if (auto equal = record.find('='); equal != std::string::npos) {
+            auto key = record.substr(0, equal);
+            auto value = record.substr(equal + 1);
+            if (key == "path") {
+                path = value;
+            } else if (key == "size") {
+                size = std::stoull(value);
+                has_size = true;
+            }
+        }
+        position += length;
+    }
+}
+
+// removes the leading "./", and rejects the names out of the directory
+static std::string file_name_in_archive(std::string name) {
+    while (name.rfind("./", 0) == 0) {
+        name.erase(0, 2);
+    }
+    if (name.empty() || name == "." || name == ".." || name.find('/') != std::string::npos) {
+        throw std::runtime_error("the archive has an invalid file name '" + name + "'");
+    }
+    return name;
+}
+
+std::vector<extracted_file> archive_reader::extract(const std::filesystem::path& directory, const extract_callback& callback) {  //NOLINT(readability-function-cognitive-complexity)
+    std::vector<extracted_file> files{};
+    std::string long_name{};
+    // not std::optional, on which GCC warns of maybe-uninitialized at -O2
+    std::uintmax_t long_size = 0;
+    bool has_long_size = false;
+    header_block header{};
+    while (read_block(header.data())) {
+        if (std::all_of(header.begin(), header.end(), [](char c){ return c == '\0'; })) {
+            // the end of the archive, the rest is read through so that the writer does not fail on a closed pipe
+            while (fill()) {
+                begin_ = end_;
+            }
+            return files;
+        }
+        if (parse_number(header.data() + checksum_offset, checksum_length) != header_checksum(header)) {  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            throw std::runtime_error("the stream is not a tar archive, or it is broken");
+        }
+
+        auto size = has_long_size ? long_size : parse_number(header.data() + size_offset, size_length);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        std::string name{};
+        if (!long_name.empty()) {
+            name = long_name;
+        } else {
+            name.assign(header.data() + name_offset, strnlen(header.data() + name_offset, name_length));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            if (header.at(prefix_offset) != '\0') {
+                name = std::string(header.data() + prefix_offset, strnlen(header.data() + prefix_offset, prefix_length)) + "/" + name;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            }
+        }
+        long_name.clear();
+        long_size = 0;
+        has_long_size = false;
+
+        switch (header.at(typeflag_offset)) {
+        case 'L':  // the long name of the next entry by GNU tar
+            long_name = read_string(size);
+            long_name.resize(strnlen(long_name.c_str(), long_name.size()));
+            continue;
+        case 'x':  // the pax extended header of the next entry
+            parse_pax_header(read_string(size), long_name, long_size, has_long_size);
+            continue;
+        case 'g':  // the pax global header
+            skip(size + padding_of(size));
+            continue;
+        case '5':  // a directory, only the top is accepted
+            if (name == "." || name == "./") {
+                continue;
+            }
+            throw std::runtime_error("the archive has a directory '" + name + "', which is not in a backup");
+        case '0':
+        case '\0':
+            break;
+        default:
+            throw std::runtime_error("the archive has '" + name + "' of an unsupported type");
+        }
+
+        extracted_file file{file_name_in_archive(name), size, 0};
+        auto dst = directory / file.name;
+        auto mode = static_cast<mode_t>(parse_number(header.data() + mode_offset, id_length) & 0777U) | S_IRUSR | S_IWUSR;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic, hicpp-signed-bitwise)
+        file_descriptor out(open(dst.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+        if (out.get() < 0) {
+            throw std::filesystem::filesystem_error("cannot create the file", dst, std::error_code(errno, std::system_category()));
+        }
+        for (std::uintmax_t remaining = size; remaining > 0; ) {
+            if (!fill()) {
+                throw std::runtime_error("the stream ends in the middle of '" + file.name + "'");
+            }
+            auto n = static_cast<std::size_t>(std::min(remaining, static_cast<std::uintmax_t>(end_ - begin_)));
+            const auto* data = buffer_.data() + begin_;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            file.checksum = crc32c(file.checksum, data, n);
+            for (std::size_t written = 0; written < n; ) {
+                auto w = write(out.get(), data + written, n - written);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                if (w < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw std::filesystem::filesystem_error("cannot write the file", dst, std::error_code(errno, std::system_category()));
+                }
+                written += w;
+            }
+            begin_ += n;
+            remaining -= n;
+        }
+        skip(padding_of(size));
+        if (callback) {
+            callback(file, read_);
+        }
+        files.emplace_back(std::move(file));
+    }
+    // tar(1) tolerates a stream without the end of the archive, and so does this
+    return files;
+}
+
+}  // tateyama::datastore
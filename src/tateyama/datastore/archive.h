@@ -0,0 +1,134 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "copy_engine.h"
+
+namespace tateyama::datastore {
+
+/**
+ * @brief writes the files of a backup sequentially into a stream in the tar (ustar) format
+ * @details the stream can be unpacked by tar(1) as well as archive_reader. The size of a file larger than
+ * the ustar format allows is written in the base-256 encoding of GNU tar.
+ */
+class archive_writer {
+public:
+    static constexpr std::size_t buffer_size = 4UL * 1024UL * 1024UL;
+
+    /**
+     * @brief create an archive_writer
+     * @param fd the file descriptor of the stream, such as a pipe, which is not closed by the archive_writer
+     */
+    explicit archive_writer(int fd);
+
+    /**
+     * @brief writes a file into the stream
+     * @param src the file
+     * @param name the name of the file in the archive
+     * @param options the rate limit and dropping the page cache of the source are applied
+     * @return the size and CRC32C of the file written
+     * @throws std::filesystem::filesystem_error if the file cannot be read
+     * @throws std::system_error if the stream cannot be written
+     */
+    copy_result add(const std::filesystem::path& src, const std::string& name, const copy_options& options = {});
+
+    /**
+     * @brief writes the data as a file into the stream
+     * @throws std::system_error if the stream cannot be written
+     */
+    void add_data(const std::string& name, std::string_view data);
+
+    /**
+     * @brief writes the end of the archive and flushes the buffer
+     * @throws std::system_error if the stream cannot be written
+     */
+    void finish();
+
+    /**
+     * @brief returns the bytes written into the stream so far
+     */
+    [[nodiscard]] std::uintmax_t bytes_written() const noexcept {
+        return written_;
+    }
+
+private:
+    int fd_;
+    std::vector<char> buffer_;
+    std::size_t used_{};
+    std::uintmax_t written_{};
+
+    void put_header(const std::string& name, std::uintmax_t size, std::uint32_t mode, std::int64_t mtime);
+    void put(const char* data, std::size_t length);
+    void pad();
+    void flush();
+};
+
+/**
+ * @brief a file extracted by archive_reader
+ */
+struct extracted_file {
+    std::string name;
+    std::uintmax_t size;
+    std::uint32_t checksum;  // CRC32C
+};
+
+/**
+ * @brief extracts the files from a stream written by archive_writer or tar(1)
+ * @details the stream is read and the files are written in large blocks. Only the regular files at the top
+ * of the archive are accepted, as a backup has no subdirectory.
+ */
+class archive_reader {
+public:
+    using extract_callback = std::function<void(const extracted_file& file, std::uintmax_t bytes_read)>;
+
+    /**
+     * @brief create an archive_reader
+     * @param fd the file descriptor of the stream, which is not closed by the archive_reader
+     */
+    explicit archive_reader(int fd);
+
+    /**
+     * @brief extracts all the files into the directory
+     * @param directory the directory, in which none of the files may exist
+     * @param callback called each time a file has been extracted
+     * @return the files extracted
+     * @throws std::runtime_error if the stream is not a valid archive
+     * @throws std::system_error or std::filesystem::filesystem_error on an I/O error
+     */
+    std::vector<extracted_file> extract(const std::filesystem::path& directory, const extract_callback& callback);
+
+private:
+    int fd_;
+    std::vector<char> buffer_;
+    std::size_t begin_{};
+    std::size_t end_{};
+    bool eof_{};
+    std::uintmax_t read_{};
+
+    bool fill();
+    bool read_block(char* block);
+    void skip(std::uintmax_t length);
+    std::string read_string(std::uintmax_t length);
+};
+
+}  // tateyama::datastore
@@ -13,14 +13,24 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <exception>
 #include <iostream>
 #include <string_view>
 #include <cstring>
 #include <sys/ioctl.h>
 #include <termios.h>
 #include <filesystem>
+#include <iomanip>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <thread>
+#include <unistd.h>
 
 #include <gflags/gflags.h>
 
@@ -32,8 +42,21 @@
 #include "tateyama/transport/transport.h"
 #include "tateyama/tgctl/runtime_error.h"
 #include "tateyama/monitor/monitor.h"
+#include "tateyama/process/proc_mutex.h"
+#include "archive.h"
 #include "backup.h"
+#include "backup_journal.h"
+#include "chunk_repository.h"
 #include "file_list.h"
+#include "manifest.h"
+#include "compression.h"
+#include "copy_sample.h"
+#include "crc32c.h"
+#include "file_descriptor.h"
+#include "io_control.h"
+#include "parallel_copy.h"
+#include "progress_meter.h"
+#include "restore_job.h"
 
 // common
 DECLARE_string(conf);  // NOLINT
@@ -45,6 +68,22 @@ DEFINE_bool(force, false, "no confirmation step");  // NOLINT
 DEFINE_bool(_keep_backup, true, "backup files will be kept");  // NOLINT
 DEFINE_bool(keep_backup, true, "backup files will be kept");  // NOLINT obsolete
 DEFINE_string(use_file_list, "", "json file describing the individual files to be specified for restore");  // NOLINT
+DEFINE_int32(parallel, 0, "the number of threads copying files, 0 means it is determined from the numbers of cores and devices");  // NOLINT
+DEFINE_string(incremental_from, "", "the previous backup, from which the unchanged files are cloned by reflinks instead of being copied where the file system supports it");  // NOLINT
+DEFINE_string(compress, "", "compression of the backup files, zstd or lz4 optionally followed by :level");  // NOLINT
+DEFINE_string(staging_dir, "", "the directory where a compressed backup is decompressed before restore");  // NOLINT
+DEFINE_int32(max_rate, 0, "the maximum rate of reading the database files in MB/s, 0 means unlimited");  // NOLINT
+DEFINE_string(io_class, "", "the I/O scheduling class of tgctl while copying, idle or best-effort");  // NOLINT
+DEFINE_bool(drop_cache, false, "drop the pages of the files copied from the page cache");  // NOLINT
+DEFINE_bool(direct_io, false, "copy the files with O_DIRECT, bypassing the page cache");  // NOLINT
+DEFINE_bool(wait, false, "wait for the restore to finish, reporting its progress");  // NOLINT
+DEFINE_string(backup_type, "", "standard or transaction, the backup is created by BackupDetailBegin of the type if specified");  // NOLINT
+DEFINE_bool(resume, false, "resume the backup interrupted, skipping the files completed and unchanged");  // NOLINT
+DEFINE_bool(progress, false, "report the progress of backup create on the standard error as the bytes are copied");  // NOLINT
+DEFINE_string(repository, "", "the chunk repository into which the backup is stored as a generation, or from which a generation is restored");  // NOLINT
+DEFINE_int32(sample_size, 0, "the size of the sample copied by backup estimate in MB to measure the copy rate, no sample is taken if 0");  // NOLINT
+DEFINE_bool(offline, false, "create the backup by copying the datastore files directly, without starting tsurugidb, when it is not running");  // NOLINT
+DEFINE_string(stream, "", "the file or pipe into which the backup is written, or from which it is restored, in the tar format, - means stdout or stdin");  // NOLINT
 
 namespace tateyama::datastore {
 
@@ -99,6 +138,450 @@ static bool prompt(std::string_view msg)
     return rtnv;
 }
 
+namespace {
+
+// the directory into which a compressed backup is decompressed, which is removed on destruction
+class staging_directory {
+public:
+    explicit staging_directory(std::filesystem::path location) : location_(std::move(location)) {
+        std::filesystem::create_directories(location_);
+    }
+    ~staging_directory() {
+        std::error_code ec{};
+        std::filesystem::remove_all(location_, ec);
+    }
+    staging_directory(staging_directory const& other) = delete;
+    staging_directory& operator=(staging_directory const& other) = delete;
+    staging_directory(staging_directory&& other) noexcept = delete;
+    staging_directory& operator=(staging_directory&& other) noexcept = delete;
+
+    [[nodiscard]] const std::filesystem::path& location() const noexcept {
+        return location_;
+    }
+private:
+    std::filesystem::path location_;
+};
+
+// the stream given by --stream, which is the standard input or output if "-"
+class backup_stream {
+public:
+    backup_stream(const std::string& name, bool output) {
+        if (name == "-") {
+            fd_ = output ? STDOUT_FILENO : STDIN_FILENO;
+            if (isatty(fd_) != 0) {
+                throw tgctl::runtime_error(monitor::reason::invalid_argument, output ? "could not write the backup stream, as the standard output is a terminal" : "could not read the backup stream, as the standard input is a terminal");
+            }
+        } else {
+            file_ = std::make_unique<file_descriptor>(output ? open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600) : open(name.c_str(), O_RDONLY | O_CLOEXEC));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+            if (file_->get() < 0) {
+                throw tgctl::runtime_error(monitor::reason::io, "could not open " + name + ", as " + std::strerror(errno));
+            }
+            fd_ = file_->get();
+        }
+        if (output) {
+            // a closed pipe is reported as an error of write(2) instead of killing tgctl, so that BackupEnd is sent
+            signal(SIGPIPE, SIG_IGN);  // NOLINT(cert-err33-c)
+        }
+    }
+
+    [[nodiscard]] int fd() const noexcept {
+        return fd_;
+    }
+private:
+    int fd_{-1};
+    std::unique_ptr<file_descriptor> file_{};
+};
+
+}  // namespace
+
+namespace {
+
+// a file to be copied into the backup directory
+struct backup_file {
+    std::filesystem::path source;
+    std::string destination;  // the path relative to the backup directory
+    bool is_mutable;
+    bool detached;
+};
+
+}  // namespace
+
+// the files named as the metadata of tgctl are skipped, as they would be overwritten by the manifest or the journal
+static std::vector<backup_file> backup_files_of(const ::tateyama::proto::datastore::response::BackupBegin::Success& success) {
+    std::vector<backup_file> files{};
+    if (success.has_detail_source()) {
+        for (auto&& file : success.detail_source().detail_files()) {
+            auto destination = std::filesystem::path(file.destination()).lexically_normal();
+            if (destination.empty() || destination.is_absolute() || *destination.begin() == "..") {
+                throw tgctl::runtime_error(monitor::reason::payload_broken, "could not create a backup, as the destination " + file.destination() + " is out of the backup directory");
+            }
+            if (manifest::is_metadata(destination)) {
+                continue;
+            }
+            files.emplace_back(backup_file{file.source(), destination.string(), file.mutable_(), file.detached()});
+        }
+        return files;
+    }
+    for (auto&& file : success.simple_source().files()) {
+        auto src = std::filesystem::path(file);
+        if (manifest::is_metadata(src.filename())) {
+            continue;
+        }
+        files.emplace_back(backup_file{src, src.filename().string(), false, false});
+    }
+    return files;
+}
+
+static double mebibytes(std::uintmax_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+static std::string duration_string(double seconds) {
+    auto total = static_cast<std::uint64_t>(seconds + 0.5);
+    std::ostringstream strm{};
+    strm << total / 3600 << ':' << std::setw(2) << std::setfill('0') << (total / 60) % 60 << ':' << std::setw(2) << std::setfill('0') << total % 60;
+    return strm.str();
+}
+
+namespace {
+
+// reports the progress of backup create to the monitor, and to the standard error if --progress is given,
+// as the bytes are copied rather than as each file is completed
+// the records into the monitor are serialized here, as they are written from the threads copying the files
+class backup_progress {
+public:
+    backup_progress(const std::vector<backup_file>& files, monitor::monitor* monitor_output)
+        : monitor_output_(monitor_output), terminal_(isatty(STDERR_FILENO) != 0),
+          meter_(total_bytes_of(files), files.size(), [this](const progress_report& r) { report(r); }) {
+    }
+    ~backup_progress() = default;
+
+    backup_progress(backup_progress const& other) = delete;
+    backup_progress& operator=(backup_progress const& other) = delete;
+    backup_progress(backup_progress&& other) noexcept = delete;
+    backup_progress& operator=(backup_progress&& other) noexcept = delete;
+
+    [[nodiscard]] progress_meter* meter() noexcept {
+        return &meter_;
+    }
+
+    void file_copy(std::string_view file, copy_strategy strategy, std::uintmax_t bytes) {
+        if (monitor_output_ != nullptr) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            monitor_output_->file_copy(file, to_string_view(strategy), bytes);
+        }
+    }
+
+    void finish() {
+        meter_.finish();
+        if (FLAGS_progress && terminal_) {
+            std::cerr << '\n' << std::flush;
+        }
+    }
+
+private:
+    monitor::monitor* monitor_output_;
+    bool terminal_;
+    std::mutex mtx_{};
+    progress_meter meter_;
+
+    static std::uintmax_t total_bytes_of(const std::vector<backup_file>& files) {
+        std::uintmax_t total_bytes = 0;
+        for (auto&& file : files) {
+            total_bytes += std::filesystem::file_size(file.source);
+        }
+        return total_bytes;
+    }
+
+    void report(const progress_report& r) {
+        if (monitor_output_ != nullptr) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            monitor_output_->progress(r.ratio(), r.bytes, r.total_bytes, r.files, r.total_files, r.bytes_per_second, r.eta_seconds, r.active_file);
+        }
+        if (!FLAGS_progress) {
+            return;
+        }
+        std::ostringstream line{};
+        line << std::fixed << std::setprecision(1) << r.ratio() * 100.0F << "% ("
+             << mebibytes(r.bytes) << " / " << mebibytes(r.total_bytes) << " MiB, "
+             << r.files << " / " << r.total_files << " files, "
+             << mebibytes(r.bytes_per_second) << " MiB/s, ETA "
+             << (r.eta_seconds ? duration_string(static_cast<double>(r.eta_seconds.value())) : std::string("unknown")) << ")";
+        if (!r.active_file.empty()) {
+            line << ' ' << r.active_file;
+            if (r.active_files > 1) {
+                line << " and " << r.active_files - 1 << " more";
+            }
+        }
+        // rewritten in place on a terminal, and a line each otherwise, such as in a log file
+        if (terminal_) {
+            std::cerr << '\r' << line.str() << "\x1b[K" << std::flush;
+        } else {
+            std::cerr << line.str() << '\n' << std::flush;
+        }
+    }
+};
+
+}  // namespace
+
+// returns the name of the file in the backup directory, which has the suffix if the file is compressed
+static std::string stored_name_of(const backup_file& file, const std::optional<compression>& comp) {
+    auto name = file.destination;
+    if (comp) {
+        name += compressed_suffix;
+    }
+    return name;
+}
+
+// returns the entry of the previous backup from which the file can be cloned instead of being copied,
+// or nullptr if the file has been changed since then, is mutable or is stored with another compression, thus must be copied
+static const manifest_entry* reusable_entry(const manifest& previous,
+                                            const std::string& name,
+                                            const backup_file& file,
+                                            std::uintmax_t source_size,
+                                            std::int64_t mtime,
+                                            const std::optional<compression>& comp) {
+    if (file.is_mutable || previous.compression() != (comp ? to_string(comp.value()) : std::string{})) {
+        return nullptr;
+    }
+    const auto* prev = previous.find(name);
+    if (prev == nullptr || prev->source_size != source_size || prev->mtime != mtime) {
+        return nullptr;
+    }
+    return prev;
+}
+
+// copies the files into the backup directory, the immutable files in parallel first and the mutable files at the end,
+// so that the window during which the mutable files can be modified before being copied is short
+static void copy_backup_files(const std::filesystem::path& location,
+                              const std::vector<backup_file>& files,
+                              manifest& current,
+                              const manifest& previous,
+                              const std::filesystem::path& previous_location,
+                              const std::optional<compression>& comp,
+                              rate_limiter* limiter,
+                              backup_journal& journal,
+                              backup_progress& progress) {
+    std::size_t resumed_files = 0;
+    for (bool mutable_phase : {false, true}) {
+        parallel_copy copier(static_cast<std::size_t>(std::max(FLAGS_parallel, 0)));
+        copier.compute_checksum(true);
+        copier.throttle(limiter);
+        copier.measure(progress.meter());
+        copier.drop_cache(FLAGS_drop_cache);
+        copier.direct_io(FLAGS_direct_io);
+        if (comp) {
+            copier.compress(comp.value());
+        }
+        std::map<std::filesystem::path, std::string> stored_names{};
+        for (auto&& file : files) {
+            if (file.is_mutable != mutable_phase) {
+                continue;
+            }
+            auto name = stored_name_of(file, comp);
+            auto dst = location / name;
+            std::filesystem::create_directories(dst.parent_path());
+            // the size and mtime are taken before the copy, so that a file modified during the copy is copied again next time
+            auto source_size = std::filesystem::file_size(file.source);
+            manifest_entry entry{source_size, manifest::mtime_of(file.source), {}, source_size, file.is_mutable, file.detached};
+            if (journal.resuming()) {
+                // the mutable files are always copied again, as they may have been modified after being copied
+                const auto* done = journal.completed(name);
+                std::error_code ec{};
+                if (!file.is_mutable && done != nullptr && done->source_size == entry.source_size && done->mtime == entry.mtime
+                    && std::filesystem::file_size(dst, ec) == done->size && !ec) {
+                    current.add(name, *done);
+                    journal.append(name, *done);
+                    progress.meter()->skip(source_size, 1);
+                    resumed_files++;
+                    continue;
+                }
+                // the file has been copied partially, or changed since it was copied
+                std::filesystem::remove(dst, ec);
+            }
+            if (const auto* prev = reusable_entry(previous, name, file, entry.source_size, entry.mtime, comp); prev != nullptr) {
+                copier.add(file.source, dst, previous_location / name);
+                entry.size = prev->size;
+                entry.checksum = prev->checksum;
+            } else {
+                copier.add(file.source, dst);
+            }
+            current.add(name, std::move(entry));
+            stored_names.emplace(file.source, name);
+        }
+        copier.run([&progress, &current, &comp, &stored_names, &journal](const std::filesystem::path& src, copy_result result, std::uintmax_t, std::uintmax_t) {
+            const auto& name = stored_names.at(src);
+            if (result.checksum) {
+                // copied or compressed rather than cloned from the previous generation
+                auto entry = *current.find(name);
+                entry.checksum = checksum_string(result.checksum.value());
+                if (comp) {
+                    entry.size = result.data_bytes;
+                }
+                current.add(name, std::move(entry));
+            }
+            journal.append(name, *current.find(name));
+            progress.file_copy(src.filename().string(), result.strategy, result.data_bytes);
+        });
+    }
+    if (journal.resuming()) {
+        std::cout << "resumed the backup, " << resumed_files << " of " << files.size() << " files completed by the previous run are skipped\n" << std::flush;
+    }
+}
+
+// writes the files of the backup into the stream followed by the manifest, so that the files extracted by tar(1) can be verified
+static void write_backup_stream(int fd, const std::vector<backup_file>& files, const copy_options& options, backup_progress& progress) {
+    manifest mf{};
+    archive_writer writer(fd);
+    for (auto&& file : files) {
+        const auto& src = file.source;
+        const auto& name = file.destination;
+        auto mtime = manifest::mtime_of(src);
+        progress_meter::file_scope scope(options.meter, name);
+        auto result = writer.add(src, name, options);
+        scope.complete();
+        mf.add(name, manifest_entry{result.data_bytes, mtime, checksum_string(result.checksum.value()), result.data_bytes});
+        progress.file_copy(name, result.strategy, result.data_bytes);
+    }
+    std::ostringstream strm{};
+    mf.write(strm);
+    writer.add_data(std::string(manifest::file_name), strm.str());
+    writer.finish();
+}
+
+namespace {
+
+// the options of backup create shared by the backups with and without tsurugidb
+struct create_options {
+    manifest previous{};
+    std::filesystem::path previous_location{};
+    std::optional<compression> comp{};
+    std::unique_ptr<backup_stream> stream{};
+    std::unique_ptr<rate_limiter> limiter{};
+    std::unique_ptr<chunk_repository> repository{};
+};
+
+}  // namespace
+
+// parses --compress, returns std::nullopt if it is not given, where what is told in the error message
+static std::optional<compression> compression_of_flags(std::string_view what) {
+    std::optional<compression> comp{};
+    if (!FLAGS_compress.empty()) {
+        if (comp = parse_compression(FLAGS_compress); !comp) {
+            throw tgctl::runtime_error(monitor::reason::invalid_argument, "could not " + std::string(what) + ", as --compress=" + FLAGS_compress + " is invalid, which must be zstd or lz4 optionally followed by :level");
+        }
+        if (!compression_available(comp->codec)) {
+            throw tgctl::runtime_error(monitor::reason::invalid_argument, "could not " + std::string(what) + ", as tgctl is built without " + std::string(to_string_view(comp->codec)));
+        }
+    }
+    return comp;
+}
+
+// parses the options of backup create, where detailed tells that the backup is created by BackupDetailBegin
+static create_options create_options_of(bool detailed) {
+    create_options options{};
+    options.previous_location = std::filesystem::path(FLAGS_incremental_from);
+    if (!FLAGS_incremental_from.empty() && !options.previous.read(options.previous_location)) {
+        throw tgctl::runtime_error(monitor::reason::not_found, "could not create an incremental backup, as " + FLAGS_incremental_from + " has no valid " + std::string(manifest::file_name));
+    }
+    options.comp = compression_of_flags("create a backup");
+    const auto& comp = options.comp;
+    if (FLAGS_max_rate < 0) {
+        throw tgctl::runtime_error(monitor::reason::invalid_argument, "could not create a backup, as --max-rate=" + std::to_string(FLAGS_max_rate) + " is negative");
+    }
+    if (!FLAGS_stream.empty()) {
+        if (comp || !FLAGS_incremental_from.empty() || detailed || FLAGS_resume) {
+            throw tgctl::runtime_error(monitor::reason::invalid_argument, "could not create a backup, as --stream cannot be used with --compress, --incremental-from, --backup-type or --resume");
+        }
+        options.stream = std::make_unique<backup_stream>(FLAGS_stream, true);
+    }
+    if (!FLAGS_repository.empty()) {
+        // the chunks unchanged are shared with the previous generations, which is what --incremental-from does
+        if (comp || !FLAGS_incremental_from.empty() || !FLAGS_stream.empty() || FLAGS_resume) {
+            throw tgctl::runtime_error(monitor::reason::invalid_argument, "could not create a backup, as --repository cannot be used with --compress, --incremental-from, --stream or --resume");
+        }
+        try {
+            options.repository = std::make_unique<chunk_repository>(std::filesystem::path(FLAGS_repository));
+        } catch (std::runtime_error &ex) {
+            throw tgctl::runtime_error(monitor::reason::invalid_argument, std::string("could not create a backup, as ") + ex.what());
+        }
+    }
+    if (FLAGS_max_rate > 0) {
+        options.limiter = std::make_unique<rate_limiter>(static_cast<std::uint64_t>(FLAGS_max_rate) * 1024UL * 1024UL);
+    }
+    if (!FLAGS_io_class.empty()) {
+        auto io_class = io_class_of(FLAGS_io_class);
+        if (!io_class) {
+            throw tgctl::runtime_error(monitor::reason::invalid_argument, "could not create a backup, as --io-class=" + FLAGS_io_class + " is invalid, which must be idle or best-effort");
+        }
+        if (!set_io_class(io_class.value())) {
+            // the backup itself can be done, only without the priority
+            std::cerr << "could not set the I/O class to " << FLAGS_io_class << ", as " << std::strerror(errno) << '\n' << std::flush;
+        }
+    }
+    return options;
+}
+
+// stores the files into the chunk repository as a new generation, reporting how much of the data is new
+static void store_generation(chunk_repository& repository,
+                             const std::vector<backup_file>& files,
+                             const create_options& options,
+                             std::optional<log_range> range,
+                             backup_progress& progress) {
+    std::vector<repository_source> sources{};
+    sources.reserve(files.size());
+    for (auto&& file : files) {
+        sources.emplace_back(repository_source{file.source, file.destination, file.is_mutable, file.detached});
+    }
+    auto generation = repository.store(sources, range, static_cast<std::size_t>(std::max(FLAGS_parallel, 0)),
+                                       copy_options{false, options.limiter.get(), FLAGS_drop_cache, false, progress.meter()},
+                                       [&progress](const std::string& name, std::uintmax_t size, std::uintmax_t, std::uintmax_t) {
+                                           progress.file_copy(name, copy_strategy::chunk, size);
+                                       });
+    const auto& stats = repository.stats();
+    std::ostringstream line{};
+    line << std::fixed << std::setprecision(1)
+         << "stored the generation " << generation << " into " << repository.location().string() << ", "
+         << stats.new_chunks << " of " << stats.chunks << " chunks are new, " << mebibytes(stats.new_bytes) << " of " << mebibytes(stats.bytes) << " MiB";
+    std::cout << line.str() << '\n' << std::flush;
+}
+
+// stores the files into the backup directory along with the manifest, into the stream if --stream is given,
+// or into the chunk repository if --repository is given
+static void store_backup(const std::filesystem::path& location,
+                         const std::vector<backup_file>& files,
+                         const create_options& options,
+                         std::optional<log_range> range,
+                         monitor::monitor* monitor_output) {
+    backup_progress progress(files, monitor_output);
+    if (options.repository) {
+        store_generation(*options.repository, files, options, std::move(range), progress);
+        progress.finish();
+        return;
+    }
+    if (options.stream) {
+        write_backup_stream(options.stream->fd(), files, copy_options{true, options.limiter.get(), FLAGS_drop_cache, false, progress.meter()}, progress);
+        progress.finish();
+        return;
+    }
+    manifest current{};
+    current.incremental_from(FLAGS_incremental_from);
+    if (options.comp) {
+        current.compression(to_string(options.comp.value()));
+    }
+    if (range) {
+        current.detail(std::move(range.value()));
+    }
+    if (!FLAGS_resume && std::filesystem::exists(location / std::filesystem::path(backup_journal::file_name))) {
+        throw tgctl::runtime_error(monitor::reason::invalid_argument, "could not create a backup, as " + location.string() + " has the files of a backup interrupted, which can be resumed by --resume");
+    }
+    backup_journal journal(location, FLAGS_resume);
+    copy_backup_files(location, files, current, options.previous, options.previous_location, options.comp, options.limiter.get(), journal, progress);
+    progress.finish();
+    current.write(location);
+    journal.remove();
+}
+
 tgctl::return_code tgctl_backup_create(const std::string& path_to_backup) {
     std::unique_ptr<monitor::monitor> monitor_output{};
 
@@ -110,14 +593,37 @@ tgctl::return_code tgctl_backup_create(const std::string& path_to_backup) {
     auto rtnv = tgctl::return_code::ok;
     auto reason = monitor::reason::absent;
     try {
+        std::optional<::tateyama::proto::datastore::request::BackupType> backup_type{};
+        std::string backup_type_name{};
+        if (!FLAGS_backup_type.empty()) {
+            if (FLAGS_backup_type == "standard") {
+                backup_type = ::tateyama::proto::datastore::request::BackupType::STANDARD;
+            } else if (FLAGS_backup_type == "transaction") {
+                backup_type = ::tateyama::proto::datastore::request::BackupType::TRANSACTION;
+            } else {
+                throw tgctl::runtime_error(monitor::reason::invalid_argument, "could not create a backup, as --backup-type=" + FLAGS_backup_type + " is invalid, which must be standard or transaction");
+            }
+            backup_type_name = FLAGS_backup_type;
+        }
+        auto options = create_options_of(backup_type.has_value());
+
         auto transport = std::make_unique<tateyama::bootstrap::wire::transport>(tateyama::framework::service_id_datastore);
         ::tateyama::proto::datastore::request::Request requestBegin{};
-        auto backup_begin = requestBegin.mutable_backup_begin();
-        if (!FLAGS_label.empty()) {
-            backup_begin->set_label(FLAGS_label);
+        if (backup_type) {
+            // the server responds to BackupDetailBegin with BackupBegin having the detail source
+            auto backup_detail_begin = requestBegin.mutable_backup_detail_begin();
+            if (!FLAGS_label.empty()) {
+                backup_detail_begin->set_label(FLAGS_label);
+            }
+            backup_detail_begin->set_type(backup_type.value());
+        } else {
+            auto backup_begin = requestBegin.mutable_backup_begin();
+            if (!FLAGS_label.empty()) {
+                backup_begin->set_label(FLAGS_label);
+            }
         }
         auto responseBegin = transport->send<::tateyama::proto::datastore::response::BackupBegin>(requestBegin);
-        requestBegin.clear_backup_begin();
+        requestBegin.clear_command();
 
         if (responseBegin) {
             const auto& rbgn = responseBegin.value();
@@ -140,26 +646,20 @@ tgctl::return_code tgctl_backup_create(const std::string& path_to_backup) {
 
                 auto location = std::filesystem::path(path_to_backup);
 
-                std::size_t total_bytes = 0;
-                if(!FLAGS_monitor.empty()) {
-                    for (auto&& file : rbgn.success().simple_source().files()) {
-                        auto src = std::filesystem::path(file);
-                        total_bytes += std::filesystem::file_size(src);
-                    }
-                }
-
-                std::size_t completed_bytes = 0;
-                for (auto&& file : rbgn.success().simple_source().files()) {
-                    auto src = std::filesystem::path(file);
-                    std::filesystem::copy_file(src, location / src.filename());
-                    if(!FLAGS_monitor.empty()) {
-                        completed_bytes += std::filesystem::file_size(src);
-                        if (total_bytes > 0) {
-                            monitor_output->progress(static_cast<float>(completed_bytes) / static_cast<float>(total_bytes));
-                        } else {
-                            monitor_output->progress(1.0);
+                // copy errors are reported after BackupEnd, so that the server can release the backup
+                std::exception_ptr copy_error{};
+                try {
+                    std::optional<log_range> range{};
+                    if (rbgn.success().has_detail_source()) {
+                        const auto& detail = rbgn.success().detail_source();
+                        range = log_range{backup_type_name, detail.log_begin(), detail.log_end(), {}};
+                        if (detail.image_finish_case() == ::tateyama::proto::datastore::response::BackupBegin::DetailSource::kImageFinishValue) {
+                            range->image_finish = detail.image_finish_value();
                         }
                     }
+                    store_backup(location, backup_files_of(rbgn.success()), options, std::move(range), monitor_output.get());
+                } catch (...) {
+                    copy_error = std::current_exception();
                 }
 
                 ::tateyama::proto::datastore::request::Request requestEnd{};
@@ -168,6 +668,9 @@ tgctl::return_code tgctl_backup_create(const std::string& path_to_backup) {
                 auto responseEnd = transport->send<::tateyama::proto::datastore::response::BackupEnd>(requestEnd);
                 requestEnd.clear_backup_end();
                 transport->close();
+                if (copy_error) {
+                    std::rethrow_exception(copy_error);
+                }
 
                 if (responseEnd) {
                     const auto& rend = responseEnd.value();
@@ -217,6 +720,79 @@ tgctl::return_code tgctl_backup_create(const std::string& path_to_backup) {
     return rtnv;
 }
 
+// the files in the log location of the datastore, placed in the backup as BackupBegin does, so that the backup is restored
+// in the same way as the online backup. The files in the subdirectories are not listed by BackupBegin either.
+static std::vector<backup_file> offline_backup_files(const std::filesystem::path& log_location) {
+    std::vector<backup_file> files{};
+    for (auto&& entry : std::filesystem::directory_iterator(log_location)) {
+        if (entry.is_regular_file()) {
+            files.emplace_back(backup_file{entry.path(), entry.path().filename().string(), false, false});
+        }
+    }
+    std::sort(files.begin(), files.end(), [](const backup_file& a, const backup_file& b) { return a.destination < b.destination; });
+    return files;
+}
+
+tgctl::return_code tgctl_backup_create_offline(const std::string& path_to_backup) {
+    std::unique_ptr<monitor::monitor> monitor_output{};
+
+    if (!FLAGS_monitor.empty()) {
+        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
+        monitor_output->start();
+    }
+
+    auto rtnv = tgctl::return_code::ok;
+    auto reason = monitor::reason::absent;
+    try {
+        if (!FLAGS_backup_type.empty()) {
+            throw tgctl::runtime_error(monitor::reason::invalid_argument, "could not create an offline backup, as --backup-type needs tsurugidb to tell the log range");
+        }
+        auto options = create_options_of(false);
+
+        auto bst_conf = configuration::bootstrap_configuration::create_bootstrap_configuration(FLAGS_conf);
+        if (!bst_conf.valid()) {
+            throw tgctl::runtime_error(monitor::reason::internal, "could not create an offline backup, as the configuration file is not valid");
+        }
+        std::optional<std::filesystem::path> log_location{};
+        if (auto* datastore_section = bst_conf.get_configuration()->get_section("datastore"); datastore_section != nullptr) {
+            log_location = datastore_section->get<std::filesystem::path>("log_location");
+        }
+        if (!log_location || log_location.value().empty()) {
+            throw tgctl::runtime_error(monitor::reason::not_found, "could not create an offline backup, as datastore.log_location is not given in the configuration");
+        }
+        if (!std::filesystem::is_directory(log_location.value())) {
+            throw tgctl::runtime_error(monitor::reason::not_found, "could not create an offline backup, as the log location " + log_location.value().string() + " is not a directory");
+        }
+
+        // holds the lock taken by tsurugidb on startup, so that tsurugidb cannot start until the files are copied,
+        // without writing the pid into the file, so that tgctl status and tgctl kill do not take this process for tsurugidb
+        process::proc_mutex mutex(bst_conf.lock_file(), true, true);
+        if (mutex.check() == process::proc_mutex::lock_state::locked) {
+            throw tgctl::runtime_error(monitor::reason::another_process, "could not create an offline backup, as tsurugidb is running");
+        }
+        try {
+            mutex.lock();
+        } catch (tgctl::runtime_error &ex) {
+            throw tgctl::runtime_error(monitor::reason::another_process, "could not create an offline backup, as tsurugidb has been started in the meantime");
+        }
+
+        store_backup(std::filesystem::path(path_to_backup), offline_backup_files(log_location.value()), options, std::nullopt, monitor_output.get());
+    } catch (tgctl::runtime_error &ex) {
+        std::cerr << ex.what() << '\n' << std::flush;
+        rtnv = tgctl::return_code::err;
+        reason = ex.code();
+    } catch (std::exception &ex) {
+        std::cerr << ex.what() << '\n' << std::flush;
+        rtnv = tgctl::return_code::err;
+        reason = monitor::reason::io;
+    }
+
+    if (monitor_output) {
+        monitor_output->finish(reason);
+    }
+    return rtnv;
+}
+
 tgctl::return_code tgctl_backup_directory_check(const std::string& path_to_backup) {
     auto rtnv = tgctl::return_code::ok;
     std::stringstream ss{};
@@ -249,7 +825,86 @@ tgctl::return_code tgctl_backup_directory_check(const std::string& path_to_backu
     return rtnv;
 }
 
-tgctl::return_code tgctl_backup_estimate() {
+// lists the files by BackupBegin, which is ended at once, to find how much an incremental backup copies
+// and to predict the duration by copying a sample of them into the backup destination
+static void estimate_backup_copy(const std::string& path_for_sample) {
+    manifest previous{};
+    if (!FLAGS_incremental_from.empty() && !previous.read(std::filesystem::path(FLAGS_incremental_from))) {
+        throw tgctl::runtime_error(monitor::reason::not_found, "could not estimate an incremental backup, as " + FLAGS_incremental_from + " has no valid " + std::string(manifest::file_name));
+    }
+    // the names of the files compared with the previous backup are those backup create would store with the same --compress
+    auto comp = compression_of_flags("estimate the backup");
+    if (FLAGS_max_rate < 0) {
+        throw tgctl::runtime_error(monitor::reason::invalid_argument, "could not estimate the backup, as --max-rate=" + std::to_string(FLAGS_max_rate) + " is negative");
+    }
+    std::unique_ptr<rate_limiter> limiter{};
+    if (FLAGS_max_rate > 0) {
+        limiter = std::make_unique<rate_limiter>(static_cast<std::uint64_t>(FLAGS_max_rate) * 1024UL * 1024UL);
+    }
+    auto directory = path_for_sample.empty() ? std::filesystem::temp_directory_path() : std::filesystem::path(path_for_sample);
+
+    auto transport = std::make_unique<tateyama::bootstrap::wire::transport>(tateyama::framework::service_id_datastore);
+    ::tateyama::proto::datastore::request::Request requestBegin{};
+    requestBegin.mutable_backup_begin();
+    auto responseBegin = transport->send<::tateyama::proto::datastore::response::BackupBegin>(requestBegin);
+    requestBegin.clear_backup_begin();
+    if (!responseBegin || responseBegin.value().result_case() != ::tateyama::proto::datastore::response::BackupBegin::ResultCase::kSuccess) {
+        transport->close();
+        throw tgctl::runtime_error(monitor::reason::server, "could not estimate the backup, as BackupBegin has failed");
+    }
+
+    // errors are reported after BackupEnd, so that the server can release the backup
+    std::exception_ptr error{};
+    std::ostringstream report{};
+    try {
+        auto files = backup_files_of(responseBegin.value().success());
+        std::vector<std::filesystem::path> sources{};
+        std::uintmax_t total_bytes = 0;
+        std::uintmax_t copied_bytes = 0;
+        std::size_t copied_files = 0;
+        for (auto&& file : files) {
+            auto size = std::filesystem::file_size(file.source);
+            total_bytes += size;
+            if (!FLAGS_incremental_from.empty()
+                && reusable_entry(previous, stored_name_of(file, comp), file, size, manifest::mtime_of(file.source), comp) != nullptr) {
+                continue;  // cloned
+            }
+            sources.emplace_back(file.source);
+            copied_bytes += size;
+            copied_files++;
+        }
+        report << std::fixed << std::setprecision(1);
+        if (!FLAGS_incremental_from.empty()) {
+            report << "incremental from " << FLAGS_incremental_from << ": " << copied_files << " of " << files.size() << " files ("
+                   << mebibytes(copied_bytes) << " of " << mebibytes(total_bytes) << " MiB) are copied, and the others are cloned if the file system supports reflinks\n";
+        }
+        if (FLAGS_sample_size > 0) {
+            auto result = sample_copy(sources, directory, static_cast<std::uintmax_t>(FLAGS_sample_size) * 1024UL * 1024UL,
+                                      static_cast<std::size_t>(std::max(FLAGS_parallel, 0)), copy_options{false, limiter.get(), FLAGS_drop_cache, false});
+            auto rate = result.bytes_per_second();
+            report << "copied a sample of " << mebibytes(result.bytes) << " MiB into " << directory.string() << " in " << result.seconds << " s with "
+                   << result.parallelism << " threads, " << mebibytes(static_cast<std::uintmax_t>(rate)) << " MiB/s\n";
+            if (rate > 0) {
+                auto seconds = static_cast<double>(copied_bytes) / rate;
+                report << "estimated duration = " << duration_string(seconds) << " (" << seconds << " s) for " << mebibytes(copied_bytes) << " MiB\n";
+            }
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    ::tateyama::proto::datastore::request::Request requestEnd{};
+    requestEnd.mutable_backup_end()->set_id(responseBegin.value().success().id());
+    auto responseEnd = transport->send<::tateyama::proto::datastore::response::BackupEnd>(requestEnd);
+    requestEnd.clear_backup_end();
+    transport->close();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    std::cout << report.str() << std::flush;
+}
+
+tgctl::return_code tgctl_backup_estimate(const std::string& path_for_sample) {
     std::unique_ptr<monitor::monitor> monitor_output{};
 
     if (!FLAGS_monitor.empty()) {
@@ -274,6 +929,19 @@ tgctl::return_code tgctl_backup_estimate() {
                 auto success = response.value().success();
                 std::cout << "number_of_files = " << success.number_of_files()
                           << ", number_of_bytes = " << success.number_of_bytes() << '\n' << std::flush;
+                if (!FLAGS_incremental_from.empty() || FLAGS_sample_size > 0) {
+                    try {
+                        estimate_backup_copy(path_for_sample);
+                    } catch (tgctl::runtime_error &ex) {
+                        std::cerr << ex.what() << '\n' << std::flush;
+                        rtnv = tgctl::return_code::err;
+                        reason = ex.code();
+                    } catch (std::exception &ex) {
+                        std::cerr << "could not estimate the backup, as " << ex.what() << '\n' << std::flush;
+                        rtnv = tgctl::return_code::err;
+                        reason = monitor::reason::io;
+                    }
+                }
                 break;
             }
             case ::tateyama::proto::datastore::response::BackupEstimate::kUnknownError:
@@ -304,26 +972,144 @@ tgctl::return_code tgctl_backup_estimate() {
     return rtnv;
 }
 
-tgctl::return_code tgctl_restore_backup(const std::string& path_to_backup) {
+tgctl::return_code tgctl_backup_verify(const std::string& path_to_backup) {
     std::unique_ptr<monitor::monitor> monitor_output{};
 
+    if (!FLAGS_monitor.empty()) {
+        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
+        monitor_output->start();
+    }
+
+    auto rtnv = tgctl::return_code::ok;
+    auto reason = monitor::reason::absent;
+    auto location = std::filesystem::path(path_to_backup);
+    manifest mf{};
+    if (!mf.read(location)) {
+        std::cerr << "could not verify the backup, as " << path_to_backup << " has no valid " << manifest::file_name << '\n' << std::flush;
+        rtnv = tgctl::return_code::err;
+        reason = monitor::reason::not_found;
+    } else {
+        auto failures = verify_backup(location, mf, static_cast<std::size_t>(std::max(FLAGS_parallel, 0)), [&monitor_output](std::uintmax_t completed_bytes, std::uintmax_t total_bytes) {
+            if (monitor_output) {
+                monitor_output->progress(total_bytes > 0 ? static_cast<float>(completed_bytes) / static_cast<float>(total_bytes) : 1.0F);
+            }
+        });
+        for (auto&& failure : failures) {
+            std::cout << failure.name << ": " << failure.message << '\n';
+        }
+        if (failures.empty()) {
+            std::cout << "verified " << mf.entries().size() << " files in " << path_to_backup << ", no problem found.\n" << std::flush;
+        } else {
+            std::cout << failures.size() << " of " << mf.entries().size() << " files in " << path_to_backup << " are broken.\n" << std::flush;
+            rtnv = tgctl::return_code::err;
+            reason = monitor::reason::io;
+        }
+    }
+
+    if (monitor_output) {
+        monitor_output->finish(reason);
+    }
+    return rtnv;
+}
+
+static std::filesystem::path staging_root() {
+    return FLAGS_staging_dir.empty() ? std::filesystem::temp_directory_path() : std::filesystem::path(FLAGS_staging_dir);
+}
+
+// decompresses the compressed backup into a staging directory, to which the files not compressed are copied as well,
+// returns nullptr if the backup is not compressed
+static std::unique_ptr<staging_directory> stage_compressed_backup(const std::filesystem::path& location, monitor::monitor* monitor_output) {
+    // relative to the location, as the files of a backup created by BackupDetailBegin can be in subdirectories
+    std::vector<std::filesystem::path> compressed_files{};
+    std::vector<std::filesystem::path> other_files{};
+    for (auto&& entry : std::filesystem::recursive_directory_iterator(location)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        auto relative = entry.path().lexically_relative(location);
+        if (manifest::is_metadata(relative)) {
+            continue;
+        }
+        if (entry.path().extension() == compressed_suffix) {
+            compressed_files.emplace_back(relative);
+        } else {
+            other_files.emplace_back(relative);
+        }
+    }
+    if (compressed_files.empty()) {
+        return nullptr;
+    }
+
+    auto staging = std::make_unique<staging_directory>(staging_root() / std::filesystem::path("tgctl-restore-" + std::to_string(getpid())));
+    for (auto&& file : other_files) {
+        std::filesystem::create_directories((staging->location() / file).parent_path());
+        fast_copy_file(location / file, staging->location() / file);
+    }
+    parallel_copy decompressor(static_cast<std::size_t>(std::max(FLAGS_parallel, 0)));
+    decompressor.decompress(true);
+    for (auto&& file : compressed_files) {
+        auto dst = staging->location() / file.parent_path() / file.stem();
+        std::filesystem::create_directories(dst.parent_path());
+        decompressor.add(location / file, dst);
+    }
+    // the progress is in the bytes after decompression
+    decompressor.run([monitor_output](const std::filesystem::path& src, copy_result result, std::uintmax_t completed_bytes, std::uintmax_t total_bytes) {
+        if (monitor_output != nullptr) {
+            monitor_output->file_copy(src.filename().string(), to_string_view(result.strategy), result.data_bytes);
+            monitor_output->progress(total_bytes > 0 ? static_cast<float>(completed_bytes) / static_cast<float>(total_bytes) : 1.0F);
+        }
+    });
+    return staging;
+}
+
+static bool confirm_restore() {
     if (!FLAGS_force) {
         try {
             if (!prompt("continue? (press y or n) : ")) {
                 std::cout << "restore backup has been canceled.\n" << std::flush;
-                return tgctl::return_code::err;
+                return false;
             }
         } catch (std::runtime_error &ex) {
             std::cerr << "prompt fail, cause: " << ex.what() << '\n' << std::flush;
-            return tgctl::return_code::err;
+            return false;
         }
     }
+    return true;
+}
 
-    if (!FLAGS_monitor.empty()) {
-        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
-        monitor_output->start();
+// sets the backup directory as the source of RestoreBegin, or the files in it as the entries if it has the metadata of tgctl,
+// so that the manifest and the journal are not restored into the datastore, returns true in the latter case
+static bool set_restore_source(::tateyama::proto::datastore::request::RestoreBegin& restore_begin, const std::filesystem::path& directory) {
+    if (!std::filesystem::exists(directory / std::filesystem::path(manifest::file_name))
+        && !std::filesystem::exists(directory / std::filesystem::path(backup_journal::file_name))) {
+        restore_begin.set_backup_directory(directory.string());
+        return false;
     }
+    // the files detached are told by the manifest of a backup created by BackupDetailBegin
+    manifest mf{};
+    bool has_manifest = mf.read(directory);
+    auto entries = restore_begin.mutable_entries();
+    entries->set_directory(directory.string());
+    for (auto&& entry : std::filesystem::recursive_directory_iterator(directory)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        auto relative = entry.path().lexically_relative(directory);
+        if (manifest::is_metadata(relative)) {
+            continue;
+        }
+        const auto* recorded = has_manifest ? mf.find(relative.string()) : nullptr;
+        auto file_set_entry = entries->add_file_set_entry();
+        file_set_entry->set_source_path(relative.string());
+        file_set_entry->set_destination_path(relative.string());
+        file_set_entry->set_detached(recorded != nullptr && recorded->detached);
+    }
+    return true;
+}
 
+// sends RestoreBegin for the backup directory, and finishes the monitor,
+// waiting for the restore even without --wait if the directory is staged, as it is removed when tgctl exits
+static tgctl::return_code request_restore(const std::string& backup_directory, bool keep_backup, monitor::monitor* monitor_output, bool staged = false) {
     auto rtnv = tgctl::return_code::ok;
     auto reason = monitor::reason::absent;
 
@@ -331,12 +1117,10 @@ tgctl::return_code tgctl_restore_backup(const std::string& path_to_backup) {
         auto transport = std::make_unique<tateyama::bootstrap::wire::transport>(tateyama::framework::service_id_datastore);
         ::tateyama::proto::datastore::request::Request request{};
         auto restore_begin = request.mutable_restore_begin();
-        restore_begin->set_backup_directory(path_to_backup);
-        if (!FLAGS_keep_backup) {  // --nokeep-backup case (obsolete)
-            restore_begin->set_keep_backup(FLAGS_keep_backup);
-        } else {  // --no-keep-backup case (current)
-            restore_begin->set_keep_backup(FLAGS__keep_backup);
+        if (set_restore_source(*restore_begin, std::filesystem::path(backup_directory)) && !keep_backup && !staged) {
+            std::cerr << "option --no-keep-backup is ignored, as " << backup_directory << " is restored by the entries excluding the files of tgctl\n" << std::flush;
         }
+        restore_begin->set_keep_backup(keep_backup);
         if (!FLAGS_label.empty()) {
             restore_begin->set_label(FLAGS_label);
         }
@@ -347,6 +1131,15 @@ tgctl::return_code tgctl_restore_backup(const std::string& path_to_backup) {
         if (response) {
             switch(response.value().result_case()) {
             case ::tateyama::proto::datastore::response::RestoreBegin::kSuccess:
+                if (FLAGS_wait || staged) {
+                    if (!FLAGS_wait) {
+                        std::cout << "waiting for the restore to finish, as " << backup_directory << " is removed afterward\n" << std::flush;
+                    }
+                    reason = wait_restore(response.value().success().id(), restore_size_of(backup_directory), monitor_output);
+                    if (reason != monitor::reason::absent) {
+                        rtnv = tgctl::return_code::err;
+                    }
+                }
                 break;
             case ::tateyama::proto::datastore::response::RestoreBegin::kNotFound:
             case ::tateyama::proto::datastore::response::RestoreBegin::kPermissionError:
@@ -358,7 +1151,7 @@ tgctl::return_code tgctl_restore_backup(const std::string& path_to_backup) {
                 reason = monitor::reason::server;
             }
             if (rtnv == tgctl::return_code::ok) {
-                if (monitor_output) {
+                if (monitor_output != nullptr) {
                     monitor_output->finish(monitor::reason::absent);
                 }
                 return rtnv;
@@ -372,12 +1165,215 @@ tgctl::return_code tgctl_restore_backup(const std::string& path_to_backup) {
     }
     rtnv = tgctl::return_code::err;
 
-    if (monitor_output) {
+    if (monitor_output != nullptr) {
         monitor_output->finish(reason);
     }
     return rtnv;
 }
 
+tgctl::return_code tgctl_restore_backup(const std::string& path_to_backup) {
+    std::unique_ptr<monitor::monitor> monitor_output{};
+
+    if (!confirm_restore()) {
+        return tgctl::return_code::err;
+    }
+
+    if (!FLAGS_monitor.empty()) {
+        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
+        monitor_output->start();
+    }
+
+    std::unique_ptr<staging_directory> staging{};
+    try {
+        staging = stage_compressed_backup(std::filesystem::path(path_to_backup), monitor_output.get());
+    } catch (std::exception &ex) {
+        std::cerr << "could not decompress the backup, as " << ex.what() << '\n' << std::flush;
+        if (monitor_output) {
+            monitor_output->finish(monitor::reason::io);
+        }
+        return tgctl::return_code::err;
+    }
+
+    if (staging) {
+        // the staging directory is of no use after the restore, thus the files may be moved
+        return request_restore(staging->location().string(), false, monitor_output.get(), true);
+    }
+    // --nokeep-backup (obsolete) or --no-keep-backup (current)
+    return request_restore(path_to_backup, FLAGS_keep_backup && FLAGS__keep_backup, monitor_output.get());
+}
+
+tgctl::return_code tgctl_restore_backup_repository(const std::string& generation) {
+    std::unique_ptr<monitor::monitor> monitor_output{};
+
+    if (!confirm_restore()) {
+        return tgctl::return_code::err;
+    }
+
+    if (!FLAGS_monitor.empty()) {
+        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
+        monitor_output->start();
+    }
+
+    // the generation is materialized into a staging directory, which is restored as a backup directory
+    std::unique_ptr<staging_directory> staging{};
+    try {
+        chunk_repository repository{std::filesystem::path(FLAGS_repository)};
+        auto name = generation;
+        if (name.empty()) {
+            auto names = repository.generations();
+            if (names.empty()) {
+                throw tgctl::runtime_error(monitor::reason::not_found, "could not restore the backup, as " + FLAGS_repository + " has no generation");
+            }
+            name = names.back();
+        }
+        staging = std::make_unique<staging_directory>(staging_root() / std::filesystem::path("tgctl-restore-repository-" + std::to_string(getpid())));
+        repository.materialize(name, staging->location(), static_cast<std::size_t>(std::max(FLAGS_parallel, 0)),
+                               [&monitor_output](const std::string& file, std::uintmax_t size, std::uintmax_t completed_bytes, std::uintmax_t total_bytes) {
+                                   if (monitor_output) {
+                                       monitor_output->file_copy(file, to_string_view(copy_strategy::chunk), size);
+                                       monitor_output->progress(total_bytes > 0 ? static_cast<float>(completed_bytes) / static_cast<float>(total_bytes) : 1.0F);
+                                   }
+                               });
+        std::cout << "restoring the generation " << name << " of " << FLAGS_repository << '\n' << std::flush;
+    } catch (tgctl::runtime_error &ex) {
+        std::cerr << ex.what() << '\n' << std::flush;
+        if (monitor_output) {
+            monitor_output->finish(ex.code());
+        }
+        return tgctl::return_code::err;
+    } catch (std::exception &ex) {
+        std::cerr << "could not restore the backup from " << FLAGS_repository << ", as " << ex.what() << '\n' << std::flush;
+        if (monitor_output) {
+            monitor_output->finish(monitor::reason::io);
+        }
+        return tgctl::return_code::err;
+    }
+
+    return request_restore(staging->location().string(), false, monitor_output.get(), true);
+}
+
+// checks the files extracted from the stream with the checksums in the manifest written at the end of the stream
+static void verify_extracted_files(const std::filesystem::path& directory, const std::vector<extracted_file>& files) {
+    manifest mf{};
+    if (!std::filesystem::exists(directory / std::filesystem::path(manifest::file_name))) {
+        std::cerr << "the backup stream has no " << manifest::file_name << ", thus the files are not verified\n" << std::flush;
+        return;
+    }
+    if (!mf.read(directory)) {
+        throw tgctl::runtime_error(monitor::reason::payload_broken, "could not restore the backup stream, as its " + std::string(manifest::file_name) + " is broken");
+    }
+    std::size_t found = 0;
+    for (auto&& file : files) {
+        const auto* entry = mf.find(file.name);
+        if (entry == nullptr) {
+            continue;
+        }
+        found++;
+        if (entry->size != file.size || (!entry->checksum.empty() && entry->checksum != checksum_string(file.checksum))) {
+            throw tgctl::runtime_error(monitor::reason::payload_broken, "could not restore the backup stream, as " + file.name + " does not match the checksum in " + std::string(manifest::file_name));
+        }
+    }
+    if (found != mf.entries().size()) {
+        throw tgctl::runtime_error(monitor::reason::payload_broken, "could not restore the backup stream, as " + std::to_string(mf.entries().size() - found) + " files in " + std::string(manifest::file_name) + " are missing");
+    }
+}
+
+tgctl::return_code tgctl_restore_backup_stream(const std::string& stream_name) {
+    std::unique_ptr<monitor::monitor> monitor_output{};
+
+    if (stream_name == "-" && !FLAGS_force) {
+        // the standard input is occupied by the stream
+        std::cerr << "could not restore the backup stream, as --force is required to read it from the standard input\n" << std::flush;
+        return tgctl::return_code::err;
+    }
+    if (!confirm_restore()) {
+        return tgctl::return_code::err;
+    }
+
+    if (!FLAGS_monitor.empty()) {
+        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
+        monitor_output->start();
+    }
+
+    // the stream is extracted into a staging directory, which is decompressed into another one if the backup is compressed
+    std::unique_ptr<staging_directory> extracted{};
+    std::unique_ptr<staging_directory> decompressed{};
+    try {
+        backup_stream stream(stream_name, false);
+        extracted = std::make_unique<staging_directory>(staging_root() / std::filesystem::path("tgctl-restore-stream-" + std::to_string(getpid())));
+        archive_reader reader(stream.fd());
+        auto files = reader.extract(extracted->location(), [&monitor_output](const extracted_file& file, std::uintmax_t) {
+            if (monitor_output) {
+                monitor_output->file_copy(file.name, to_string_view(copy_strategy::stream), file.size);
+            }
+        });
+        verify_extracted_files(extracted->location(), files);
+        // the manifest appended by backup create is of no use after the verification, and is not to be restored
+        std::filesystem::remove(extracted->location() / std::filesystem::path(manifest::file_name));
+        decompressed = stage_compressed_backup(extracted->location(), monitor_output.get());
+    } catch (tgctl::runtime_error &ex) {
+        std::cerr << ex.what() << '\n' << std::flush;
+        if (monitor_output) {
+            monitor_output->finish(ex.code());
+        }
+        return tgctl::return_code::err;
+    } catch (std::exception &ex) {
+        std::cerr << "could not restore the backup stream, as " << ex.what() << '\n' << std::flush;
+        if (monitor_output) {
+            monitor_output->finish(monitor::reason::io);
+        }
+        return tgctl::return_code::err;
+    }
+
+    const auto& location = decompressed ? decompressed->location() : extracted->location();
+    return request_restore(location.string(), false, monitor_output.get(), true);
+}
+
+// checks that the source files in the file list exist, in parallel as the file list can be huge,
+// returning the number of the missing files and one of them
+static std::pair<std::size_t, std::string> missing_sources(const ::tateyama::proto::datastore::request::Entries& entries) {
+    const auto& file_set = entries.file_set_entry();
+    const auto size = static_cast<std::size_t>(file_set.size());
+    std::filesystem::path directory{entries.directory()};
+    constexpr std::size_t entries_per_thread = 4096;
+    std::size_t threads = FLAGS_parallel > 0 ? static_cast<std::size_t>(FLAGS_parallel) : std::max(std::thread::hardware_concurrency(), 1U);
+    threads = std::min(threads, (size + entries_per_thread - 1) / entries_per_thread);
+
+    std::atomic_size_t next{0};
+    std::atomic_size_t missing{0};
+    std::mutex mtx{};
+    std::string example{};
+    auto check = [&]() {
+        constexpr std::size_t batch = 256;
+        while (true) {
+            auto begin = next.fetch_add(batch);
+            if (begin >= size) {
+                return;
+            }
+            for (auto i = begin; i < std::min(begin + batch, size); i++) {
+                const auto& source = file_set.Get(static_cast<int>(i)).source_path();
+                auto path = directory.empty() ? std::filesystem::path(source) : directory / source;
+                // only the files certainly missing are reported, the server may be able to read what tgctl can not
+                if (::access(path.c_str(), F_OK) != 0 && (errno == ENOENT || errno == ENOTDIR)) {
+                    if (missing.fetch_add(1) == 0) {
+                        std::lock_guard<std::mutex> lock(mtx);
+                        example = path.string();
+                    }
+                }
+            }
+        }
+    };
+    std::vector<std::thread> workers{};
+    for (std::size_t i = 1; i < threads; i++) {
+        workers.emplace_back(check);
+    }
+    check();
+    for (auto&& worker : workers) {
+        worker.join();
+    }
+    return {missing.load(), example};
+}
+
 tgctl::return_code tgctl_restore_backup_use_file_list(const std::string& path_to_backup) {
     std::unique_ptr<monitor::monitor> monitor_output{};
 
@@ -401,34 +1397,60 @@ tgctl::return_code tgctl_restore_backup_use_file_list(const std::string& path_to
     auto rtnv = tgctl::return_code::ok;
     auto reason = monitor::reason::absent;
     try {
-        auto parser = std::make_unique<file_list>();
-        if (!parser->read_json(FLAGS_use_file_list)) {
-            std::cerr << "error occurred in using the file_list (" << FLAGS_use_file_list << ")\n" << std::flush;
-            if (monitor_output) {
-                monitor_output->finish(reason);
-            }
-            return tgctl::return_code::err;
-        }
         if (!FLAGS__keep_backup) {
             std::cerr << "option --no-keep-backup is ignored when --use-file-list is specified\n" << std::flush;
         }
 
-        auto transport = std::make_unique<tateyama::bootstrap::wire::transport>(tateyama::framework::service_id_datastore);
         ::tateyama::proto::datastore::request::Request request{};
         auto restore_begin = request.mutable_restore_begin();
         auto entries = restore_begin->mutable_entries();
         if (!path_to_backup.empty()) {
             entries->set_directory(path_to_backup);
         }
-        parser->for_each([entries](const std::string& source, const std::string& destination, bool detached) {
-                             auto file_set_entry = entries->add_file_set_entry();
-                             file_set_entry->set_source_path(source);
-                             file_set_entry->set_destination_path(destination);
-                             file_set_entry->set_detached(detached);
-                         });
+
+        // the entries go straight into the request as they are parsed, without an intermediate tree
+        auto start = std::chrono::steady_clock::now();
+        file_list parser{};
+        if (!parser.parse(FLAGS_use_file_list, [entries](std::string&& source, std::string&& destination, bool detached) {
+                                                   auto file_set_entry = entries->add_file_set_entry();
+                                                   file_set_entry->set_source_path(std::move(source));
+                                                   file_set_entry->set_destination_path(std::move(destination));
+                                                   file_set_entry->set_detached(detached);
+                                               })) {
+            std::cerr << "error occurred in using the file_list (" << FLAGS_use_file_list << ")\n" << std::flush;
+            if (monitor_output) {
+                monitor_output->finish(reason);
+            }
+            return tgctl::return_code::err;
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        {
+            std::ostringstream line{};
+            line << std::fixed << std::setprecision(1)
+                 << "parsed " << parser.entries_parsed() << " entries (" << static_cast<double>(parser.bytes_parsed()) / (1024.0 * 1024.0) << " MiB) of "
+                 << FLAGS_use_file_list << " in " << elapsed * 1000.0 << " ms";
+            if (elapsed > 0) {
+                line << ", " << static_cast<std::uintmax_t>(static_cast<double>(parser.entries_parsed()) / elapsed) << " entries/s";
+            }
+            if (parser.entries_skipped() > 0) {
+                line << ", " << parser.entries_skipped() << " entries lacking any of source_path, destination_path or detached are skipped";
+            }
+            std::cout << line.str() << '\n' << std::flush;
+        }
+
+        auto [missing, example] = missing_sources(*entries);
+        if (missing > 0) {
+            std::cerr << "could not restore the files in " << FLAGS_use_file_list << ", as " << missing << " source files are not found, e.g. " << example << '\n' << std::flush;
+            if (monitor_output) {
+                monitor_output->finish(monitor::reason::not_found);
+            }
+            return tgctl::return_code::err;
+        }
         if (!FLAGS_label.empty()) {
             restore_begin->set_label(FLAGS_label);
         }
+
+        auto transport = std::make_unique<tateyama::bootstrap::wire::transport>(tateyama::framework::service_id_datastore);
         auto response = transport->send<::tateyama::proto::datastore::response::RestoreBegin>(request);
         restore_begin->clear_entries();
         request.clear_restore_begin();
@@ -437,6 +1459,13 @@ tgctl::return_code tgctl_restore_backup_use_file_list(const std::string& path_to
         if (response) {
             switch(response.value().result_case()) {
             case ::tateyama::proto::datastore::response::RestoreBegin::kSuccess:
+                if (FLAGS_wait) {
+                    // the size of the backup is not known to tgctl
+                    reason = wait_restore(response.value().success().id(), restore_size{}, monitor_output.get());
+                    if (reason != monitor::reason::absent) {
+                        rtnv = tgctl::return_code::err;
+                    }
+                }
                 break;
             case ::tateyama::proto::datastore::response::RestoreBegin::kNotFound:
             case ::tateyama::proto::datastore::response::RestoreBegin::kPermissionError:
@@ -491,6 +1520,13 @@ tgctl::return_code tgctl_restore_tag(const std::string& tag_name) {
         if (response) {
             switch(response.value().result_case()) {
             case ::tateyama::proto::datastore::response::RestoreBegin::kSuccess:
+                if (FLAGS_wait) {
+                    // the size of the backup is not known to tgctl
+                    reason = wait_restore(response.value().success().id(), restore_size{}, monitor_output.get());
+                    if (reason != monitor::reason::absent) {
+                        rtnv = tgctl::return_code::err;
+                    }
+                }
                 break;
             case ::tateyama::proto::datastore::response::RestoreBegin::kNotFound:
             case ::tateyama::proto::datastore::response::RestoreBegin::kPermissionError:
@@ -20,10 +20,20 @@
 namespace tateyama::datastore {
 
     tgctl::return_code tgctl_backup_create(const std::string& path_to_backup);
+    tgctl::return_code tgctl_backup_create_offline(const std::string& path_to_backup);
     tgctl::return_code tgctl_backup_directory_check(const std::string& path_to_backup);
-    tgctl::return_code tgctl_backup_estimate();
+    tgctl::return_code tgctl_backup_estimate(const std::string& path_for_sample);
+    tgctl::return_code tgctl_backup_verify(const std::string& path_to_backup);
+    tgctl::return_code tgctl_backup_tag_add(const std::string& name);
+    tgctl::return_code tgctl_backup_tag_list();
+    tgctl::return_code tgctl_backup_tag_show(const std::string& name);
+    tgctl::return_code tgctl_backup_tag_remove(const std::string& name);
     tgctl::return_code tgctl_restore_backup(const std::string& path_to_backup);
+    tgctl::return_code tgctl_restore_backup_stream(const std::string& stream_name);
+    tgctl::return_code tgctl_restore_backup_repository(const std::string& generation);
     tgctl::return_code tgctl_restore_backup_use_file_list(const std::string& path_to_backup);
     tgctl::return_code tgctl_restore_tag(const std::string& tag_name);
+    tgctl::return_code tgctl_restore_status(const std::string& job);
+    tgctl::return_code tgctl_restore_cancel(const std::string& job);
 
 } //  tateyama::datastore
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cerrno>
+#include <fstream>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include "backup_journal.h"
+
+namespace tateyama::datastore {
+
+static std::map<std::string, manifest_entry> read_journal(const std::filesystem::path& path) {
+    std::map<std::string, manifest_entry> entries{};
+    std::ifstream strm(path);
+    std::string line{};
+    while (std::getline(strm, line)) {
+        if (strm.eof()) {
+            break;  // the last line without the line feed has been torn
+        }
+        auto j = nlohmann::json::parse(line, nullptr, false);
+        if (j.is_discarded() || !j.is_object()) {
+            continue;
+        }
+        try {
+            manifest_entry entry{};
+            entry.size = j.at("size").get<std::uintmax_t>();
+            entry.mtime = j.at("mtime").get<std::int64_t>();
+            entry.checksum = j.at("checksum").get<std::string>();
+            entry.source_size = j.at("source_size").get<std::uintmax_t>();
+            entry.is_mutable = j.value("mutable", false);
+            entry.detached = j.value("detached", false);
+            entries.insert_or_assign(j.at("name").get<std::string>(), std::move(entry));
+        } catch (nlohmann::json::exception& ex) {
+            continue;
+        }
+    }
+    return entries;
+}
+
+backup_journal::backup_journal(std::filesystem::path directory, bool resume)
+    : path_(std::move(directory) / std::filesystem::path(file_name)),
+      resume_(resume),
+      completed_(resume ? read_journal(path_) : std::map<std::string, manifest_entry>{}),
+      fd_(open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (resume ? 0 : O_TRUNC), 0644)) {  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+    if (fd_.get() < 0) {
+        throw std::filesystem::filesystem_error("could not open the backup journal", path_, std::error_code(errno, std::generic_category()));
+    }
+    if (resume && !completed_.empty()) {
+        // starts a line of its own in case the last line has been torn
+        if (::write(fd_.get(), "\n", 1) < 0) {
+            throw std::filesystem::filesystem_error("could not write the backup journal", path_, std::error_code(errno, std::generic_category()));
+        }
+    }
+}
+
+void backup_journal::append(const std::string& name, const manifest_entry& entry) {
+    nlohmann::json j{};
+    j["name"] = name;
+    j["size"] = entry.size;
+    j["mtime"] = entry.mtime;
+    j["checksum"] = entry.checksum;
+    j["source_size"] = entry.source_size;
+    if (entry.is_mutable) {
+        j["mutable"] = true;
+    }
+    if (entry.detached) {
+        j["detached"] = true;
+    }
+    // a single write(2) with O_APPEND, so that a line is either written as a whole or torn only at its end
+    auto line = j.dump() + '\n';
+    if (::write(fd_.get(), line.data(), line.size()) != static_cast<ssize_t>(line.size())) {
+        throw std::filesystem::filesystem_error("could not write the backup journal", path_, std::error_code(errno, std::generic_category()));
+    }
+}
+
+void backup_journal::remove() {
+    std::error_code ec{};
+    std::filesystem::remove(path_, ec);
+}
+
+}  // tateyama::datastore
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "file_descriptor.h"
+#include "manifest.h"
+
+namespace tateyama::datastore {
+
+/**
+ * @brief the journal of the files completed by backup create, kept in the backup directory until the manifest is written
+ * @details each file is appended as a line of JSON as soon as it has been copied, so that backup create --resume can
+ * skip the files completed by the run interrupted. A line torn by the interruption is ignored.
+ */
+class backup_journal {
+public:
+    static constexpr std::string_view file_name = "tgctl-backup-journal";
+
+    /**
+     * @brief opens the journal in the backup directory
+     * @param directory the backup directory
+     * @param resume reads the files completed by the previous run if true, otherwise the journal is started afresh
+     * @throws std::filesystem::filesystem_error if the journal cannot be opened
+     */
+    backup_journal(std::filesystem::path directory, bool resume);
+
+    /**
+     * @brief returns the entry of the file completed by the previous run, or nullptr if the file has not been completed
+     */
+    [[nodiscard]] const manifest_entry* completed(const std::string& name) const {
+        if (auto it = completed_.find(name); it != completed_.end()) {
+            return &it->second;
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] bool resuming() const noexcept {
+        return resume_;
+    }
+
+    /**
+     * @brief records the file completed
+     * @param name the name of the file relative to the backup directory
+     * @param entry the entry of the file, which is to be written into the manifest
+     * @throws std::filesystem::filesystem_error if the journal cannot be written
+     */
+    void append(const std::string& name, const manifest_entry& entry);
+
+    /**
+     * @brief removes the journal, which is called after the manifest has been written
+     */
+    void remove();
+
+private:
+    std::filesystem::path path_;
+    bool resume_;
+    std::map<std::string, manifest_entry> completed_{};
+    file_descriptor fd_;
+};
+
+}  // tateyama::datastore
@@ -0,0 +1,536 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+#include <openssl/evp.h>
+
+#include "chunk_repository.h"
+#include "crc32c.h"
+#include "file_descriptor.h"
+#include "io_control.h"
+#include "progress_meter.h"
+#include "parallel_copy.h"
+
+namespace tateyama::datastore {
+
+static constexpr std::string_view chunks_directory = "chunks";
+static constexpr std::string_view generations_directory = "generations";
+static constexpr std::string_view index_suffix = ".json";
+
+// the random values for the gear hash, generated by splitmix64 so that the boundaries never change
+static constexpr std::array<std::uint64_t, 256> gear_table() {
+    std::array<std::uint64_t, 256> table{};
+    std::uint64_t state = 0x9e3779b97f4a7c15ULL;
+    for (auto& value : table) {
+        state += 0x9e3779b97f4a7c15ULL;
+        std::uint64_t z = state;
+        z = (z ^ (z >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27U)) * 0x94d049bb133111ebULL;
+        value = z ^ (z >> 31U);
+    }
+    return table;
+}
+static constexpr auto gear = gear_table();
+
+std::size_t chunk_boundary(const char* data, std::size_t length, const chunking& params) noexcept {
+    if (length <= params.min_size) {
+        return length;
+    }
+    auto end = std::min(length, params.max_size);
+    // the mask of the highest bits, as the lower bits of the gear hash depend on fewer bytes
+    std::size_t bits = 0;
+    while ((2UL << bits) <= params.average_size - std::min(params.min_size, params.average_size - 1)) {
+        bits++;
+    }
+    const std::uint64_t mask = bits == 0 ? 0 : ~0ULL << (64U - bits);
+    std::uint64_t hash = 0;
+    for (std::size_t i = params.min_size; i < end; i++) {
+        hash = (hash << 1U) + gear.at(static_cast<unsigned char>(data[i]));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if ((hash & mask) == 0) {
+            return i + 1;
+        }
+    }
+    return end;
+}
+
+static std::string sha256_hex(const char* data, std::size_t length) {
+    std::array<unsigned char, EVP_MAX_MD_SIZE> md{};
+    unsigned int md_length = 0;
+    if (EVP_Digest(data, length, md.data(), &md_length, EVP_sha256(), nullptr) != 1) {
+        throw std::runtime_error("cannot compute SHA-256");
+    }
+    static constexpr std::string_view digits = "0123456789abcdef";
+    std::string hex(static_cast<std::size_t>(md_length) * 2, '0');
+    for (std::size_t i = 0; i < md_length; i++) {
+        hex.at(i * 2) = digits.at(md.at(i) >> 4U);
+        hex.at(i * 2 + 1) = digits.at(md.at(i) & 0xfU);
+    }
+    return hex;
+}
+
+static void write_fully(int fd, const char* data, std::size_t length, const std::filesystem::path& path) {
+    while (length > 0) {
+        auto n = ::write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::filesystem::filesystem_error("cannot write the file", path, std::error_code(errno, std::system_category()));
+        }
+        data += n;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        length -= static_cast<std::size_t>(n);
+    }
+}
+
+// writes the file by renaming a temporary file, so that the file is seen either as a whole or not at all,
+// whose contents are on the disk before the rename, while the rename itself is made durable by sync_directory()
+static void write_atomically(const std::filesystem::path& path, const char* data, std::size_t length) {
+    static std::atomic_uint64_t sequence{};
+    auto tmp = path;
+    tmp += ".tmp-" + std::to_string(getpid()) + "-" + std::to_string(sequence.fetch_add(1));
+    {
+        file_descriptor out(open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+        if (out.get() < 0) {
+            throw std::filesystem::filesystem_error("cannot create the file", tmp, std::error_code(errno, std::system_category()));
+        }
+        write_fully(out.get(), data, length, tmp);
+        if (fsync(out.get()) != 0) {
+            throw std::filesystem::filesystem_error("cannot sync the file", tmp, std::error_code(errno, std::system_category()));
+        }
+    }
+    std::filesystem::rename(tmp, path);
+}
+
+static void sync_directory(const std::filesystem::path& directory) {
+    file_descriptor dir(open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+    if (dir.get() < 0 || fsync(dir.get()) != 0) {
+        throw std::filesystem::filesystem_error("cannot sync the directory", directory, std::error_code(errno, std::system_category()));
+    }
+}
+
+// calls func(i) for i in [0, count) on the threads, rethrowing the first error after all the threads have finished
+static void run_parallel(std::size_t count, std::size_t parallelism, const std::function<void(std::size_t)>& func) {
+    std::atomic_size_t next{};
+    std::atomic_bool failed{};
+    std::exception_ptr error{};
+    std::mutex mtx{};
+    auto worker = [&]() {
+        while (!failed) {
+            auto i = next.fetch_add(1);
+            if (i >= count) {
+                return;
+            }
+            try {
+                func(i);
+            } catch (...) {
+                std::unique_lock<std::mutex> lock(mtx);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+    std::vector<std::thread> workers{};
+    for (std::size_t i = 1; i < std::min(parallelism, count); i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto&& t : workers) {
+        t.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+chunk_repository::chunk_repository(std::filesystem::path location) : location_(std::move(location)) {
+    auto marker = location_ / std::filesystem::path(file_name);
+    if (std::filesystem::exists(marker)) {
+        std::ifstream strm(marker);
+        auto j = nlohmann::json::parse(strm, nullptr, false);
+        if (j.is_discarded() || !j.is_object() || j.value("version", 0) > format_version) {
+            throw std::runtime_error(marker.string() + " is broken or of an unsupported version");
+        }
+        chunking_.min_size = j.at("chunking").at("min_size").get<std::size_t>();
+        chunking_.average_size = j.at("chunking").at("average_size").get<std::size_t>();
+        chunking_.max_size = j.at("chunking").at("max_size").get<std::size_t>();
+        return;
+    }
+    if (std::filesystem::exists(location_) && !std::filesystem::is_empty(location_)) {
+        throw std::runtime_error(location_.string() + " is not a backup repository, as it has no " + std::string(file_name));
+    }
+    std::filesystem::create_directories(location_ / std::filesystem::path(generations_directory));
+    // the chunks are spread over 256 directories by the first byte of their hash
+    for (std::size_t i = 0; i < 256; i++) {
+        std::array<char, 3> name{};
+        std::snprintf(name.data(), name.size(), "%02zx", i);  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+        std::filesystem::create_directories(location_ / std::filesystem::path(chunks_directory) / std::filesystem::path(name.data()));
+    }
+    nlohmann::json j{};
+    j["version"] = format_version;
+    j["chunking"]["min_size"] = chunking_.min_size;
+    j["chunking"]["average_size"] = chunking_.average_size;
+    j["chunking"]["max_size"] = chunking_.max_size;
+    auto contents = j.dump(4) + '\n';
+    write_atomically(marker, contents.data(), contents.size());
+    sync_directory(location_);
+}
+
+std::filesystem::path chunk_repository::chunk_path(const std::string& hash) const {
+    return location_ / std::filesystem::path(chunks_directory) / std::filesystem::path(hash.substr(0, 2)) / std::filesystem::path(hash);
+}
+
+// the chunks written by a store(), which are shared by its threads
+struct chunk_repository::store_state {
+    std::mutex mtx{};
+    std::set<std::string> writing{};  // the hashes of the chunks being checked or written by a thread
+    std::set<std::filesystem::path> directories{};  // the directories to be synced before the index is written
+    std::uintmax_t new_bytes{};
+    std::uintmax_t new_chunks{};
+};
+
+void chunk_repository::store_chunk(const std::string& hash, const char* data, std::size_t length, store_state& state) const {
+    auto path = chunk_path(hash);
+    {
+        // the same chunk found by another thread at the same time is written and counted by that thread
+        std::unique_lock<std::mutex> lock(state.mtx);
+        if (!state.writing.emplace(hash).second) {
+            return;
+        }
+    }
+    bool written = false;
+    try {
+        // a chunk left by a store() interrupted by a crash can be shorter than its contents, thus it is written again
+        std::error_code ec{};
+        if (auto size = std::filesystem::file_size(path, ec); ec || size != length) {
+            write_atomically(path, data, length);
+            written = true;
+        }
+    } catch (...) {
+        std::unique_lock<std::mutex> lock(state.mtx);
+        state.writing.erase(hash);
+        throw;
+    }
+    std::unique_lock<std::mutex> lock(state.mtx);
+    state.writing.erase(hash);
+    if (written) {
+        state.directories.emplace(path.parent_path());
+        state.new_bytes += length;
+        state.new_chunks++;
+    }
+}
+
+generation_file chunk_repository::store_file(const repository_source& file, const copy_options& options, store_state& state) const {
+    file_descriptor in(open(file.source.c_str(), O_RDONLY | O_CLOEXEC));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    if (in.get() < 0) {
+        throw std::filesystem::filesystem_error("cannot open the file", file.source, std::error_code(errno, std::system_category()));
+    }
+    struct stat st{};
+    if (fstat(in.get(), &st) != 0) {
+        throw std::filesystem::filesystem_error("cannot stat the file", file.source, std::error_code(errno, std::system_category()));
+    }
+    posix_fadvise(in.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    generation_file result{file.name, manifest_entry{static_cast<std::uintmax_t>(st.st_size), manifest::mtime_of(file.source), {}, static_cast<std::uintmax_t>(st.st_size), file.is_mutable, file.detached}, {}};
+    // the size is fixed at the beginning as in the archive, thus the data appended during the backup is not stored
+    auto size = static_cast<off_t>(st.st_size);
+    std::vector<char> buffer(chunking_.max_size * 2);
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    off_t offset = 0;
+    std::uint32_t crc = 0;
+    while (offset < size || begin < end) {
+        // keeps at least max_size bytes in the buffer unless the file has been read to the end
+        if (end - begin < chunking_.max_size && offset < size) {
+            std::memmove(buffer.data(), buffer.data() + begin, end - begin);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            end -= begin;
+            begin = 0;
+            while (end < buffer.size() && offset < size) {
+                auto length = std::min(buffer.size() - end, static_cast<std::size_t>(size - offset));
+                if (options.limiter != nullptr) {
+                    options.limiter->acquire(length);
+                }
+                auto n = pread(in.get(), buffer.data() + end, length, offset);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw std::filesystem::filesystem_error("cannot read the file", file.source, std::error_code(errno, std::system_category()));
+                }
+                if (n == 0) {
+                    throw std::filesystem::filesystem_error("the file has been truncated while being stored", file.source, std::error_code(EIO, std::system_category()));
+                }
+                if (options.drop_cache) {
+                    posix_fadvise(in.get(), offset, n, POSIX_FADV_DONTNEED);
+                }
+                if (options.meter != nullptr) {
+                    options.meter->add(static_cast<std::uintmax_t>(n));
+                }
+                end += static_cast<std::size_t>(n);
+                offset += n;
+            }
+        }
+        const char* chunk = buffer.data() + begin;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        auto length = chunk_boundary(chunk, end - begin, chunking_);
+        crc = crc32c(crc, chunk, length);
+        auto hash = sha256_hex(chunk, length);
+        store_chunk(hash, chunk, length, state);
+        result.chunks.emplace_back(std::move(hash));
+        begin += length;
+    }
+    result.entry.checksum = checksum_string(crc);
+    return result;
+}
+
+static nlohmann::json to_json(const generation_file& file) {
+    nlohmann::json j{};
+    j["name"] = file.name;
+    j["size"] = file.entry.size;
+    j["mtime"] = file.entry.mtime;
+    j["checksum"] = file.entry.checksum;
+    if (file.entry.is_mutable) {
+        j["mutable"] = true;
+    }
+    if (file.entry.detached) {
+        j["detached"] = true;
+    }
+    j["chunks"] = file.chunks;
+    return j;
+}
+
+static std::string generation_name() {
+    auto now = std::time(nullptr);
+    std::tm tm{};
+    gmtime_r(&now, &tm);
+    std::array<char, 32> buf{};
+    std::strftime(buf.data(), buf.size(), "%Y%m%dT%H%M%SZ", &tm);
+    return {buf.data()};
+}
+
+std::string chunk_repository::store(const std::vector<repository_source>& files,
+                                    const std::optional<log_range>& detail,
+                                    std::size_t parallelism,
+                                    const copy_options& options,
+                                    const progress_callback& callback) {
+    std::vector<std::filesystem::path> paths{location_};
+    std::uintmax_t total_bytes = 0;
+    for (auto&& file : files) {
+        paths.emplace_back(file.source);
+        total_bytes += std::filesystem::file_size(file.source);
+    }
+    if (parallelism == 0) {
+        parallelism = parallel_copy::default_parallelism(paths);
+    }
+
+    std::vector<generation_file> stored(files.size());
+    store_state state{};
+    std::uintmax_t completed_bytes = 0;
+    std::mutex mtx{};
+    for (bool mutable_phase : {false, true}) {
+        std::vector<std::size_t> targets{};
+        for (std::size_t i = 0; i < files.size(); i++) {
+            if (files.at(i).is_mutable == mutable_phase) {
+                targets.emplace_back(i);
+            }
+        }
+        run_parallel(targets.size(), parallelism, [&](std::size_t i) {
+            auto index = targets.at(i);
+            {
+                progress_meter::file_scope scope(options.meter, files.at(index).name);
+                stored.at(index) = store_file(files.at(index), options, state);
+                scope.complete();
+            }
+            std::unique_lock<std::mutex> lock(mtx);
+            completed_bytes += stored.at(index).entry.size;
+            if (callback) {
+                callback(stored.at(index).name, stored.at(index).entry.size, completed_bytes, total_bytes);
+            }
+        });
+    }
+
+    nlohmann::json j{};
+    j["version"] = format_version;
+    if (detail) {
+        j["detail"]["type"] = detail->backup_type;
+        j["detail"]["log_begin"] = detail->log_begin;
+        j["detail"]["log_end"] = detail->log_end;
+        if (detail->image_finish) {
+            j["detail"]["image_finish"] = detail->image_finish.value();
+        }
+    }
+    j["files"] = nlohmann::json::array();
+    stats_ = repository_stats{};
+    for (auto&& file : stored) {
+        j["files"].emplace_back(to_json(file));
+        stats_.bytes += file.entry.size;
+        stats_.chunks += file.chunks.size();
+    }
+    stats_.new_bytes = state.new_bytes;
+    stats_.new_chunks = state.new_chunks;
+
+    // the chunks are made durable before the index refers to them
+    for (auto&& d : state.directories) {
+        sync_directory(d);
+    }
+
+    auto name = generation_name();
+    auto directory = location_ / std::filesystem::path(generations_directory);
+    for (std::size_t i = 1; std::filesystem::exists(directory / std::filesystem::path(name + std::string(index_suffix))); i++) {
+        name = generation_name() + "-" + std::to_string(i);
+    }
+    auto contents = j.dump(4) + '\n';
+    write_atomically(directory / std::filesystem::path(name + std::string(index_suffix)), contents.data(), contents.size());
+    sync_directory(directory);
+    return name;
+}
+
+std::vector<std::string> chunk_repository::generations() const {
+    std::vector<std::string> names{};
+    for (auto&& entry : std::filesystem::directory_iterator(location_ / std::filesystem::path(generations_directory))) {
+        if (entry.is_regular_file() && entry.path().extension() == index_suffix) {
+            names.emplace_back(entry.path().stem().string());
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+void chunk_repository::materialize_file(const generation_file& file, const std::filesystem::path& directory) const {
+    auto dst = directory / std::filesystem::path(file.name);
+    std::filesystem::create_directories(dst.parent_path());
+    file_descriptor out(open(dst.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+    if (out.get() < 0) {
+        throw std::filesystem::filesystem_error("cannot create the file", dst, std::error_code(errno, std::system_category()));
+    }
+    std::vector<char> buffer(chunking_.max_size);
+    std::uint32_t crc = 0;
+    std::uintmax_t size = 0;
+    for (auto&& hash : file.chunks) {
+        auto path = chunk_path(hash);
+        file_descriptor in(open(path.c_str(), O_RDONLY | O_CLOEXEC));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+        if (in.get() < 0) {
+            throw std::filesystem::filesystem_error("cannot open the chunk of " + file.name, path, std::error_code(errno, std::system_category()));
+        }
+        while (true) {
+            auto n = ::read(in.get(), buffer.data(), buffer.size());
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::filesystem::filesystem_error("cannot read the chunk of " + file.name, path, std::error_code(errno, std::system_category()));
+            }
+            if (n == 0) {
+                break;
+            }
+            crc = crc32c(crc, buffer.data(), static_cast<std::size_t>(n));
+            write_fully(out.get(), buffer.data(), static_cast<std::size_t>(n), dst);
+            size += static_cast<std::uintmax_t>(n);
+        }
+    }
+    if (size != file.entry.size || checksum_string(crc) != file.entry.checksum) {
+        throw std::runtime_error(file.name + " in the repository does not match its checksum, some of its chunks are broken");
+    }
+}
+
+manifest chunk_repository::materialize(const std::string& generation,
+                                       const std::filesystem::path& directory,
+                                       std::size_t parallelism,
+                                       const progress_callback& callback) const {
+    auto index = location_ / std::filesystem::path(generations_directory) / std::filesystem::path(generation + std::string(index_suffix));
+    std::ifstream strm(index);
+    if (!strm) {
+        throw std::runtime_error("the generation " + generation + " does not exist in " + location_.string());
+    }
+    auto j = nlohmann::json::parse(strm, nullptr, false);
+    if (j.is_discarded() || !j.is_object() || j.value("version", 0) > format_version) {
+        throw std::runtime_error("the index of the generation " + generation + " is broken or of an unsupported version");
+    }
+
+    manifest mf{};
+    std::vector<generation_file> files{};
+    std::uintmax_t total_bytes = 0;
+    try {
+        if (j.contains("detail")) {
+            const auto& d = j.at("detail");
+            log_range range{d.value("type", ""), d.at("log_begin").get<std::uint64_t>(), d.at("log_end").get<std::uint64_t>(), {}};
+            if (d.contains("image_finish")) {
+                range.image_finish = d.at("image_finish").get<std::uint64_t>();
+            }
+            mf.detail(std::move(range));
+        }
+        for (auto&& f : j.at("files")) {
+            generation_file file{};
+            file.name = f.at("name").get<std::string>();
+            auto relative = std::filesystem::path(file.name).lexically_normal();
+            if (relative.empty() || relative.is_absolute() || *relative.begin() == "..") {
+                throw std::runtime_error("the file " + file.name + " is out of the backup directory");
+            }
+            file.entry.size = f.at("size").get<std::uintmax_t>();
+            file.entry.mtime = f.at("mtime").get<std::int64_t>();
+            file.entry.checksum = f.at("checksum").get<std::string>();
+            file.entry.source_size = file.entry.size;
+            file.entry.is_mutable = f.value("mutable", false);
+            file.entry.detached = f.value("detached", false);
+            file.chunks = f.at("chunks").get<std::vector<std::string>>();
+            for (auto&& hash : file.chunks) {
+                if (hash.size() < 2 || hash.find_first_not_of("0123456789abcdef") != std::string::npos) {
+                    throw std::runtime_error("the chunk " + hash + " of " + file.name + " is not a SHA-256");
+                }
+            }
+            total_bytes += file.entry.size;
+            mf.add(file.name, file.entry);
+            files.emplace_back(std::move(file));
+        }
+    } catch (nlohmann::json::exception& ex) {
+        throw std::runtime_error("the index of the generation " + generation + " is broken, as " + ex.what());
+    }
+
+    if (parallelism == 0) {
+        parallelism = parallel_copy::default_parallelism({location_, directory});
+    }
+    std::filesystem::create_directories(directory);
+    std::uintmax_t completed_bytes = 0;
+    std::mutex mtx{};
+    run_parallel(files.size(), parallelism, [&](std::size_t i) {
+        materialize_file(files.at(i), directory);
+        std::unique_lock<std::mutex> lock(mtx);
+        completed_bytes += files.at(i).entry.size;
+        if (callback) {
+            callback(files.at(i).name, files.at(i).entry.size, completed_bytes, total_bytes);
+        }
+    });
+    return mf;
+}
+
+}  // tateyama::datastore
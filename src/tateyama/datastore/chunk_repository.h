@@ -0,0 +1,164 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "copy_engine.h"
+#include "manifest.h"
+
+namespace tateyama::datastore {
+
+/**
+ * @brief the parameters of the content-defined chunking, which are fixed for each repository
+ */
+struct chunking {
+    std::size_t min_size{256UL * 1024UL};
+    std::size_t average_size{1024UL * 1024UL};  // approximately, the boundaries are looked for after min_size
+    std::size_t max_size{4UL * 1024UL * 1024UL};
+};
+
+/**
+ * @brief returns the length of the first chunk of the data, whose end is found by a gear rolling hash
+ * @details as the boundaries depend only on the bytes just before them, a change in a file moves the boundaries
+ * around the change only, and the other chunks remain the same.
+ * @param data the data beginning at a chunk boundary
+ * @param length the length of the data, which must be at least params.max_size unless the data reaches the end of the file
+ * @param params the chunking parameters
+ */
+[[nodiscard]] std::size_t chunk_boundary(const char* data, std::size_t length, const chunking& params) noexcept;
+
+/**
+ * @brief a file to be stored into the repository
+ */
+struct repository_source {
+    std::filesystem::path source;
+    std::string name;  // the path relative to the backup directory
+    bool is_mutable;
+    bool detached;
+};
+
+/**
+ * @brief a file in a generation, which is the concatenation of the chunks
+ */
+struct generation_file {
+    std::string name;
+    manifest_entry entry;  // the size and checksum of the whole file
+    std::vector<std::string> chunks;  // the SHA-256 of the chunks in hex
+};
+
+/**
+ * @brief the statistics of store()
+ */
+struct repository_stats {
+    std::uintmax_t bytes{};
+    std::uintmax_t chunks{};
+    std::uintmax_t new_bytes{};   // the bytes of the chunks which were not in the repository
+    std::uintmax_t new_chunks{};
+};
+
+/**
+ * @brief a backup repository storing the generations of backups in chunks deduplicated by their content
+ * @details the files are split by content-defined chunking and each chunk is stored once under chunks/ by its SHA-256,
+ * while each generation is described by an index under generations/, listing the chunks of its files. Thus the storage
+ * grows with the data changed between the generations rather than with the number of generations.
+ */
+class chunk_repository {
+public:
+    static constexpr std::string_view file_name = "tgctl-repository.json";
+    static constexpr int format_version = 1;
+
+    /**
+     * @brief the callback called each time a file has been stored or materialized, by one thread at a time
+     * @param name the name of the file
+     * @param size the size of the file
+     * @param completed_bytes the total size of the files processed so far
+     * @param total_bytes the total size of the files to be processed
+     */
+    using progress_callback = std::function<void(const std::string& name, std::uintmax_t size, std::uintmax_t completed_bytes, std::uintmax_t total_bytes)>;
+
+    /**
+     * @brief opens the repository, which is initialized if the directory does not exist or is empty
+     * @throws std::runtime_error if the directory is not a repository
+     */
+    explicit chunk_repository(std::filesystem::path location);
+
+    /**
+     * @brief stores the files as a new generation
+     * @details the immutable files are stored in parallel first and the mutable files at the end. The index of the
+     * generation is written after all the chunks are synced to the disk, so that a generation interrupted is never seen,
+     * and a chunk left by an interrupted store() is reused only if its size matches.
+     * @param files the files to be stored
+     * @param detail the log range of the backup, or std::nullopt
+     * @param parallelism the number of threads, 0 means parallel_copy::default_parallelism()
+     * @param options the limiter and drop_cache are used in reading the files
+     * @param callback called each time a file has been stored
+     * @return the name of the generation
+     */
+    std::string store(const std::vector<repository_source>& files,
+                      const std::optional<log_range>& detail,
+                      std::size_t parallelism,
+                      const copy_options& options,
+                      const progress_callback& callback);
+
+    /**
+     * @brief writes the files of the generation into the directory, making a backup directory
+     * @details the manifest is not written into the directory, so that the directory can be restored as it is
+     * @param generation the name of the generation
+     * @param directory the directory, which is created if it does not exist
+     * @param parallelism the number of threads, 0 means parallel_copy::default_parallelism()
+     * @param callback called each time a file has been written
+     * @return the manifest of the generation
+     * @throws std::runtime_error if the generation does not exist or a file does not match its checksum
+     */
+    manifest materialize(const std::string& generation,
+                     const std::filesystem::path& directory,
+                     std::size_t parallelism,
+                     const progress_callback& callback) const;
+
+    /**
+     * @brief returns the names of the generations, oldest first
+     */
+    [[nodiscard]] std::vector<std::string> generations() const;
+
+    [[nodiscard]] const repository_stats& stats() const noexcept {
+        return stats_;
+    }
+
+    [[nodiscard]] const std::filesystem::path& location() const noexcept {
+        return location_;
+    }
+
+private:
+    std::filesystem::path location_;
+    chunking chunking_{};
+    repository_stats stats_{};
+
+    struct store_state;
+
+    [[nodiscard]] std::filesystem::path chunk_path(const std::string& hash) const;
+    void store_chunk(const std::string& hash, const char* data, std::size_t length, store_state& state) const;
+    generation_file store_file(const repository_source& file, const copy_options& options, store_state& state) const;
+    void materialize_file(const generation_file& file, const std::filesystem::path& directory) const;
+};
+
+}  // tateyama::datastore
@@ -0,0 +1,517 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef ENABLE_BACKUP_COMPRESSION
+#include <zstd.h>
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+
+#include "compression.h"
+#include "crc32c.h"
+#include "file_descriptor.h"
+#include "io_control.h"
+#include "progress_meter.h"
+
+namespace tateyama::datastore {
+
+constexpr std::array<char, 4> compressed_magic = {'T', 'G', 'C', 'Z'};
+constexpr std::uint16_t compressed_format_version = 1;
+constexpr std::uint32_t compressed_block_size = 1024UL * 1024UL;
+constexpr std::uint32_t compressed_block_size_max = 64UL * 1024UL * 1024UL;
+constexpr int zstd_default_level = 3;
+constexpr int zstd_max_level = 22;
+constexpr int lz4_default_level = 1;
+constexpr int lz4_max_level = 12;
+
+namespace {
+
+// the header of the compressed file, followed by the blocks,
+// the integers are in the byte order of the host, as a backup is restored on the same architecture
+struct file_header {
+    std::array<char, 4> magic;
+    std::uint16_t version;
+    std::uint8_t codec;
+    std::uint8_t reserved;
+    std::uint32_t block_size;
+    std::uint32_t reserved2;
+    std::uint64_t original_size;
+};
+static_assert(sizeof(file_header) == 24);
+
+enum class block_kind : std::uint8_t {
+    zeros = 0,       // no data follows
+    raw = 1,         // stored as is, as it cannot be compressed
+    compressed = 2,
+};
+
+struct block_header {
+    std::uint32_t stored_size;  // the size of the data following the header
+    std::uint32_t raw_size;
+    std::uint32_t crc;          // CRC32C of the raw data
+    block_kind kind;
+    std::array<std::uint8_t, 3> reserved;
+};
+static_assert(sizeof(block_header) == 16);
+
+// holds the compression context of a thread, which is reused for all the blocks the thread handles
+class codec_context {
+public:
+    explicit codec_context(compression_codec codec) noexcept : codec_(codec) {
+    }
+    ~codec_context() {
+#ifdef ENABLE_BACKUP_COMPRESSION
+        if (cctx_ != nullptr) {
+            ZSTD_freeCCtx(cctx_);
+        }
+        if (dctx_ != nullptr) {
+            ZSTD_freeDCtx(dctx_);
+        }
+#endif
+    }
+    codec_context(codec_context const& other) = delete;
+    codec_context& operator=(codec_context const& other) = delete;
+    codec_context(codec_context&& other) noexcept = delete;
+    codec_context& operator=(codec_context&& other) noexcept = delete;
+
+    [[nodiscard]] std::size_t bound(std::size_t size) const noexcept {
+#ifdef ENABLE_BACKUP_COMPRESSION
+        switch (codec_) {
+        case compression_codec::zstd: return ZSTD_compressBound(size);
+        case compression_codec::lz4: return static_cast<std::size_t>(LZ4_compressBound(static_cast<int>(size)));
+        case compression_codec::none: break;
+        }
+#endif
+        return size;
+    }
+
+    // returns the compressed size, or 0 if the data cannot be compressed
+    std::size_t compress(const char* src, std::size_t size, char* dst, std::size_t capacity, int level) noexcept {
+#ifdef ENABLE_BACKUP_COMPRESSION
+        switch (codec_) {
+        case compression_codec::zstd: {
+            if (cctx_ == nullptr && (cctx_ = ZSTD_createCCtx()) == nullptr) {
+                return 0;
+            }
+            auto n = ZSTD_compressCCtx(cctx_, dst, capacity, src, size, level);
+            return ZSTD_isError(n) != 0 ? 0 : n;
+        }
+        case compression_codec::lz4: {
+            auto n = (level <= 1) ?
+                LZ4_compress_default(src, dst, static_cast<int>(size), static_cast<int>(capacity)) :
+                LZ4_compress_HC(src, dst, static_cast<int>(size), static_cast<int>(capacity), level);
+            return n <= 0 ? 0 : static_cast<std::size_t>(n);
+        }
+        case compression_codec::none: break;
+        }
+#endif
+        (void) src; (void) size; (void) dst; (void) capacity; (void) level;
+        return 0;
+    }
+
+    // returns true if exactly raw_size bytes have been decompressed
+    bool decompress(const char* src, std::size_t size, char* dst, std::size_t raw_size) noexcept {
+#ifdef ENABLE_BACKUP_COMPRESSION
+        switch (codec_) {
+        case compression_codec::zstd: {
+            if (dctx_ == nullptr && (dctx_ = ZSTD_createDCtx()) == nullptr) {
+                return false;
+            }
+            auto n = ZSTD_decompressDCtx(dctx_, dst, raw_size, src, size);
+            return ZSTD_isError(n) == 0 && n == raw_size;
+        }
+        case compression_codec::lz4:
+            return LZ4_decompress_safe(src, dst, static_cast<int>(size), static_cast<int>(raw_size)) == static_cast<int>(raw_size);
+        case compression_codec::none: break;
+        }
+#endif
+        (void) src; (void) size; (void) dst; (void) raw_size;
+        return false;
+    }
+
+private:
+    compression_codec codec_;
+#ifdef ENABLE_BACKUP_COMPRESSION
+    ZSTD_CCtx* cctx_{};
+    ZSTD_DCtx* dctx_{};
+#endif
+};
+
+}  // namespace
+
+[[noreturn]] static void throw_error(const std::string& what, const std::filesystem::path& src, const std::filesystem::path& dst, int err) {
+    throw std::filesystem::filesystem_error(what, src, dst, std::error_code(err, std::system_category()));
+}
+
+// returns the bytes read, which is less than length only at the end of the file, or -1 with errno
+static ssize_t read_fully(int fd, void* data, std::size_t length, off_t offset) {
+    std::size_t done = 0;
+    while (done < length) {
+        auto n = pread(fd, static_cast<char*>(data) + done, length - done, offset + static_cast<off_t>(done));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        done += n;
+    }
+    return static_cast<ssize_t>(done);
+}
+
+// returns 0 or errno
+static int write_fully(int fd, const void* data, std::size_t length, off_t offset) {
+    std::size_t done = 0;
+    while (done < length) {
+        auto n = pwrite(fd, static_cast<const char*>(data) + done, length - done, offset + static_cast<off_t>(done));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        done += n;
+    }
+    return 0;
+}
+
+static bool all_zeros(const char* data, std::size_t length) noexcept {
+    return length == 0 || (data[0] == 0 && std::memcmp(data, data + 1, length - 1) == 0);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+// runs the worker on the threads including the calling one
+template <class Worker>
+static void run_workers(std::size_t threads, Worker&& worker) {
+    std::vector<std::thread> workers{};
+    workers.reserve(threads - 1);
+    for (std::size_t i = 1; i < threads; i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto&& t : workers) {
+        t.join();
+    }
+}
+
+bool compression_available(compression_codec codec) noexcept {
+#ifdef ENABLE_BACKUP_COMPRESSION
+    return codec != compression_codec::none;
+#else
+    (void) codec;
+    return false;
+#endif
+}
+
+std::optional<compression> parse_compression(std::string_view spec) {
+    auto colon = spec.find(':');
+    auto name = spec.substr(0, colon);
+    compression comp{};
+    int max_level{};
+    if (name == "zstd") {
+        comp = {compression_codec::zstd, zstd_default_level};
+        max_level = zstd_max_level;
+    } else if (name == "lz4") {
+        comp = {compression_codec::lz4, lz4_default_level};
+        max_level = lz4_max_level;
+    } else {
+        return std::nullopt;
+    }
+    if (colon != std::string_view::npos) {
+        auto level = spec.substr(colon + 1);
+        if (level.empty() || level.length() > 2 || !std::all_of(level.begin(), level.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            return std::nullopt;
+        }
+        comp.level = std::stoi(std::string(level));
+        if (comp.level < 1 || comp.level > max_level) {
+            return std::nullopt;
+        }
+    }
+    return comp;
+}
+
+std::string to_string(compression comp) {
+    return std::string(to_string_view(comp.codec)) + ":" + std::to_string(comp.level);
+}
+
+copy_result compress_file(const std::filesystem::path& src, const std::filesystem::path& dst, compression comp, std::size_t threads, const copy_options& options) {  //NOLINT(readability-function-cognitive-complexity)
+    file_descriptor in(open(src.c_str(), O_RDONLY | O_CLOEXEC));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    if (in.get() < 0) {
+        throw_error("cannot open the file", src, dst, errno);
+    }
+    struct stat st{};
+    if (fstat(in.get(), &st) != 0) {
+        throw_error("cannot stat the file", src, dst, errno);
+    }
+    if (!S_ISREG(st.st_mode)) {  // NOLINT(hicpp-signed-bitwise)
+        throw_error("not a regular file", src, dst, EINVAL);
+    }
+    if (!compression_available(comp.codec)) {
+        throw_error("the compression is not available", src, dst, ENOTSUP);
+    }
+    file_descriptor out(open(dst.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, st.st_mode & 07777));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+    if (out.get() < 0) {
+        throw_error("cannot create the file", src, dst, errno);
+    }
+    posix_fadvise(in.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    try {
+        auto size = static_cast<std::uint64_t>(st.st_size);
+        copy_result result{copy_strategy::compress, 0};
+        file_header header{compressed_magic, compressed_format_version, static_cast<std::uint8_t>(comp.codec), 0, compressed_block_size, 0, size};
+        if (auto err = write_fully(out.get(), &header, sizeof(header), 0); err != 0) {
+            throw_error("cannot write the file", src, dst, err);
+        }
+        std::uint32_t crc = crc32c(0, &header, sizeof(header));
+        auto position = static_cast<off_t>(sizeof(header));
+
+        auto blocks = (size + compressed_block_size - 1) / compressed_block_size;
+        std::atomic_uint64_t next{};
+        std::atomic_bool failed{};
+        std::uint64_t next_write = 0;
+        std::exception_ptr error{};
+        std::mutex mtx{};
+        std::condition_variable cond{};
+
+        // the blocks are compressed in parallel and written in order, the thread having the block to be written next
+        // never waits for another, as each thread takes the next block only after it has written its own
+        run_workers(std::max(std::min(threads, static_cast<std::size_t>(blocks)), static_cast<std::size_t>(1)), [&]() {
+            codec_context context(comp.codec);
+            std::vector<char> raw(compressed_block_size);
+            std::vector<char> stored(context.bound(compressed_block_size));
+            while (!failed) {
+                auto index = next.fetch_add(1);
+                if (index >= blocks) {
+                    return;
+                }
+                try {
+                    if (options.canceled()) {
+                        throw_error("the compression has been canceled", src, dst, ECANCELED);
+                    }
+                    auto offset = static_cast<off_t>(index * compressed_block_size);
+                    auto length = static_cast<std::size_t>(std::min(static_cast<std::uint64_t>(compressed_block_size), size - offset));
+                    if (options.limiter != nullptr) {
+                        options.limiter->acquire(length);
+                    }
+                    auto n = read_fully(in.get(), raw.data(), length, offset);
+                    if (n < 0) {
+                        throw_error("cannot read the file", src, dst, errno);
+                    }
+                    if (options.drop_cache) {
+                        posix_fadvise(in.get(), offset, static_cast<off_t>(length), POSIX_FADV_DONTNEED);
+                    }
+                    if (options.meter != nullptr) {
+                        options.meter->add(length);
+                    }
+                    std::fill(raw.begin() + n, raw.begin() + static_cast<std::ptrdiff_t>(length), 0);  // the file has been truncated
+
+                    block_header bh{0, static_cast<std::uint32_t>(length), crc32c(0, raw.data(), length), block_kind::zeros, {}};
+                    const char* payload = nullptr;
+                    if (!all_zeros(raw.data(), length)) {
+                        if (auto c = context.compress(raw.data(), length, stored.data(), stored.size(), comp.level); c > 0 && c < length) {
+                            bh.kind = block_kind::compressed;
+                            bh.stored_size = static_cast<std::uint32_t>(c);
+                            payload = stored.data();
+                        } else {
+                            bh.kind = block_kind::raw;
+                            bh.stored_size = static_cast<std::uint32_t>(length);
+                            payload = raw.data();
+                        }
+                    }
+
+                    std::unique_lock<std::mutex> lock(mtx);
+                    cond.wait(lock, [&]{ return next_write == index || failed; });
+                    if (failed) {
+                        return;
+                    }
+                    if (auto err = write_fully(out.get(), &bh, sizeof(bh), position); err != 0) {
+                        throw_error("cannot write the file", src, dst, err);
+                    }
+                    if (auto err = write_fully(out.get(), payload, bh.stored_size, position + static_cast<off_t>(sizeof(bh))); err != 0) {
+                        throw_error("cannot write the file", src, dst, err);
+                    }
+                    crc = crc32c(crc32c(crc, &bh, sizeof(bh)), payload, bh.stored_size);
+                    if (options.drop_cache) {
+                        auto written = static_cast<off_t>(sizeof(bh) + bh.stored_size);
+                        sync_file_range(out.get(), position, written, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);  // NOLINT(hicpp-signed-bitwise)
+                        posix_fadvise(out.get(), position, written, POSIX_FADV_DONTNEED);
+                    }
+                    position += static_cast<off_t>(sizeof(bh) + bh.stored_size);
+                    next_write++;
+                    cond.notify_all();
+                } catch (...) {
+                    std::unique_lock<std::mutex> lock(mtx);
+                    if (!failed) {
+                        error = std::current_exception();
+                        failed = true;
+                    }
+                    cond.notify_all();
+                    return;
+                }
+            }
+        });
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        result.data_bytes = static_cast<std::uintmax_t>(position);
+        result.checksum = crc;
+        return result;
+    } catch (std::filesystem::filesystem_error &e) {
+        unlink(dst.c_str());
+        throw;
+    }
+}
+
+static file_header read_header(int fd, const std::filesystem::path& src, const std::filesystem::path& dst) {
+    file_header header{};
+    if (read_fully(fd, &header, sizeof(header), 0) != sizeof(header) ||
+        header.magic != compressed_magic ||
+        header.version > compressed_format_version ||
+        header.block_size == 0 || header.block_size > compressed_block_size_max) {
+        throw_error("not a compressed file", src, dst, EBADMSG);
+    }
+    return header;
+}
+
+std::uintmax_t original_size_of(const std::filesystem::path& file) {
+    file_descriptor fd(open(file.c_str(), O_RDONLY | O_CLOEXEC));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    if (fd.get() < 0) {
+        throw std::filesystem::filesystem_error("cannot open the file", file, std::error_code(errno, std::system_category()));
+    }
+    return read_header(fd.get(), file, {}).original_size;
+}
+
+copy_result decompress_file(const std::filesystem::path& src, const std::filesystem::path& dst, std::size_t threads) {  //NOLINT(readability-function-cognitive-complexity)
+    file_descriptor in(open(src.c_str(), O_RDONLY | O_CLOEXEC));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    if (in.get() < 0) {
+        throw_error("cannot open the file", src, dst, errno);
+    }
+    struct stat st{};
+    if (fstat(in.get(), &st) != 0) {
+        throw_error("cannot stat the file", src, dst, errno);
+    }
+
+    // locates all the blocks first, so that they can be decompressed in parallel
+    auto header = read_header(in.get(), src, dst);
+    auto codec = static_cast<compression_codec>(header.codec);
+    if (!compression_available(codec)) {
+        throw_error("the compression of the file is not available", src, dst, ENOTSUP);
+    }
+    auto size = header.original_size;
+    auto blocks = (size + header.block_size - 1) / header.block_size;
+    std::vector<std::pair<off_t, block_header>> index{};
+    index.reserve(blocks);
+    auto position = static_cast<off_t>(sizeof(header));
+    for (std::uint64_t i = 0; i < blocks; i++) {
+        block_header bh{};
+        if (read_fully(in.get(), &bh, sizeof(bh), position) != sizeof(bh) ||
+            bh.raw_size != std::min(static_cast<std::uint64_t>(header.block_size), size - (i * header.block_size)) ||
+            (bh.kind == block_kind::zeros && bh.stored_size != 0) ||
+            (bh.kind == block_kind::raw && bh.stored_size != bh.raw_size) ||
+            (bh.kind == block_kind::compressed && (bh.stored_size == 0 || bh.stored_size >= bh.raw_size)) ||
+            bh.kind > block_kind::compressed) {
+            throw_error("broken block header in the compressed file", src, dst, EBADMSG);
+        }
+        position += static_cast<off_t>(sizeof(bh));
+        index.emplace_back(position, bh);
+        position += static_cast<off_t>(bh.stored_size);
+    }
+    if (position != st.st_size) {
+        throw_error("the compressed file has been truncated or has garbage at the end", src, dst, EBADMSG);
+    }
+
+    file_descriptor out(open(dst.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, st.st_mode & 07777));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+    if (out.get() < 0) {
+        throw_error("cannot create the file", src, dst, errno);
+    }
+    try {
+        // the blocks of zeros are left as holes
+        if (ftruncate(out.get(), static_cast<off_t>(size)) != 0) {
+            throw_error("cannot set the size of the file", src, dst, errno);
+        }
+        std::atomic_size_t next{};
+        std::atomic_bool failed{};
+        std::atomic_uint64_t written{};
+        std::exception_ptr error{};
+        std::mutex mtx{};
+        run_workers(std::max(std::min(threads, index.size()), static_cast<std::size_t>(1)), [&]() {
+            codec_context context(codec);
+            std::vector<char> raw(header.block_size);
+            std::vector<char> stored(header.block_size);
+            while (!failed) {
+                auto i = next.fetch_add(1);
+                if (i >= index.size()) {
+                    return;
+                }
+                const auto& [offset, bh] = index.at(i);
+                if (bh.kind == block_kind::zeros) {
+                    continue;
+                }
+                try {
+                    if (auto n = read_fully(in.get(), stored.data(), bh.stored_size, offset); n != static_cast<ssize_t>(bh.stored_size)) {
+                        throw_error("cannot read the file", src, dst, n < 0 ? errno : EIO);
+                    }
+                    const char* data = stored.data();
+                    if (bh.kind == block_kind::compressed) {
+                        if (!context.decompress(stored.data(), bh.stored_size, raw.data(), bh.raw_size)) {
+                            throw_error("cannot decompress a block of the file", src, dst, EBADMSG);
+                        }
+                        data = raw.data();
+                    }
+                    if (crc32c(0, data, bh.raw_size) != bh.crc) {
+                        throw_error("checksum mismatch in a block of the file", src, dst, EBADMSG);
+                    }
+                    if (auto err = write_fully(out.get(), data, bh.raw_size, static_cast<off_t>(i * header.block_size)); err != 0) {
+                        throw_error("cannot write the file", src, dst, err);
+                    }
+                    written += bh.raw_size;
+                } catch (...) {
+                    std::unique_lock<std::mutex> lock(mtx);
+                    if (!failed) {
+                        error = std::current_exception();
+                        failed = true;
+                    }
+                    return;
+                }
+            }
+        });
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return {copy_strategy::decompress, written.load()};
+    } catch (std::filesystem::filesystem_error &e) {
+        unlink(dst.c_str());
+        throw;
+    }
+}
+
+}  // tateyama::datastore
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "copy_engine.h"
+
+namespace tateyama::datastore {
+
+/**
+ * @brief the compression algorithm of the backup files
+ */
+enum class compression_codec : std::uint8_t {
+    none = 0,
+    zstd = 1,
+    lz4 = 2,
+};
+
+/**
+ * @brief returns string representation of the value.
+ * @param value the target value
+ * @return the corresponded string representation
+ */
+[[nodiscard]] constexpr inline std::string_view to_string_view(compression_codec value) noexcept {
+    using namespace std::string_view_literals;
+    switch (value) {
+    case compression_codec::none: return "none"sv;
+    case compression_codec::zstd: return "zstd"sv;
+    case compression_codec::lz4: return "lz4"sv;
+    }
+    return "illegal codec"sv;
+}
+
+/**
+ * @brief the compression specified by --compress
+ */
+struct compression {
+    compression_codec codec{compression_codec::none};
+    int level{};
+};
+
+/**
+ * @brief the suffix appended to the name of a compressed file in the backup directory
+ */
+constexpr std::string_view compressed_suffix = ".tgcz";
+
+/**
+ * @brief returns whether tgctl is built with the codec
+ */
+[[nodiscard]] bool compression_available(compression_codec codec) noexcept;
+
+/**
+ * @brief parses the compression such as "zstd", "zstd:19" or "lz4:9"
+ * @details the default level is 3 for zstd and 1 for lz4, and lz4 uses the high compression mode for the level 2 or above.
+ * @return the compression, or std::nullopt if the codec is unknown or the level is out of range
+ */
+[[nodiscard]] std::optional<compression> parse_compression(std::string_view spec);
+
+/**
+ * @brief returns string representation such as "zstd:3"
+ */
+[[nodiscard]] std::string to_string(compression comp);
+
+/**
+ * @brief compresses a file into the block compressed format
+ * @details the file is divided into blocks of fixed size, which are compressed by the threads in parallel
+ * and written in order. Each block has a header with its sizes and CRC32C, thus the blocks can be located
+ * without decompressing the preceding ones. A block of zeros, such as a hole, is recorded by its header only.
+ * @param src the source file
+ * @param dst the destination file, which must not exist
+ * @param comp the compression
+ * @param threads the number of threads compressing blocks
+ * @param options the rate limit and dropping the page cache are applied, and CRC32C is always computed.
+ * O_DIRECT is not used, as the compressed blocks are not aligned.
+ * @return copy_strategy::compress, the bytes written and CRC32C of the destination
+ * @throws std::filesystem::filesystem_error if the compression fails, in which case the destination is removed
+ */
+copy_result compress_file(const std::filesystem::path& src, const std::filesystem::path& dst, compression comp, std::size_t threads, const copy_options& options = {});
+
+/**
+ * @brief decompresses a file written by compress_file()
+ * @details the blocks are decompressed by the threads in parallel, and the blocks of zeros are left as holes.
+ * @param src the compressed file
+ * @param dst the destination file, which must not exist
+ * @param threads the number of threads decompressing blocks
+ * @return copy_strategy::decompress and the bytes written
+ * @throws std::filesystem::filesystem_error if the file is broken or cannot be decompressed, in which case the destination is removed
+ */
+copy_result decompress_file(const std::filesystem::path& src, const std::filesystem::path& dst, std::size_t threads);
+
+/**
+ * @brief returns the size of the file before compression
+ * @throws std::filesystem::filesystem_error if the file is not a file written by compress_file()
+ */
+std::uintmax_t original_size_of(const std::filesystem::path& file);
+
+}  // tateyama::datastore
@@ -0,0 +1,375 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <linux/fs.h>
+
+#include "copy_engine.h"
+#include "crc32c.h"
+#include "file_descriptor.h"
+#include "io_control.h"
+#include "progress_meter.h"
+
+namespace tateyama::datastore {
+
+constexpr std::size_t copy_file_range_chunk = 64UL * 1024UL * 1024UL;
+constexpr std::size_t throttled_chunk = 1024UL * 1024UL;  // with a rate limit or dropping the page cache, so that they work smoothly
+constexpr std::size_t read_write_buffer_size = 1024UL * 1024UL;
+constexpr std::size_t direct_io_alignment = 4096;
+
+namespace {
+
+// computes CRC32C of the destination in the order of the offset while the file is copied
+class running_checksum {
+public:
+    void update(off_t offset, const char* data, std::size_t length) noexcept {
+        if (offset > hashed_) {
+            crc_ = crc32c_zeros(crc_, offset - hashed_);  // a hole
+        }
+        crc_ = crc32c(crc_, data, length);
+        hashed_ = offset + static_cast<off_t>(length);
+    }
+    [[nodiscard]] std::uint32_t finish(off_t end) noexcept {
+        if (end > hashed_) {
+            crc_ = crc32c_zeros(crc_, end - hashed_);
+            hashed_ = end;
+        }
+        return crc_;
+    }
+private:
+    std::uint32_t crc_{};
+    off_t hashed_{};
+};
+
+// the buffer for read(2)/write(2), aligned for O_DIRECT
+class aligned_buffer {
+public:
+    explicit aligned_buffer(std::size_t size) : data_(static_cast<char*>(std::aligned_alloc(direct_io_alignment, size))), size_(size) {  // NOLINT(cppcoreguidelines-owning-memory)
+        if (data_ == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+    ~aligned_buffer() {
+        std::free(data_);  // NOLINT(cppcoreguidelines-owning-memory, cppcoreguidelines-no-malloc)
+    }
+    aligned_buffer(aligned_buffer const& other) = delete;
+    aligned_buffer& operator=(aligned_buffer const& other) = delete;
+    aligned_buffer(aligned_buffer&& other) noexcept = delete;
+    aligned_buffer& operator=(aligned_buffer&& other) noexcept = delete;
+
+    [[nodiscard]] char* data() const noexcept {
+        return data_;
+    }
+    [[nodiscard]] std::size_t size() const noexcept {
+        return size_;
+    }
+private:
+    char* data_;
+    std::size_t size_;
+};
+
+// the state of a copy shared by the functions below
+struct copy_context {
+    int in;
+    int out;
+    const std::filesystem::path& src;
+    const std::filesystem::path& dst;
+    const copy_options& options;
+    bool direct_io;
+    running_checksum* checksum;
+    aligned_buffer buffer;
+};
+
+}  // namespace
+
+[[noreturn]] static void throw_error(const std::string& what, const std::filesystem::path& src, const std::filesystem::path& dst, int err) {
+    throw std::filesystem::filesystem_error(what, src, dst, std::error_code(err, std::system_category()));
+}
+
+static std::size_t align_up(std::size_t length) noexcept {
+    return (length + direct_io_alignment - 1) & ~(direct_io_alignment - 1);
+}
+
+// writes back the destination and drops [offset, offset + length) of both files from the page cache
+static void drop_pages(const copy_context& ctx, off_t offset, std::size_t length) {
+    sync_file_range(ctx.out, offset, static_cast<off_t>(length), SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);  // NOLINT(hicpp-signed-bitwise)
+    posix_fadvise(ctx.out, offset, static_cast<off_t>(length), POSIX_FADV_DONTNEED);
+    posix_fadvise(ctx.in, offset, static_cast<off_t>(length), POSIX_FADV_DONTNEED);
+}
+
+// copies [offset, offset + length) with read(2)/write(2), adding the bytes copied to copied, which falls short of length
+// if the file has been truncated, returns 0 or errno
+static int copy_by_read_write(copy_context& ctx, off_t offset, std::size_t length, std::uintmax_t& copied) {
+    auto* buffer = ctx.buffer.data();
+    while (length > 0) {
+        if (ctx.options.canceled()) {
+            return ECANCELED;
+        }
+        auto request = std::min(length, ctx.buffer.size());
+        if (ctx.direct_io) {
+            // the data beyond the range is the same as the source, thus it does no harm to copy it as well
+            request = std::min(align_up(request), ctx.buffer.size());
+        }
+        if (ctx.options.limiter != nullptr) {
+            ctx.options.limiter->acquire(request);
+        }
+        auto n = pread(ctx.in, buffer, request, offset);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        if (n == 0) {
+            return 0;  // the file has been truncated
+        }
+        auto used = std::min(static_cast<std::size_t>(n), length);
+        if (ctx.checksum != nullptr) {
+            ctx.checksum->update(offset, buffer, used);
+        }
+        auto to_write = static_cast<std::size_t>(n);
+        if (ctx.direct_io && to_write % direct_io_alignment != 0) {
+            // the end of the file, the padding is truncated after the copy
+            to_write = align_up(to_write);
+            std::memset(buffer + n, 0, to_write - n);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        } else if (!ctx.direct_io) {
+            to_write = used;
+        }
+        for (std::size_t written = 0; written < to_write; ) {
+            auto w = pwrite(ctx.out, buffer + written, to_write - written, offset + static_cast<off_t>(written));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errno;
+            }
+            written += w;
+        }
+        if (ctx.options.drop_cache && !ctx.direct_io) {
+            drop_pages(ctx, offset, to_write);
+        }
+        if (ctx.options.meter != nullptr) {
+            ctx.options.meter->add(used);
+        }
+        offset += static_cast<off_t>(used);
+        length -= used;
+        copied += used;
+    }
+    return 0;
+}
+
+// reads back [offset, offset + length) just written by copy_file_range(2), which is still in the page cache, returns 0 or errno
+static int read_back(copy_context& ctx, off_t offset, std::size_t length) {
+    auto* buffer = ctx.buffer.data();
+    while (length > 0) {
+        auto n = pread(ctx.out, buffer, std::min(length, ctx.buffer.size()), offset);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        if (n == 0) {
+            return EIO;
+        }
+        ctx.checksum->update(offset, buffer, static_cast<std::size_t>(n));
+        offset += n;
+        length -= n;
+    }
+    return 0;
+}
+
+static copy_result copy_data(copy_context& ctx, std::uintmax_t size) {  //NOLINT(readability-function-cognitive-complexity)
+    // copy_file_range(2) goes through the page cache, thus read(2)/write(2) is used for O_DIRECT
+    copy_result result{ctx.direct_io ? copy_strategy::read_write : copy_strategy::copy_file_range, 0};
+    auto chunk = (ctx.options.limiter != nullptr || ctx.options.drop_cache) ? throttled_chunk : copy_file_range_chunk;
+
+    // the destination is extended first, so that the holes left unwritten remain holes
+    if (ftruncate(ctx.out, static_cast<off_t>(size)) != 0) {
+        throw_error("cannot set the size of the file", ctx.src, ctx.dst, errno);
+    }
+    off_t position = 0;
+    auto end = static_cast<off_t>(size);
+    bool sparse_aware = true;
+    while (position < end) {
+        off_t data = position;
+        off_t hole = end;
+        if (sparse_aware) {
+            if (data = lseek(ctx.in, position, SEEK_DATA); data < 0) {
+                if (errno == ENXIO) {
+                    if (ctx.options.meter != nullptr) {
+                        ctx.options.meter->skip(static_cast<std::uintmax_t>(end - position));  // the hole at the end
+                    }
+                    break;  // no data beyond the position
+                }
+                // SEEK_DATA is not supported by the file system, thus the whole file is regarded as data
+                sparse_aware = false;
+                data = position;
+            } else if (hole = lseek(ctx.in, data, SEEK_HOLE); hole < 0) {
+                hole = end;
+            }
+        }
+        hole = std::min(hole, end);
+        if (ctx.options.meter != nullptr && data > position) {
+            ctx.options.meter->skip(static_cast<std::uintmax_t>(data - position));  // the hole is not copied
+        }
+
+        while (data < hole) {
+            auto length = static_cast<std::size_t>(hole - data);
+            if (result.strategy == copy_strategy::copy_file_range) {
+                if (ctx.options.canceled()) {
+                    throw_error("the copy has been canceled", ctx.src, ctx.dst, ECANCELED);
+                }
+                off_t off_in = data;
+                off_t off_out = data;
+                auto request = std::min(length, chunk);
+                if (ctx.options.limiter != nullptr) {
+                    ctx.options.limiter->acquire(request);
+                }
+                auto n = copy_file_range(ctx.in, &off_in, ctx.out, &off_out, request, 0);
+                if (n > 0) {
+                    if (ctx.checksum != nullptr) {
+                        if (auto err = read_back(ctx, data, static_cast<std::size_t>(n)); err != 0) {
+                            throw_error("cannot read the file copied", ctx.src, ctx.dst, err);
+                        }
+                    }
+                    if (ctx.options.drop_cache) {
+                        drop_pages(ctx, data, static_cast<std::size_t>(n));
+                    }
+                    if (ctx.options.meter != nullptr) {
+                        ctx.options.meter->add(static_cast<std::uintmax_t>(n));
+                    }
+                    data += n;
+                    result.data_bytes += n;
+                    continue;
+                }
+                if (n == 0) {
+                    hole = data;  // the file has been truncated
+                    end = data;
+                    break;
+                }
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EXDEV && errno != ENOSYS && errno != EINVAL && errno != EOPNOTSUPP && errno != EBADF) {
+                    throw_error("copy_file_range failed", ctx.src, ctx.dst, errno);
+                }
+                result.strategy = copy_strategy::read_write;
+            }
+            if (auto err = copy_by_read_write(ctx, data, length, result.data_bytes); err != 0) {
+                throw_error("cannot copy the file", ctx.src, ctx.dst, err);
+            }
+            data = hole;
+        }
+        position = hole;
+    }
+    if (ctx.direct_io && ftruncate(ctx.out, static_cast<off_t>(size)) != 0) {  // removes the padding of the last block
+        throw_error("cannot set the size of the file", ctx.src, ctx.dst, errno);
+    }
+    if (ctx.checksum != nullptr) {
+        result.checksum = ctx.checksum->finish(static_cast<off_t>(size));
+    }
+    return result;
+}
+
+// returns true if O_DIRECT has been set to the file descriptor, which fails on the file systems not supporting it
+static bool set_direct_io(int fd) {
+    auto flags = fcntl(fd, F_GETFL);  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_DIRECT) == 0;  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+}
+
+static void clear_direct_io(int fd) {
+    auto flags = fcntl(fd, F_GETFL);  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags & ~O_DIRECT);  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+    }
+}
+
+copy_result fast_copy_file(const std::filesystem::path& src, const std::filesystem::path& dst, const copy_options& options) {
+    file_descriptor in(open(src.c_str(), O_RDONLY | O_CLOEXEC));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    if (in.get() < 0) {
+        throw_error("cannot open the file", src, dst, errno);
+    }
+    struct stat st{};
+    if (fstat(in.get(), &st) != 0) {
+        throw_error("cannot stat the file", src, dst, errno);
+    }
+    if (!S_ISREG(st.st_mode)) {  // NOLINT(hicpp-signed-bitwise)
+        throw_error("not a regular file", src, dst, EINVAL);
+    }
+    // O_RDWR for reading back the data copied by copy_file_range(2) to compute the checksum
+    file_descriptor out(open(dst.c_str(), (options.compute_checksum ? O_RDWR : O_WRONLY) | O_CREAT | O_EXCL | O_CLOEXEC, st.st_mode & 07777));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+    if (out.get() < 0) {
+        throw_error("cannot copy file", src, dst, errno);
+    }
+
+    try {
+        // an instant copy on XFS and btrfs when both files are on the same file system
+        if (ioctl(out.get(), FICLONE, in.get()) == 0) {  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+            copy_result result{copy_strategy::reflink, static_cast<std::uintmax_t>(st.st_size)};
+            if (options.meter != nullptr) {
+                options.meter->skip(result.data_bytes);  // no data is copied, which would distort the rate
+            }
+            if (options.compute_checksum) {
+                result.checksum = crc32c_file(dst);  // the data never passes through the user space
+                if (options.drop_cache) {
+                    posix_fadvise(out.get(), 0, 0, POSIX_FADV_DONTNEED);
+                }
+            }
+            return result;
+        }
+
+        // falls back to the page cache if either file system does not support O_DIRECT
+        bool direct_io = options.direct_io && set_direct_io(in.get());
+        if (direct_io && !set_direct_io(out.get())) {
+            clear_direct_io(in.get());
+            direct_io = false;
+        }
+        running_checksum checksum{};
+        copy_context ctx{in.get(), out.get(), src, dst, options, direct_io, options.compute_checksum ? &checksum : nullptr, aligned_buffer(read_write_buffer_size)};
+        return copy_data(ctx, static_cast<std::uintmax_t>(st.st_size));
+    } catch (std::filesystem::filesystem_error &e) {
+        unlink(dst.c_str());
+        throw;
+    }
+}
+
+std::optional<copy_result> clone_file(const std::filesystem::path& previous, const std::filesystem::path& dst) {
+    struct stat st{};
+    if (stat(previous.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {  // NOLINT(hicpp-signed-bitwise)
+        return std::nullopt;
+    }
+    file_descriptor in(open(previous.c_str(), O_RDONLY | O_CLOEXEC));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    file_descriptor out(in.get() < 0 ? -1 : open(dst.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, st.st_mode & 07777));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+    if (out.get() < 0) {
+        return std::nullopt;
+    }
+    if (ioctl(out.get(), FICLONE, in.get()) == 0) {  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+        return copy_result{copy_strategy::reflink, 0};
+    }
+    unlink(dst.c_str());
+    return std::nullopt;
+}
+
+}  // tateyama::datastore
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+namespace tateyama::datastore {
+
+/**
+ * @brief the way a file has been copied
+ */
+enum class copy_strategy : std::int32_t {
+    reflink = 0,          // ioctl(FICLONE), sharing the extents with the source
+    copy_file_range,      // copy_file_range(2), the data is copied in the kernel
+    read_write,           // read(2) and write(2), the last resort
+    compress,             // compressed by compress_file()
+    decompress,           // decompressed by decompress_file()
+    stream,               // written into or read from a backup stream by archive_writer or archive_reader
+    chunk,                // stored into or materialized from a chunk_repository
+};
+
+/**
+ * @brief returns string representation of the value.
+ * @param value the target value
+ * @return the corresponded string representation
+ */
+[[nodiscard]] constexpr inline std::string_view to_string_view(copy_strategy value) noexcept {
+    using namespace std::string_view_literals;
+    switch (value) {
+    case copy_strategy::reflink: return "reflink"sv;
+    case copy_strategy::copy_file_range: return "copy_file_range"sv;
+    case copy_strategy::read_write: return "read_write"sv;
+    case copy_strategy::compress: return "compress"sv;
+    case copy_strategy::decompress: return "decompress"sv;
+    case copy_strategy::stream: return "stream"sv;
+    case copy_strategy::chunk: return "chunk"sv;
+    }
+    return "illegal strategy"sv;
+}
+
+/**
+ * @brief the result of fast_copy_file()
+ */
+struct copy_result {
+    copy_strategy strategy;
+    std::uintmax_t data_bytes;  // the bytes actually copied, which exclude the holes
+    std::optional<std::uint32_t> checksum{};  // crc32c of the destination, if computed
+};
+
+class rate_limiter;
+class progress_meter;
+
+/**
+ * @brief the options of fast_copy_file()
+ */
+struct copy_options {
+    bool compute_checksum{};     // computes CRC32C of the destination while copying
+    rate_limiter* limiter{};     // limits the rate of reading the source, no limit if nullptr
+    bool drop_cache{};           // drops the pages of both files from the page cache as the copy proceeds
+    bool direct_io{};            // O_DIRECT, which implies read(2)/write(2), if the file systems support it
+    progress_meter* meter{};     // counts the bytes copied for the progress, not counted if nullptr
+    const std::atomic_bool* cancel{};  // stops the copy with ECANCELED once set, e.g. by another copy failed, never stopped if nullptr
+
+    [[nodiscard]] bool canceled() const noexcept {
+        return cancel != nullptr && cancel->load();
+    }
+};
+
+/**
+ * @brief copies a file using the fastest way available
+ * @details tries ioctl(FICLONE) first, then copy_file_range(2) over the data segments found by
+ * SEEK_DATA/SEEK_HOLE so that the holes are kept, and read(2)/write(2) only if copy_file_range(2) is not available.
+ * The permissions of the source are applied to the destination.
+ * CRC32C of the destination is computed from the data being copied by read(2)/write(2),
+ * or from the data read back while it is still in the page cache by copy_file_range(2).
+ * @param src the source file
+ * @param dst the destination file, which must not exist
+ * @param options the options of the copy
+ * @return the strategy used and the bytes copied
+ * @throws std::filesystem::filesystem_error if the copy fails or is canceled, in which case the destination is removed
+ */
+copy_result fast_copy_file(const std::filesystem::path& src, const std::filesystem::path& dst, const copy_options& options = {});
+
+/**
+ * @brief makes the file in the previous generation of the backup appear as the destination without copying the data
+ * @details uses ioctl(FICLONE), which gives the destination its own inode sharing the extents. A hard link is never
+ * made, as it would make the generations share the inode, thus its permissions, and restoring or removing
+ * one generation could affect the others.
+ * @param previous the file in the previous generation
+ * @param dst the destination file, which must not exist
+ * @return the strategy used, or std::nullopt if the file cannot be cloned, e.g. across file systems, in which case it must be copied
+ */
+std::optional<copy_result> clone_file(const std::filesystem::path& previous, const std::filesystem::path& dst);
+
+}  // tateyama::datastore
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "copy_sample.h"
+#include "file_descriptor.h"
+#include "io_control.h"
+#include "parallel_copy.h"
+
+namespace tateyama::datastore {
+
+namespace {
+
+// a part of a source file copied as a sample
+struct segment {
+    std::filesystem::path source;
+    off_t offset;
+    std::size_t length;
+};
+
+}  // namespace
+
+static constexpr std::size_t segment_size = 8UL * 1024UL * 1024UL;
+static constexpr std::size_t buffer_size = 1024UL * 1024UL;
+
+// takes the segments from the beginning of the largest files, which dominate the duration of a backup
+static std::vector<segment> segments_of(const std::vector<std::filesystem::path>& sources, std::uintmax_t budget) {
+    std::vector<std::pair<std::filesystem::path, std::uintmax_t>> files{};
+    for (auto&& source : sources) {
+        files.emplace_back(source, std::filesystem::file_size(source));
+    }
+    std::stable_sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    std::vector<segment> segments{};
+    for (auto&& [source, size] : files) {
+        for (std::uintmax_t offset = 0; offset < size && budget > 0; ) {
+            auto length = static_cast<std::size_t>(std::min({static_cast<std::uintmax_t>(segment_size), size - offset, budget}));
+            segments.emplace_back(segment{source, static_cast<off_t>(offset), length});
+            offset += length;
+            budget -= length;
+        }
+        if (budget == 0) {
+            break;
+        }
+    }
+    return segments;
+}
+
+static void copy_segment(const segment& seg, int out, char* buffer, const std::filesystem::path& tmp, const copy_options& options) {
+    file_descriptor in(open(seg.source.c_str(), O_RDONLY | O_CLOEXEC));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    if (in.get() < 0) {
+        throw std::filesystem::filesystem_error("cannot open the file", seg.source, std::error_code(errno, std::system_category()));
+    }
+    auto offset = seg.offset;
+    auto end = seg.offset + static_cast<off_t>(seg.length);
+    while (offset < end) {
+        auto length = std::min(buffer_size, static_cast<std::size_t>(end - offset));
+        if (options.limiter != nullptr) {
+            options.limiter->acquire(length);
+        }
+        auto n = pread(in.get(), buffer, length, offset);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::filesystem::filesystem_error("cannot read the file", seg.source, std::error_code(errno, std::system_category()));
+        }
+        if (n == 0) {
+            break;  // truncated since the sample was planned
+        }
+        for (ssize_t written = 0; written < n; ) {
+            auto w = write(out, buffer + written, static_cast<std::size_t>(n - written));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::filesystem::filesystem_error("cannot write the sample", tmp, std::error_code(errno, std::system_category()));
+            }
+            written += w;
+        }
+        if (options.drop_cache) {
+            posix_fadvise(in.get(), offset, n, POSIX_FADV_DONTNEED);
+        }
+        offset += n;
+    }
+}
+
+sample_result sample_copy(const std::vector<std::filesystem::path>& sources,
+                          const std::filesystem::path& directory,
+                          std::uintmax_t budget,
+                          std::size_t parallelism,
+                          const copy_options& options) {
+    auto segments = segments_of(sources, budget);
+    if (parallelism == 0) {
+        auto paths = sources;
+        paths.emplace_back(directory);
+        parallelism = parallel_copy::default_parallelism(paths);
+    }
+    parallelism = std::max(std::min(parallelism, segments.size()), static_cast<std::size_t>(1));
+
+    std::atomic_size_t next{};
+    std::atomic<std::uintmax_t> copied{};
+    std::atomic_bool failed{};
+    std::exception_ptr error{};
+    std::mutex mtx{};
+    auto worker = [&](std::size_t id) {
+        auto tmp = directory / std::filesystem::path("tgctl-estimate-" + std::to_string(getpid()) + "-" + std::to_string(id));
+        try {
+            file_descriptor out(open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600));  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+            if (out.get() < 0) {
+                throw std::filesystem::filesystem_error("cannot create the sample", tmp, std::error_code(errno, std::system_category()));
+            }
+            std::vector<char> buffer(buffer_size);
+            while (!failed) {
+                auto i = next.fetch_add(1);
+                if (i >= segments.size()) {
+                    break;
+                }
+                copy_segment(segments.at(i), out.get(), buffer.data(), tmp, options);
+                copied += segments.at(i).length;
+            }
+            // the writeback is a part of the copy
+            fdatasync(out.get());
+            if (options.drop_cache) {
+                posix_fadvise(out.get(), 0, 0, POSIX_FADV_DONTNEED);
+            }
+        } catch (...) {
+            std::unique_lock<std::mutex> lock(mtx);
+            if (!error) {
+                error = std::current_exception();
+            }
+            failed = true;
+        }
+        std::error_code ec{};
+        std::filesystem::remove(tmp, ec);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers{};
+    for (std::size_t i = 1; i < parallelism; i++) {
+        workers.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto&& t : workers) {
+        t.join();
+    }
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return sample_result{copied.load(), seconds, parallelism};
+}
+
+}  // tateyama::datastore
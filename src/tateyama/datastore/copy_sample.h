@@ -0,0 +1,56 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "copy_engine.h"
+
+namespace tateyama::datastore {
+
+/**
+ * @brief the result of sample_copy()
+ */
+struct sample_result {
+    std::uintmax_t bytes{};
+    double seconds{};
+    std::size_t parallelism{};
+
+    [[nodiscard]] double bytes_per_second() const noexcept {
+        return seconds > 0 ? static_cast<double>(bytes) / seconds : 0.0;
+    }
+};
+
+/**
+ * @brief measures the rate of copying the files by copying a sample of them into the directory
+ * @details the sample is taken from the largest files in segments, which are copied by the threads as a backup does,
+ * each into a temporary file in the directory, which is synced to include the writeback and removed afterwards.
+ * @param sources the files from which the sample is taken
+ * @param directory the directory into which the sample is written, which is expected to be the backup destination
+ * @param budget the size of the sample in bytes, which is bounded by the total size of the files
+ * @param parallelism the number of threads, 0 means parallel_copy::default_parallelism()
+ * @param options the limiter and drop_cache are applied as in the copy
+ * @throws std::filesystem::filesystem_error if a file cannot be read or written
+ */
+sample_result sample_copy(const std::vector<std::filesystem::path>& sources,
+                          const std::filesystem::path& directory,
+                          std::uintmax_t budget,
+                          std::size_t parallelism,
+                          const copy_options& options);
+
+}  // tateyama::datastore
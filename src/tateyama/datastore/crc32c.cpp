@@ -0,0 +1,166 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+#include "crc32c.h"
+
+namespace tateyama::datastore {
+
+constexpr std::uint32_t crc32c_polynomial = 0x82F63B78U;  // reversed 0x1EDC6F41
+constexpr std::size_t crc32c_file_buffer_size = 4UL * 1024UL * 1024UL;  // large sequential reads keep the device busy
+
+static constexpr std::array<std::uint32_t, 256> make_crc32c_table() {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < 256; i++) {
+        std::uint32_t crc = i;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc & 1U) != 0 ? (crc >> 1U) ^ crc32c_polynomial : crc >> 1U;
+        }
+        table.at(i) = crc;
+    }
+    return table;
+}
+static constexpr auto crc32c_table = make_crc32c_table();
+
+static std::uint32_t crc32c_software(std::uint32_t crc, const std::uint8_t* p, std::size_t length) noexcept {
+    crc = ~crc;
+    for (std::size_t i = 0; i < length; i++) {
+        crc = crc32c_table[(crc ^ p[i]) & 0xFFU] ^ (crc >> 8U);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic, cppcoreguidelines-pro-bounds-constant-array-index)
+    }
+    return ~crc;
+}
+
+#if defined(__x86_64__)
+// the crc32 instruction of SSE4.2 computes CRC32C, 8 bytes at a time
+__attribute__((target("sse4.2")))
+static std::uint32_t crc32c_sse42(std::uint32_t crc, const std::uint8_t* p, std::size_t length) noexcept {
+    std::uint64_t c = ~crc;
+    for (; length > 0 && (reinterpret_cast<std::uintptr_t>(p) & 7U) != 0; length--) {  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        c = _mm_crc32_u8(static_cast<std::uint32_t>(c), *p++);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    for (; length >= sizeof(std::uint64_t); length -= sizeof(std::uint64_t)) {
+        std::uint64_t word{};
+        std::memcpy(&word, p, sizeof(word));
+        c = _mm_crc32_u64(c, word);
+        p += sizeof(std::uint64_t);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    for (; length > 0; length--) {
+        c = _mm_crc32_u8(static_cast<std::uint32_t>(c), *p++);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    return ~static_cast<std::uint32_t>(c);
+}
+#endif
+
+using crc32c_function = std::uint32_t (*)(std::uint32_t, const std::uint8_t*, std::size_t) noexcept;
+
+static crc32c_function select_crc32c() noexcept {
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("sse4.2")) {
+        return crc32c_sse42;
+    }
+#endif
+    return crc32c_software;
+}
+
+std::uint32_t crc32c(std::uint32_t crc, const void* data, std::size_t length) noexcept {
+    static const crc32c_function function = select_crc32c();
+    return function(crc, static_cast<const std::uint8_t*>(data), length);
+}
+
+bool crc32c_hardware_accelerated() noexcept {
+    return select_crc32c() != crc32c_software;
+}
+
+// multiplies a and b, the polynomials in the reflected bit order, modulo the polynomial of CRC32C
+static constexpr std::uint32_t multiply_modulo(std::uint32_t a, std::uint32_t b) noexcept {
+    std::uint32_t product = 0;
+    for (std::uint32_t m = 1U << 31U; m != 0; m >>= 1U) {
+        if ((a & m) != 0) {
+            product ^= b;
+        }
+        b = (b & 1U) != 0 ? (b >> 1U) ^ crc32c_polynomial : b >> 1U;
+    }
+    return product;
+}
+
+// x^(2^k) modulo the polynomial of CRC32C, for k up to the bits of a length in bytes, plus 3 for the bits in a byte
+static constexpr std::array<std::uint32_t, std::numeric_limits<std::uintmax_t>::digits + 3> make_power_table() {
+    std::array<std::uint32_t, std::numeric_limits<std::uintmax_t>::digits + 3> table{};
+    table.at(0) = 1U << 30U;  // x^1
+    for (std::size_t k = 1; k < table.size(); k++) {
+        table.at(k) = multiply_modulo(table.at(k - 1), table.at(k - 1));
+    }
+    return table;
+}
+static constexpr auto crc32c_power_table = make_power_table();
+
+// feeding a zero byte multiplies the crc register by x^8, thus n zero bytes multiply it by x^(8n),
+// which is computed by squaring in O(log n) instead of running the zeros through crc32c()
+std::uint32_t crc32c_zeros(std::uint32_t crc, std::uintmax_t length) noexcept {
+    std::uint32_t power = 1U << 31U;  // x^0
+    for (std::size_t k = 3; length > 0; length >>= 1U, k++) {  // starting from x^(2^3), i.e. x^8
+        if ((length & 1U) != 0) {
+            power = multiply_modulo(crc32c_power_table.at(k), power);
+        }
+    }
+    return ~multiply_modulo(power, ~crc);
+}
+
+std::uint32_t crc32c_file(const std::filesystem::path& file) {
+    int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+    if (fd < 0) {
+        throw std::filesystem::filesystem_error("cannot open the file", file, std::error_code(errno, std::system_category()));
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    std::vector<char> buffer(crc32c_file_buffer_size);
+    std::uint32_t crc = 0;
+    while (true) {
+        auto n = read(fd, buffer.data(), buffer.size());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            auto err = errno;
+            close(fd);
+            throw std::filesystem::filesystem_error("cannot read the file", file, std::error_code(err, std::system_category()));
+        }
+        if (n == 0) {
+            break;
+        }
+        crc = crc32c(crc, buffer.data(), static_cast<std::size_t>(n));
+    }
+    close(fd);
+    return crc;
+}
+
+std::string checksum_string(std::uint32_t crc) {
+    std::array<char, 16> buffer{};
+    std::snprintf(buffer.data(), buffer.size(), "crc32c:%08x", crc);  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    return {buffer.data()};
+}
+
+}  // tateyama::datastore
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace tateyama::datastore {
+
+/**
+ * @brief updates CRC32C (Castagnoli) with the data
+ * @details uses the crc32 instruction of SSE4.2 if the cpu supports it, a table lookup otherwise.
+ * @param crc the CRC32C of the preceding data, 0 for the first call
+ * @param data the data
+ * @param length the length of the data
+ * @return the CRC32C of the preceding data followed by the data
+ */
+std::uint32_t crc32c(std::uint32_t crc, const void* data, std::size_t length) noexcept;
+
+/**
+ * @brief updates CRC32C with the zeros of the length, which are the contents of a hole in a sparse file
+ * @details computed in O(log length) without running the zeros through crc32c().
+ */
+std::uint32_t crc32c_zeros(std::uint32_t crc, std::uintmax_t length) noexcept;
+
+/**
+ * @brief returns whether crc32c() uses the crc32 instruction of the cpu
+ */
+bool crc32c_hardware_accelerated() noexcept;
+
+/**
+ * @brief returns CRC32C of the file contents
+ * @throws std::filesystem::filesystem_error if the file cannot be read
+ */
+std::uint32_t crc32c_file(const std::filesystem::path& file);
+
+/**
+ * @brief returns the representation of the checksum used in the manifest, such as "crc32c:1a2b3c4d"
+ */
+std::string checksum_string(std::uint32_t crc);
+
+}  // tateyama::datastore
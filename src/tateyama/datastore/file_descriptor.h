@@ -0,0 +1,46 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <unistd.h>
+
+namespace tateyama::datastore {
+
+/**
+ * @brief closes the file descriptor on destruction
+ */
+class file_descriptor {
+public:
+    explicit file_descriptor(int fd) noexcept : fd_(fd) {
+    }
+    ~file_descriptor() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+    file_descriptor(file_descriptor const& other) = delete;
+    file_descriptor& operator=(file_descriptor const& other) = delete;
+    file_descriptor(file_descriptor&& other) noexcept = delete;
+    file_descriptor& operator=(file_descriptor&& other) noexcept = delete;
+
+    [[nodiscard]] int get() const noexcept {
+        return fd_;
+    }
+private:
+    int fd_;
+};
+
+}  // tateyama::datastore
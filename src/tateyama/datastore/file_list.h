@@ -18,16 +18,32 @@
 #include <string>
 #include <functional>
 #include <exception>
+#include <iostream>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
-#include <boost/foreach.hpp>
-#include <boost/optional.hpp>
+#include <nlohmann/json.hpp>
+
+#include "file_descriptor.h"
 
 namespace tateyama::datastore {
 
+/**
+ * @brief the file list given by restore backup --use-file-list
+ * @details the file is parsed in a streaming manner, so that the memory used does not depend on the number of entries
+ * beyond what the caller keeps from the callback.
+ */
 class file_list {
 public:
+    /**
+     * @brief the function receiving each entry, whose strings can be moved from
+     */
+    using entry_callback = std::function<void(std::string&& source, std::string&& destination, bool detached)>;
+
     file_list() = default;
     ~file_list() = default;
 
@@ -36,32 +52,230 @@ public:
     file_list(file_list&& other) noexcept = default;
     file_list& operator=(file_list&& other) noexcept = default;
 
-    bool read_json(const std::string& file_name) {
+    /**
+     * @brief parses the file list, passing the entries to the callback in the order they appear
+     * @param file_name the file name of the file list
+     * @param callback the function receiving each entry
+     * @return true if the file list has been parsed successfully
+     * @note the entries lacking any of source_path, destination_path or detached are skipped as before
+     */
+    bool parse(const std::string& file_name, const entry_callback& callback) {
+        entries_parsed_ = 0;
+        entries_skipped_ = 0;
+        bytes_parsed_ = 0;
+
+        file_descriptor fd(::open(file_name.c_str(), O_RDONLY | O_CLOEXEC));  // NOLINT
+        if (fd.get() < 0) {
+            std::cerr << "could not open " << file_name << ", as " << std::strerror(errno) << '\n' << std::flush;
+            return false;
+        }
+        struct stat st{};
+        if (::fstat(fd.get(), &st) != 0) {
+            std::cerr << "could not stat " << file_name << ", as " << std::strerror(errno) << '\n' << std::flush;
+            return false;
+        }
+        auto size = static_cast<std::size_t>(st.st_size);
+        if (size == 0) {
+            std::cerr << "could not parse " << file_name << ", as it is empty\n" << std::flush;
+            return false;
+        }
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+        if (addr == MAP_FAILED) {  // NOLINT(performance-no-int-to-ptr)
+            std::cerr << "could not map " << file_name << ", as " << std::strerror(errno) << '\n' << std::flush;
+            return false;
+        }
+        ::madvise(addr, size, MADV_SEQUENTIAL);
+
+        handler h{callback};
+        bool parsed{};
         try {
-            boost::property_tree::read_json(file_name, pt_);
-            return true;
+            const auto* begin = static_cast<const char*>(addr);
+            parsed = nlohmann::json::sax_parse(begin, begin + size, &h);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
         } catch (std::exception const& e) {
-            std::cerr << e.what() << '\n' << std::flush;
+            h.error_ = e.what();
+        }
+        ::munmap(addr, size);
+
+        entries_parsed_ = h.parsed_;
+        entries_skipped_ = h.skipped_;
+        bytes_parsed_ = size;
+        if (!parsed || !h.error_.empty()) {
+            std::cerr << "could not parse " << file_name << ", as " << (h.error_.empty() ? "it is not a valid json" : h.error_) << '\n' << std::flush;
             return false;
         }
+        if (!h.found_) {
+            std::cerr << "could not parse " << file_name << ", as it has no entries array\n" << std::flush;
+            return false;
+        }
+        return true;
     }
 
-    void for_each(const std::function<void(const std::string&, const std::string&, bool)>& func) {
-        BOOST_FOREACH (const boost::property_tree::ptree::value_type& child, pt_.get_child("entries")) {
-            const boost::property_tree::ptree& info = child.second;
-
-            boost::optional<std::string> source = info.get_optional<std::string>("source_path");
-            boost::optional<std::string> destination = info.get_optional<std::string>("destination_path");
-            boost::optional<bool> detached = info.get_optional<bool>("detached");
+    /**
+     * @brief reads the file list, keeping the entries for for_each()
+     * @param file_name the file name of the file list
+     * @return true if the file list has been read successfully
+     */
+    bool read_json(const std::string& file_name) {
+        entries_.clear();
+        return parse(file_name, [this](std::string&& source, std::string&& destination, bool detached) {
+            entries_.emplace_back(entry{std::move(source), std::move(destination), detached});
+        });
+    }
 
-            if (source && destination && detached) {
-                func(source.get(), destination.get(), detached.get());
-            }
+    void for_each(const std::function<void(const std::string&, const std::string&, bool)>& func) const {
+        for (auto&& e : entries_) {
+            func(e.source, e.destination, e.detached);
         }
     }
 
+    [[nodiscard]] std::size_t entries_parsed() const noexcept {
+        return entries_parsed_;
+    }
+    [[nodiscard]] std::size_t entries_skipped() const noexcept {
+        return entries_skipped_;
+    }
+    [[nodiscard]] std::size_t bytes_parsed() const noexcept {
+        return bytes_parsed_;
+    }
+
 private:
-    boost::property_tree::ptree pt_;
+    struct entry {
+        std::string source;
+        std::string destination;
+        bool detached;
+    };
+
+    // receives the events from nlohmann::json::sax_parse, picking up {"entries": [{...}, ...]} at the top level
+    // and ignoring the other members; the member functions are looked up by name, so this does not inherit json_sax.
+    class handler {
+    public:
+        explicit handler(const entry_callback& callback) : callback_(callback) {
+        }
+
+        bool null() {
+            return true;
+        }
+        bool boolean(bool value) {
+            if (in_field()) {
+                if (key_ == "detached") {
+                    detached_ = value;
+                    has_detached_ = true;
+                }
+            }
+            return true;
+        }
+        bool number_integer(nlohmann::json::number_integer_t) {
+            return true;
+        }
+        bool number_unsigned(nlohmann::json::number_unsigned_t) {
+            return true;
+        }
+        bool number_float(nlohmann::json::number_float_t, const nlohmann::json::string_t&) {
+            return true;
+        }
+        bool string(nlohmann::json::string_t& value) {
+            if (in_field()) {
+                if (key_ == "source_path") {
+                    source_ = std::move(value);
+                    has_source_ = true;
+                } else if (key_ == "destination_path") {
+                    destination_ = std::move(value);
+                    has_destination_ = true;
+                } else if (key_ == "detached" && (value == "true" || value == "false")) {
+                    // property_tree, which was used before, accepted the booleans written as strings
+                    detached_ = value == "true";
+                    has_detached_ = true;
+                }
+            }
+            return true;
+        }
+        template <class T>
+        bool binary(T&) {  // since nlohmann json 3.8.0
+            return true;
+        }
+        bool start_object(std::size_t) {
+            if (entries_depth_ > 0 && depth_ == entries_depth_) {
+                in_entry_ = true;
+                has_source_ = has_destination_ = has_detached_ = false;
+                source_.clear();
+                destination_.clear();
+            }
+            depth_++;
+            return true;
+        }
+        bool end_object() {
+            depth_--;
+            if (in_entry_ && depth_ == entries_depth_) {
+                in_entry_ = false;
+                if (has_source_ && has_destination_ && has_detached_) {
+                    callback_(std::move(source_), std::move(destination_), detached_);
+                    parsed_++;
+                } else {
+                    skipped_++;
+                }
+            }
+            return true;
+        }
+        bool start_array(std::size_t) {
+            if (depth_ == 1 && entries_key_ && !found_) {
+                entries_depth_ = depth_ + 1;
+                found_ = true;
+            }
+            depth_++;
+            return true;
+        }
+        bool end_array() {
+            depth_--;
+            if (depth_ + 1 == entries_depth_) {
+                entries_depth_ = 0;
+            }
+            return true;
+        }
+        bool key(nlohmann::json::string_t& value) {
+            if (depth_ == 1) {
+                entries_key_ = value == "entries";
+            }
+            if (in_entry_ && depth_ == entries_depth_ + 1) {
+                key_ = std::move(value);
+            }
+            return true;
+        }
+        template <class Exception>
+        bool parse_error(std::size_t, const std::string&, const Exception& ex) {
+            error_ = ex.what();
+            return false;
+        }
+
+    private:
+        const entry_callback& callback_;
+        std::size_t depth_{};
+        std::size_t entries_depth_{};  // the depth of the members of the entries array, 0 when outside of it
+        bool entries_key_{};
+        bool in_entry_{};
+        std::string key_{};
+        std::string source_{};
+        std::string destination_{};
+        bool detached_{};
+        bool has_source_{};
+        bool has_destination_{};
+        bool has_detached_{};
+
+        std::size_t parsed_{};
+        std::size_t skipped_{};
+        bool found_{};
+        std::string error_{};
+
+        [[nodiscard]] bool in_field() const noexcept {
+            return in_entry_ && depth_ == entries_depth_ + 1;
+        }
+
+        friend class file_list;
+    };
+
+    std::vector<entry> entries_{};
+    std::size_t entries_parsed_{};
+    std::size_t entries_skipped_{};
+    std::size_t bytes_parsed_{};
 };
 
-} // namespace tateyama::bootstrap::utils
+} // namespace tateyama::datastore
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tateyama::datastore {
+
+/**
+ * @brief limits the rate of I/O with a token bucket shared by the threads
+ */
+class rate_limiter {
+public:
+    /**
+     * @brief create a rate_limiter
+     * @param bytes_per_second the rate, must be greater than 0
+     * @param burst the bytes that can be consumed at once after idling, one tenth of the rate if 0
+     */
+    explicit rate_limiter(std::uint64_t bytes_per_second, std::uint64_t burst = 0)
+        : rate_(static_cast<double>(bytes_per_second)),
+          burst_(burst > 0 ? static_cast<double>(burst) : std::max(rate_ / 10.0, static_cast<double>(minimum_burst))),
+          tokens_(burst_) {
+    }
+
+    /**
+     * @brief waits until the bytes can be consumed
+     * @details the tokens may go negative, so that a request larger than the burst waits for its share
+     * and the later requests wait for the debt to be paid off.
+     */
+    void acquire(std::uint64_t bytes) {
+        std::chrono::duration<double> wait{};
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            auto now = std::chrono::steady_clock::now();
+            tokens_ = std::min(burst_, tokens_ + std::chrono::duration<double>(now - last_).count() * rate_);
+            last_ = now;
+            tokens_ -= static_cast<double>(bytes);
+            if (tokens_ < 0) {
+                wait = std::chrono::duration<double>(-tokens_ / rate_);
+            }
+        }
+        if (wait.count() > 0) {
+            std::this_thread::sleep_for(wait);
+        }
+    }
+
+    [[nodiscard]] std::uint64_t bytes_per_second() const noexcept {
+        return static_cast<std::uint64_t>(rate_);
+    }
+
+private:
+    static constexpr std::uint64_t minimum_burst = 1024UL * 1024UL;
+
+    double rate_;
+    double burst_;
+    double tokens_;
+    std::chrono::steady_clock::time_point last_{std::chrono::steady_clock::now()};
+    std::mutex mtx_{};
+};
+
+/**
+ * @brief returns the I/O scheduling class used by ioprio_set(2)
+ * @param name idle or best-effort
+ * @return the class, or std::nullopt if the name is unknown
+ */
+inline std::optional<int> io_class_of(std::string_view name) {
+    constexpr int ioprio_class_be = 2;
+    constexpr int ioprio_class_idle = 3;
+    if (name == "idle") {
+        return ioprio_class_idle;
+    }
+    if (name == "best-effort") {
+        return ioprio_class_be;
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief sets the I/O scheduling class of the calling thread, which is inherited by the threads created afterwards
+ * @details takes effect with the I/O schedulers supporting priorities, such as BFQ.
+ * @param io_class the class returned by io_class_of()
+ * @return true if the class has been set successfully
+ */
+inline bool set_io_class(int io_class) {
+    constexpr int ioprio_who_process = 1;
+    constexpr int ioprio_class_shift = 13;
+    constexpr int ioprio_be_lowest = 7;  // the level within the best-effort class, ignored by the idle class
+    return syscall(SYS_ioprio_set, ioprio_who_process, 0, (io_class << ioprio_class_shift) | ioprio_be_lowest) == 0;  // NOLINT(hicpp-signed-bitwise)
+}
+
+}  // tateyama::datastore
@@ -0,0 +1,251 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <sys/stat.h>
+
+#include <nlohmann/json.hpp>
+
+#include "backup_journal.h"
+#include "crc32c.h"
+#include "parallel_copy.h"
+#include "manifest.h"
+
+namespace tateyama::datastore {
+
+// the values were all written as strings by the earlier versions, which used boost::property_tree
+template <typename T>
+static T value_of(const nlohmann::json& j, std::string_view key) {
+    const auto& v = j.at(std::string(key));
+    if (!v.is_string()) {
+        return v.get<T>();
+    }
+    const auto& str = v.get_ref<const std::string&>();
+    if constexpr (std::is_same_v<T, bool>) {
+        return str == "true";
+    } else if constexpr (std::is_signed_v<T>) {
+        return static_cast<T>(std::stoll(str));
+    } else {
+        return static_cast<T>(std::stoull(str));
+    }
+}
+
+template <typename T>
+static T value_of(const nlohmann::json& j, std::string_view key, T default_value) {
+    if (!j.contains(std::string(key))) {
+        return default_value;
+    }
+    return value_of<T>(j, key);
+}
+
+bool manifest::read(const std::filesystem::path& directory) {
+    auto file = directory / std::filesystem::path(file_name);
+    std::ifstream strm(file);
+    if (!strm) {
+        std::cerr << file.string() << ": cannot open file\n" << std::flush;
+        return false;
+    }
+    auto j = nlohmann::json::parse(strm, nullptr, false);
+    if (j.is_discarded() || !j.is_object()) {
+        std::cerr << file.string() << ": broken\n" << std::flush;
+        return false;
+    }
+    try {
+        if (value_of<int>(j, "version") > format_version) {
+            std::cerr << "unsupported version of " << file_name << " in " << directory.string() << '\n' << std::flush;
+            return false;
+        }
+        incremental_from_ = j.value("incremental_from", "");
+        compression_ = j.value("compression", "");
+        detail_.reset();
+        if (j.contains("detail")) {
+            const auto& d = j.at("detail");
+            log_range range{};
+            range.backup_type = d.value("type", "");
+            range.log_begin = value_of<std::uint64_t>(d, "log_begin");
+            range.log_end = value_of<std::uint64_t>(d, "log_end");
+            if (d.contains("image_finish")) {
+                range.image_finish = value_of<std::uint64_t>(d, "image_finish");
+            }
+            detail_ = std::move(range);
+        }
+        entries_.clear();
+        for (auto&& f : j.at("files")) {
+            manifest_entry entry{};
+            entry.size = value_of<std::uintmax_t>(f, "size");
+            entry.mtime = value_of<std::int64_t>(f, "mtime");
+            entry.checksum = f.value("checksum", "");
+            entry.source_size = value_of<std::uintmax_t>(f, "source_size", entry.size);  // not recorded by the first version
+            entry.is_mutable = value_of<bool>(f, "mutable", false);
+            entry.detached = value_of<bool>(f, "detached", false);
+            entries_.insert_or_assign(f.at("path").get<std::string>(), std::move(entry));
+        }
+        return true;
+    } catch (std::exception const& e) {
+        std::cerr << file.string() << ": " << e.what() << '\n' << std::flush;
+        return false;
+    }
+}
+
+void manifest::write(std::ostream& strm) const {
+    nlohmann::json j{};
+    j["version"] = format_version;
+    j["created_at"] = time(nullptr);
+    if (!incremental_from_.empty()) {
+        j["incremental_from"] = incremental_from_;
+    }
+    if (!compression_.empty()) {
+        j["compression"] = compression_;
+    }
+    if (detail_) {
+        j["detail"]["type"] = detail_->backup_type;
+        j["detail"]["log_begin"] = detail_->log_begin;
+        j["detail"]["log_end"] = detail_->log_end;
+        if (detail_->image_finish) {
+            j["detail"]["image_finish"] = detail_->image_finish.value();
+        }
+    }
+    j["files"] = nlohmann::json::array();
+    for (auto&& [name, entry] : entries_) {
+        nlohmann::json f{};
+        f["path"] = name;
+        f["size"] = entry.size;
+        f["mtime"] = entry.mtime;
+        f["source_size"] = entry.source_size;
+        if (!entry.checksum.empty()) {
+            f["checksum"] = entry.checksum;
+        }
+        if (entry.is_mutable) {
+            f["mutable"] = true;
+        }
+        if (entry.detached) {
+            f["detached"] = true;
+        }
+        j["files"].push_back(std::move(f));
+    }
+    strm << j.dump(4) << '\n';
+    if (!strm) {
+        throw std::runtime_error("cannot write the manifest");
+    }
+}
+
+void manifest::write(const std::filesystem::path& directory) const {
+    // written to a temporary file and renamed, so that an incomplete manifest is never read
+    auto file = directory / std::filesystem::path(file_name);
+    auto tmp = file;
+    tmp += ".tmp";
+    {
+        std::ofstream strm(tmp);
+        write(strm);
+        strm.close();
+        if (!strm) {
+            throw std::filesystem::filesystem_error("cannot write the manifest", tmp, std::error_code(EIO, std::system_category()));
+        }
+    }
+    std::filesystem::rename(tmp, file);
+}
+
+std::int64_t manifest::mtime_of(const std::filesystem::path& file) {
+    struct stat st{};
+    if (stat(file.c_str(), &st) != 0) {
+        throw std::filesystem::filesystem_error("cannot stat the file", file, std::error_code(errno, std::system_category()));
+    }
+    return static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000L + st.st_mtim.tv_nsec;
+}
+
+bool manifest::is_metadata(const std::filesystem::path& name) {
+    return name == std::filesystem::path(file_name) || name == std::filesystem::path(backup_journal::file_name);
+}
+
+std::vector<verify_failure> verify_backup(const std::filesystem::path& directory,
+                                          const manifest& mf,
+                                          std::size_t parallelism,
+                                          const std::function<void(std::uintmax_t completed_bytes, std::uintmax_t total_bytes)>& progress) {
+    std::vector<std::pair<const std::string*, const manifest_entry*>> targets{};
+    std::uintmax_t total_bytes = 0;
+    for (auto&& [name, entry] : mf.entries()) {
+        targets.emplace_back(&name, &entry);
+        total_bytes += entry.size;
+    }
+    // largest first, as parallel_copy does
+    std::stable_sort(targets.begin(), targets.end(), [](const auto& a, const auto& b) { return a.second->size > b.second->size; });
+    if (parallelism == 0) {
+        parallelism = parallel_copy::default_parallelism({directory});
+    }
+    parallelism = std::max(std::min(parallelism, targets.size()), static_cast<std::size_t>(1));
+
+    std::vector<verify_failure> failures{};
+    std::atomic_size_t next{};
+    std::uintmax_t completed_bytes = 0;
+    std::mutex mtx{};
+    auto worker = [&]() {
+        while (true) {
+            auto index = next.fetch_add(1);
+            if (index >= targets.size()) {
+                return;
+            }
+            const auto& name = *targets.at(index).first;
+            const auto& entry = *targets.at(index).second;
+            auto file = directory / std::filesystem::path(name);
+            std::string message{};
+            std::error_code ec{};
+            if (auto size = std::filesystem::file_size(file, ec); ec) {
+                message = "cannot access the file: " + ec.message();
+            } else if (size != entry.size) {
+                message = "size mismatch, expected " + std::to_string(entry.size) + " but " + std::to_string(size);
+            } else if (!entry.checksum.empty()) {
+                try {
+                    if (auto checksum = checksum_string(crc32c_file(file)); checksum != entry.checksum) {
+                        message = "checksum mismatch, expected " + entry.checksum + " but " + checksum;
+                    }
+                } catch (std::filesystem::filesystem_error &e) {
+                    message = e.what();
+                }
+            }
+            std::unique_lock<std::mutex> lock(mtx);
+            if (!message.empty()) {
+                failures.emplace_back(verify_failure{name, message});
+            }
+            completed_bytes += entry.size;
+            if (progress) {
+                progress(completed_bytes, total_bytes);
+            }
+        }
+    };
+    std::vector<std::thread> threads{};
+    threads.reserve(parallelism - 1);
+    for (std::size_t i = 1; i < parallelism; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto&& t : threads) {
+        t.join();
+    }
+    std::sort(failures.begin(), failures.end(), [](const verify_failure& a, const verify_failure& b) { return a.name < b.name; });
+    return failures;
+}
+
+}  // tateyama::datastore
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tateyama::datastore {
+
+/**
+ * @brief a file recorded in the manifest
+ */
+struct manifest_entry {
+    std::uintmax_t size{};
+    std::int64_t mtime{};      // modification time of the source file in nanoseconds since the epoch
+    std::string checksum{};    // e.g. "crc32c:1a2b3c4d"
+    std::uintmax_t source_size{};  // differs from size if the file is compressed
+    bool is_mutable{};         // the file may have been modified during the backup, given by BackupDetailBegin
+    bool detached{};           // the file is detached from the datastore, given by BackupDetailBegin
+};
+
+/**
+ * @brief the range of the log covered by a backup created by BackupDetailBegin
+ */
+struct log_range {
+    std::string backup_type{};  // "standard" or "transaction"
+    std::uint64_t log_begin{};
+    std::uint64_t log_end{};
+    std::optional<std::uint64_t> image_finish{};
+};
+
+/**
+ * @brief the manifest written into each backup directory by tgctl backup create
+ * @details records the files in the backup with their size, the size and mtime of their source and checksum,
+ * which are used to find the unchanged files for an incremental backup. The names, sizes and checksums are
+ * those of the files in the backup directory, which are compressed if the compression is recorded.
+ */
+class manifest {
+public:
+    static constexpr std::string_view file_name = "tgctl-backup-manifest.json";
+    static constexpr int format_version = 1;
+
+    /**
+     * @brief reads the manifest in the backup directory
+     * @return true if the manifest has been read successfully
+     */
+    bool read(const std::filesystem::path& directory);
+
+    /**
+     * @brief writes the manifest into the backup directory
+     * @throws std::exception if the manifest cannot be written
+     */
+    void write(const std::filesystem::path& directory) const;
+
+    /**
+     * @brief writes the manifest into the stream in JSON
+     * @throws std::exception if the manifest cannot be written
+     */
+    void write(std::ostream& strm) const;
+
+    void add(const std::string& name, manifest_entry entry) {
+        entries_.insert_or_assign(name, std::move(entry));
+    }
+
+    /**
+     * @brief returns the entry of the file, or nullptr if the file is not in the manifest
+     */
+    [[nodiscard]] const manifest_entry* find(const std::string& name) const {
+        if (auto it = entries_.find(name); it != entries_.end()) {
+            return &it->second;
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] const std::map<std::string, manifest_entry>& entries() const noexcept {
+        return entries_;
+    }
+
+    void incremental_from(std::string path) {
+        incremental_from_ = std::move(path);
+    }
+
+    [[nodiscard]] const std::string& incremental_from() const noexcept {
+        return incremental_from_;
+    }
+
+    void compression(std::string spec) {
+        compression_ = std::move(spec);
+    }
+
+    /**
+     * @brief returns the compression such as "zstd:3", or an empty string if the files are not compressed
+     */
+    [[nodiscard]] const std::string& compression() const noexcept {
+        return compression_;
+    }
+
+    void detail(log_range range) {
+        detail_ = std::move(range);
+    }
+
+    /**
+     * @brief returns the log range, or std::nullopt if the backup is not created by BackupDetailBegin
+     */
+    [[nodiscard]] const std::optional<log_range>& detail() const noexcept {
+        return detail_;
+    }
+
+    /**
+     * @brief returns the modification time of the file in nanoseconds since the epoch
+     * @throws std::filesystem::filesystem_error if the file cannot be accessed
+     */
+    static std::int64_t mtime_of(const std::filesystem::path& file);
+
+    /**
+     * @brief tells whether the file is written into a backup directory by tgctl, such as the manifest and the journal of backup create
+     * @details such files are neither backed up nor restored into the datastore
+     * @param name the name of the file relative to the backup directory
+     */
+    static bool is_metadata(const std::filesystem::path& name);
+
+private:
+    std::map<std::string, manifest_entry> entries_{};
+    std::string incremental_from_{};
+    std::string compression_{};
+    std::optional<log_range> detail_{};
+};
+
+/**
+ * @brief a problem found by verify_backup()
+ */
+struct verify_failure {
+    std::string name;
+    std::string message;
+};
+
+/**
+ * @brief re-hashes the files in the backup directory and compares them with the manifest
+ * @param directory the backup directory
+ * @param mf the manifest of the backup
+ * @param parallelism the number of threads reading files, 0 means parallel_copy::default_parallelism()
+ * @param progress called each time a file has been verified with the bytes verified so far and in total, one thread at a time
+ * @return the problems found, in the order of the file name
+ */
+std::vector<verify_failure> verify_backup(const std::filesystem::path& directory,
+                                          const manifest& mf,
+                                          std::size_t parallelism,
+                                          const std::function<void(std::uintmax_t completed_bytes, std::uintmax_t total_bytes)>& progress);
+
+}  // tateyama::datastore
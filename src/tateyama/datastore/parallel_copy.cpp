@@ -0,0 +1,141 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <set>
+#include <thread>
+#include <sys/stat.h>
+
+#include "parallel_copy.h"
+#include "progress_meter.h"
+
+namespace tateyama::datastore {
+
+// the number of concurrent copies that keeps a single NVMe device busy
+constexpr std::size_t copies_per_device = 4;
+
+parallel_copy::parallel_copy(std::size_t parallelism) : parallelism_(parallelism) {
+}
+
+void parallel_copy::add(const std::filesystem::path& src, const std::filesystem::path& dst) {
+    auto size = decompress_ ? original_size_of(src) : std::filesystem::file_size(src);
+    entries_.emplace_back(entry{src, dst, size});
+    total_bytes_ += size;
+}
+
+void parallel_copy::add(const std::filesystem::path& src, const std::filesystem::path& dst, const std::filesystem::path& previous) {
+    auto size = std::filesystem::file_size(src);
+    entries_.emplace_back(entry{src, dst, size, previous});
+    total_bytes_ += size;
+}
+
+std::size_t parallel_copy::parallelism() const noexcept {
+    return std::max(std::min(parallelism_, entries_.size()), static_cast<std::size_t>(1));
+}
+
+std::size_t parallel_copy::default_parallelism(const std::vector<std::filesystem::path>& paths) {
+    std::set<dev_t> devices{};
+    for (auto&& path : paths) {
+        struct stat st{};
+        if (stat(path.c_str(), &st) == 0) {
+            devices.emplace(st.st_dev);
+        }
+    }
+    std::size_t cores = std::max(std::thread::hardware_concurrency(), 1U);
+    return std::max(std::min(cores, std::max(devices.size(), static_cast<std::size_t>(1)) * copies_per_device), static_cast<std::size_t>(1));
+}
+
+void parallel_copy::run(const progress_callback& callback) {
+    if (parallelism_ == 0) {
+        std::vector<std::filesystem::path> paths{};
+        for (auto&& e : entries_) {
+            paths.emplace_back(e.src);
+            paths.emplace_back(e.dst.parent_path());
+        }
+        parallelism_ = default_parallelism(paths);
+    }
+    // largest first, so that a large file started last does not prolong the whole copy
+    std::stable_sort(entries_.begin(), entries_.end(), [](const entry& a, const entry& b) { return a.size > b.size; });
+    next_ = 0;
+    failed_ = false;
+    options_.cancel = &failed_;  // the copies in progress stop on the first error
+    completed_bytes_ = 0;
+    error_ = nullptr;
+
+    // the compression and decompression of the files in parallel share the cores
+    std::size_t cores = std::max(std::thread::hardware_concurrency(), 1U);
+    block_threads_ = std::max(cores / parallelism(), static_cast<std::size_t>(1));
+
+    std::vector<std::thread> workers{};
+    auto n = parallelism();
+    workers.reserve(n - 1);
+    for (std::size_t i = 1; i < n; i++) {
+        workers.emplace_back([this, &callback]{ worker(callback); });
+    }
+    worker(callback);  // the calling thread also works as one of the workers
+    for (auto&& t : workers) {
+        t.join();
+    }
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+}
+
+void parallel_copy::worker(const progress_callback& callback) {
+    while (!failed_) {
+        auto index = next_.fetch_add(1);
+        if (index >= entries_.size()) {
+            return;
+        }
+        auto& e = entries_.at(index);
+        try {
+            auto* meter = options_.meter;
+            // the destination identifies the file, as the files in different directories may have the same name
+            progress_meter::file_scope scope(meter, e.dst.string());
+            std::optional<copy_result> cloned{};
+            if (!e.previous.empty()) {
+                cloned = clone_file(e.previous, e.dst);
+            }
+            copy_result result{};
+            if (cloned) {
+                result = cloned.value();
+                if (meter != nullptr) {
+                    meter->skip(e.size);
+                }
+            } else if (compression_.codec != compression_codec::none) {
+                result = compress_file(e.src, e.dst, compression_, block_threads_, options_);
+            } else if (decompress_) {
+                result = decompress_file(e.src, e.dst, block_threads_);
+            } else {
+                result = fast_copy_file(e.src, e.dst, options_);
+            }
+            scope.complete();
+            std::unique_lock<std::mutex> lock(mtx_);
+            completed_bytes_ += e.size;
+            if (callback && !failed_) {
+                callback(e.src, result, completed_bytes_, total_bytes_);
+            }
+        } catch (...) {
+            std::unique_lock<std::mutex> lock(mtx_);
+            if (!failed_) {
+                error_ = std::current_exception();
+                failed_ = true;
+            }
+            return;
+        }
+    }
+}
+
+}  // tateyama::datastore
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "compression.h"
+#include "copy_engine.h"
+
+namespace tateyama::datastore {
+
+/**
+ * @brief copies files on a pool of worker threads, largest files first
+ */
+class parallel_copy {
+public:
+    /**
+     * @brief the callback called each time a file has been copied
+     * @param src the file copied
+     * @param result how the file has been copied or cloned
+     * @param completed_bytes the total size of the files copied so far
+     * @param total_bytes the total size of the files to be copied
+     * @note the callback is called by one worker at a time
+     */
+    using progress_callback = std::function<void(const std::filesystem::path& src, copy_result result, std::uintmax_t completed_bytes, std::uintmax_t total_bytes)>;
+
+    /**
+     * @brief create a parallel_copy
+     * @param parallelism the number of worker threads, 0 means default_parallelism()
+     */
+    explicit parallel_copy(std::size_t parallelism);
+
+    /**
+     * @brief add a file to be copied
+     * @param src the source file
+     * @param dst the destination file, which must not exist
+     */
+    void add(const std::filesystem::path& src, const std::filesystem::path& dst);
+
+    /**
+     * @brief add a file which is unchanged since the previous generation of the backup
+     * @details the file in the previous generation is cloned by clone_file(), and src is copied only if it cannot be cloned.
+     * @param src the source file
+     * @param dst the destination file, which must not exist
+     * @param previous the file in the previous generation
+     */
+    void add(const std::filesystem::path& src, const std::filesystem::path& dst, const std::filesystem::path& previous);
+
+    /**
+     * @brief sets whether the crc32c checksum of each file copied is computed, which is not done for the files cloned
+     */
+    void compute_checksum(bool enabled) noexcept {
+        options_.compute_checksum = enabled;
+    }
+
+    /**
+     * @brief limits the total rate of reading the source files by all the workers
+     * @param limiter the rate limiter, which must outlive run(), or nullptr for no limit
+     */
+    void throttle(rate_limiter* limiter) noexcept {
+        options_.limiter = limiter;
+    }
+
+    /**
+     * @brief counts the bytes copied by all the workers as they are copied
+     * @param meter the progress meter, which must outlive run(), or nullptr not to count
+     */
+    void measure(progress_meter* meter) noexcept {
+        options_.meter = meter;
+    }
+
+    /**
+     * @brief sets whether the pages of the files are dropped from the page cache as they are copied,
+     * not to evict the pages used by the database
+     */
+    void drop_cache(bool enabled) noexcept {
+        options_.drop_cache = enabled;
+    }
+
+    /**
+     * @brief sets whether the files are copied with O_DIRECT, bypassing the page cache
+     */
+    void direct_io(bool enabled) noexcept {
+        options_.direct_io = enabled;
+    }
+
+    /**
+     * @brief makes the files compressed by compress_file() instead of being copied
+     * @details the cores are shared among the workers, each of which compresses the blocks of its file on multiple threads.
+     */
+    void compress(compression comp) noexcept {
+        compression_ = comp;
+    }
+
+    /**
+     * @brief makes the files decompressed by decompress_file() instead of being copied
+     * @note must be called before add(), as the size of a file added is the size before compression
+     */
+    void decompress(bool enabled) noexcept {
+        decompress_ = enabled;
+    }
+
+    /**
+     * @brief copies all the files added
+     * @details on the first error, the copies in progress are canceled and the workers stop taking further files,
+     * and the error is rethrown after all the workers have finished.
+     * @param callback called each time a file has been copied
+     * @throws std::filesystem::filesystem_error or another exception thrown during the copy
+     */
+    void run(const progress_callback& callback);
+
+    /**
+     * @brief returns the total size of the files added, which is the size before compression
+     */
+    [[nodiscard]] std::uintmax_t total_bytes() const noexcept {
+        return total_bytes_;
+    }
+
+    /**
+     * @brief returns the number of worker threads used in run()
+     */
+    [[nodiscard]] std::size_t parallelism() const noexcept;
+
+    /**
+     * @brief returns the default number of worker threads for the files
+     * @details a few threads for each device involved, bounded by the number of cores
+     */
+    [[nodiscard]] static std::size_t default_parallelism(const std::vector<std::filesystem::path>& paths);
+
+private:
+    struct entry {
+        std::filesystem::path src;
+        std::filesystem::path dst;
+        std::uintmax_t size;
+        std::filesystem::path previous{};
+    };
+
+    std::size_t parallelism_;
+    copy_options options_{};
+    compression compression_{};
+    bool decompress_{};
+    std::size_t block_threads_{1};
+    std::vector<entry> entries_{};
+    std::uintmax_t total_bytes_{};
+
+    std::atomic_size_t next_{};
+    std::atomic_bool failed_{};
+    std::uintmax_t completed_bytes_{};
+    std::exception_ptr error_{};
+    std::mutex mtx_{};
+
+    void worker(const progress_callback& callback);
+};
+
+}  // tateyama::datastore
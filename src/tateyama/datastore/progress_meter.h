@@ -0,0 +1,235 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tateyama::datastore {
+
+/**
+ * @brief the progress of a backup reported by progress_meter
+ */
+struct progress_report {
+    std::uintmax_t bytes{};          // the bytes completed, including those completed without being copied
+    std::uintmax_t total_bytes{};
+    std::size_t files{};
+    std::size_t total_files{};
+    std::uintmax_t bytes_per_second{};  // the recent rate of copying
+    std::optional<std::uint64_t> eta_seconds{};  // std::nullopt while the rate is not known
+    std::string active_file{};       // the file being copied for the longest time, empty if none
+    std::size_t active_files{};
+
+    [[nodiscard]] float ratio() const noexcept {
+        return total_bytes > 0 ? std::min(static_cast<float>(bytes) / static_cast<float>(total_bytes), 1.0F) : 1.0F;
+    }
+};
+
+/**
+ * @brief counts the bytes copied from within the copy loops, and reports the progress at a fixed interval
+ * @details add() is called by the threads copying the files each time a part of a file has been copied, thus a large
+ * file makes progress while it is being copied. The report is made by the thread which finds the interval has passed,
+ * and the others never wait for it. The rate is taken over the last several reports, so that it follows the changes
+ * of the rate, such as those by another workload on the devices.
+ */
+class progress_meter {
+public:
+    using report_callback = std::function<void(const progress_report& report)>;
+
+    static constexpr auto default_interval = std::chrono::milliseconds(1000);
+
+    /**
+     * @brief create a progress_meter
+     * @param total_bytes the bytes of all the files
+     * @param total_files the number of the files
+     * @param callback called with the progress at most once in each interval, and by finish()
+     * @param interval the interval of the reports
+     */
+    progress_meter(std::uintmax_t total_bytes, std::size_t total_files, report_callback callback, std::chrono::steady_clock::duration interval = default_interval)
+        : total_bytes_(total_bytes), total_files_(total_files), callback_(std::move(callback)), interval_(interval) {
+        samples_.emplace_back(std::chrono::steady_clock::now(), 0);
+        next_report_ = (samples_.front().first + interval_).time_since_epoch().count();
+    }
+
+    /**
+     * @brief counts the bytes copied
+     */
+    void add(std::uintmax_t bytes) {
+        copied_.fetch_add(bytes);
+        report_if_due();
+    }
+
+    /**
+     * @brief counts the bytes and files completed without being copied, such as the holes, the files cloned
+     * or those completed by the previous run, which are excluded from the rate
+     */
+    void skip(std::uintmax_t bytes, std::size_t files = 0) {
+        skipped_.fetch_add(bytes);
+        files_.fetch_add(files);
+        report_if_due();
+    }
+
+    /**
+     * @brief tells that the file is being copied
+     * @param name the name identifying the file among those being copied, such as the destination path
+     */
+    void begin_file(const std::string& name) {
+        std::unique_lock<std::mutex> lock(active_mtx_);
+        active_.emplace_back(name);
+    }
+
+    /**
+     * @brief tells that the copy of the file has ended
+     * @param name the name given to begin_file()
+     * @param completed false if the copy has failed, in which case the file is not counted
+     */
+    void end_file(const std::string& name, bool completed = true) {
+        {
+            std::unique_lock<std::mutex> lock(active_mtx_);
+            if (auto it = std::find(active_.begin(), active_.end(), name); it != active_.end()) {
+                active_.erase(it);
+            }
+        }
+        if (completed) {
+            files_.fetch_add(1);
+        }
+        report_if_due();
+    }
+
+    /**
+     * @brief pairs begin_file() with end_file() in a scope, which ends the file as failed unless complete() is called,
+     * so that a file whose copy has thrown is not left as active
+     */
+    class file_scope {
+    public:
+        /**
+         * @brief create a file_scope
+         * @param meter the progress meter, or nullptr not to count
+         * @param name the name identifying the file among those being copied
+         */
+        file_scope(progress_meter* meter, std::string name) : meter_(meter), name_(std::move(name)) {
+            if (meter_ != nullptr) {
+                meter_->begin_file(name_);
+            }
+        }
+        ~file_scope() {
+            if (meter_ != nullptr) {
+                meter_->end_file(name_, completed_);
+            }
+        }
+        file_scope(file_scope const& other) = delete;
+        file_scope& operator=(file_scope const& other) = delete;
+        file_scope(file_scope&& other) noexcept = delete;
+        file_scope& operator=(file_scope&& other) noexcept = delete;
+
+        /**
+         * @brief tells that the file has been copied
+         */
+        void complete() noexcept {
+            completed_ = true;
+        }
+    private:
+        progress_meter* meter_;
+        std::string name_;
+        bool completed_{};
+    };
+
+    /**
+     * @brief reports the progress at the end, regardless of the interval
+     */
+    void finish() {
+        std::unique_lock<std::mutex> lock(report_mtx_);
+        report(std::chrono::steady_clock::now());
+    }
+
+private:
+    using sample = std::pair<std::chrono::steady_clock::time_point, std::uintmax_t>;
+    static constexpr std::size_t rate_samples = 10;
+
+    std::uintmax_t total_bytes_;
+    std::size_t total_files_;
+    report_callback callback_;
+    std::chrono::steady_clock::duration interval_;
+
+    std::atomic<std::uintmax_t> copied_{};
+    std::atomic<std::uintmax_t> skipped_{};
+    std::atomic<std::size_t> files_{};
+    std::atomic<std::chrono::steady_clock::rep> next_report_{};
+
+    std::mutex active_mtx_{};
+    std::vector<std::string> active_{};  // in the order of beginning
+
+    std::mutex report_mtx_{};
+    std::deque<sample> samples_{};  // the time and the bytes copied at the last reports
+
+    void report_if_due() {
+        auto now = std::chrono::steady_clock::now();
+        auto due = next_report_.load();
+        if (now.time_since_epoch().count() < due) {
+            return;
+        }
+        // only the thread which has advanced the due time reports, the copy is never held up by the others
+        if (!next_report_.compare_exchange_strong(due, (now + interval_).time_since_epoch().count())) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(report_mtx_);
+        report(now);
+    }
+
+    void report(std::chrono::steady_clock::time_point now) {
+        progress_report r{};
+        auto copied = copied_.load();
+        r.bytes = copied + skipped_.load();
+        r.total_bytes = std::max(total_bytes_, r.bytes);
+        r.files = files_.load();
+        r.total_files = std::max(total_files_, r.files);
+
+        samples_.emplace_back(now, copied);
+        while (samples_.size() > rate_samples + 1) {
+            samples_.pop_front();
+        }
+        auto elapsed = std::chrono::duration<double>(now - samples_.front().first).count();
+        if (elapsed > 0) {
+            r.bytes_per_second = static_cast<std::uintmax_t>(static_cast<double>(copied - samples_.front().second) / elapsed);
+        }
+        if (r.bytes_per_second > 0) {
+            r.eta_seconds = (r.total_bytes - r.bytes + r.bytes_per_second - 1) / r.bytes_per_second;
+        } else if (r.bytes == r.total_bytes) {
+            r.eta_seconds = 0;
+        }
+        {
+            std::unique_lock<std::mutex> lock(active_mtx_);
+            if (!active_.empty()) {
+                r.active_file = active_.front();
+            }
+            r.active_files = active_.size();
+        }
+        if (callback_) {
+            callback_(r);
+        }
+    }
+};
+
+}  // tateyama::datastore
@@ -0,0 +1,330 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include <gflags/gflags.h>
+
+#include "tateyama/authentication/authenticator.h"
+#define BOOST_BIND_GLOBAL_PLACEHOLDERS  // FIXME (to retain the current behavior)
+#include "tateyama/transport/transport.h"
+#include "tateyama/tgctl/runtime_error.h"
+#include "backup.h"
+#include "manifest.h"
+#include "restore_job.h"
+
+DECLARE_string(monitor);  // NOLINT
+
+namespace tateyama::datastore {
+
+using status_kind = ::tateyama::proto::datastore::response::RestoreStatus::StatusKind;
+
+constexpr auto initial_poll_interval = std::chrono::milliseconds(100);
+constexpr auto max_poll_interval = std::chrono::milliseconds(5000);
+
+static std::string_view to_string_view(status_kind kind) noexcept {
+    using namespace std::string_view_literals;
+    switch (kind) {
+    case ::tateyama::proto::datastore::response::RestoreStatus::PREPARING: return "preparing"sv;
+    case ::tateyama::proto::datastore::response::RestoreStatus::RUNNING: return "running"sv;
+    case ::tateyama::proto::datastore::response::RestoreStatus::COMPLETED: return "completed"sv;
+    case ::tateyama::proto::datastore::response::RestoreStatus::FAILED: return "failed"sv;
+    case ::tateyama::proto::datastore::response::RestoreStatus::CANCELED: return "canceled"sv;
+    default: return "unknown"sv;
+    }
+}
+
+static std::uint64_t parse_job_id(const std::string& job, std::string_view what) {
+    std::size_t idx{};
+    try {
+        auto id = std::stoull(job, &idx);
+        if (idx == job.length()) {
+            return id;
+        }
+    } catch (std::logic_error const& e) {
+        // reported below
+    }
+    throw tgctl::runtime_error(monitor::reason::invalid_argument, "could not " + std::string(what) + ", as " + job + " is not a restore job id");
+}
+
+restore_size restore_size_of(const std::filesystem::path& directory) {
+    restore_size size{};
+    std::error_code ec{};
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_regular_file(ec) && !manifest::is_metadata(it->path().lexically_relative(directory))) {
+            size.bytes += it->file_size(ec);
+            size.files++;
+        }
+    }
+    return size;
+}
+
+namespace {
+
+// reports the progress of a restore job, estimating the bytes and files restored from the progress
+class restore_progress {
+public:
+    restore_progress(std::uint64_t id, restore_size size, monitor::monitor* monitor_output)
+        : id_(id), size_(size), monitor_output_(monitor_output) {
+    }
+
+    void report(status_kind kind, float progress) {
+        if (kind == kind_ && progress == progress_) {
+            return;
+        }
+        kind_ = kind;
+        progress_ = progress;
+
+        auto bytes = static_cast<std::uintmax_t>(static_cast<double>(size_.bytes) * progress);
+        auto files = static_cast<std::size_t>(static_cast<double>(size_.files) * progress);
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        auto throughput = elapsed > 0 ? static_cast<std::uintmax_t>(static_cast<double>(bytes) / elapsed) : 0;
+        if (monitor_output_ != nullptr) {
+            monitor_output_->progress(progress, bytes, size_.bytes, files, size_.files, throughput);
+        }
+        std::ostringstream line{};
+        line << "restore job " << id_ << ": " << to_string_view(kind) << ", "
+             << std::fixed << std::setprecision(1) << progress * 100.0F << "%";
+        if (size_.files > 0) {
+            line << " (" << mebibytes(bytes) << " / " << mebibytes(size_.bytes) << " MiB, "
+                 << files << " / " << size_.files << " files, " << mebibytes(throughput) << " MiB/s)";
+        }
+        std::cout << line.str() << '\n' << std::flush;
+    }
+
+private:
+    std::uint64_t id_;
+    restore_size size_;
+    monitor::monitor* monitor_output_;
+    std::chrono::steady_clock::time_point start_{std::chrono::steady_clock::now()};
+    status_kind kind_{::tateyama::proto::datastore::response::RestoreStatus::RESTORE_STATUS_KIND_UNSPECIFIED};
+    float progress_{-1.0F};
+
+    static double mebibytes(std::uintmax_t bytes) noexcept {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+};
+
+}  // namespace
+
+// disposes the history of the restore job, which is of no use once it has been waited for
+static void dispose_restore(tateyama::bootstrap::wire::transport& transport, std::uint64_t id) {
+    ::tateyama::proto::datastore::request::Request request{};
+    request.mutable_restore_dispose()->set_id(id);
+    auto response = transport.send<::tateyama::proto::datastore::response::RestoreDispose>(request);
+    request.clear_restore_dispose();
+    if (!response) {
+        std::cerr << "could not dispose the restore job " << id << ", as the response is broken\n" << std::flush;
+        return;
+    }
+    switch (response.value().result_case()) {
+    case ::tateyama::proto::datastore::response::RestoreDispose::kSuccess:
+    case ::tateyama::proto::datastore::response::RestoreDispose::kNotFound:
+        break;
+    default:
+        std::cerr << "could not dispose the restore job " << id << ", as it ends up with " << response.value().result_case() << '\n' << std::flush;
+    }
+}
+
+monitor::reason wait_restore(std::uint64_t id, restore_size size, monitor::monitor* monitor_output) {  //NOLINT(readability-function-cognitive-complexity)
+    auto transport = std::make_unique<tateyama::bootstrap::wire::transport>(tateyama::framework::service_id_datastore);
+    restore_progress reporter(id, size, monitor_output);
+    auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(initial_poll_interval);
+    float last_progress = -1.0F;
+    bool first = true;
+    std::optional<monitor::reason> reason{};
+    while (!reason) {
+        ::tateyama::proto::datastore::request::Request request{};
+        request.mutable_restore_status()->set_id(id);
+        auto response = transport->send<::tateyama::proto::datastore::response::RestoreStatus>(request);
+        request.clear_restore_status();
+        if (!response) {
+            std::cerr << "RestoreStatus response error: \n" << std::flush;
+            reason = monitor::reason::payload_broken;
+            break;
+        }
+        const auto& status = response.value();
+        if (status.result_case() == ::tateyama::proto::datastore::response::RestoreStatus::kNotFound) {
+            transport->close();
+            if (first) {
+                // the server has completed the restore within RestoreBegin, and keeps no job to be inquired
+                reporter.report(::tateyama::proto::datastore::response::RestoreStatus::COMPLETED, 1.0F);
+                return monitor::reason::absent;
+            }
+            std::cerr << "could not wait for the restore job " << id << ", as it has disappeared\n" << std::flush;
+            return monitor::reason::not_found;
+        }
+        if (status.result_case() != ::tateyama::proto::datastore::response::RestoreStatus::kSuccess) {
+            std::cerr << "could not wait for the restore job " << id << ", as " << status.unknown_error().message() << '\n' << std::flush;
+            reason = monitor::reason::server;
+            break;
+        }
+        first = false;
+
+        auto kind = status.success().status();
+        auto progress = std::clamp(status.success().progress(), 0.0F, 1.0F);
+        switch (kind) {
+        case ::tateyama::proto::datastore::response::RestoreStatus::COMPLETED:
+            progress = 1.0F;
+            reason = monitor::reason::absent;
+            break;
+        case ::tateyama::proto::datastore::response::RestoreStatus::FAILED:
+            reason = monitor::reason::server;
+            break;
+        case ::tateyama::proto::datastore::response::RestoreStatus::CANCELED:
+            reason = monitor::reason::interrupted;
+            break;
+        default:
+            break;
+        }
+        reporter.report(kind, progress);
+        if (reason) {
+            break;
+        }
+
+        // polled less often while the progress is not changing, as a restore can take hours
+        interval = progress != last_progress ? std::chrono::duration_cast<std::chrono::milliseconds>(initial_poll_interval) : std::min(interval * 2, std::chrono::duration_cast<std::chrono::milliseconds>(max_poll_interval));
+        last_progress = progress;
+        std::this_thread::sleep_for(interval);
+    }
+    dispose_restore(*transport, id);
+    transport->close();
+    return reason.value();
+}
+
+tgctl::return_code tgctl_restore_status(const std::string& job) {
+    std::unique_ptr<monitor::monitor> monitor_output{};
+
+    if (!FLAGS_monitor.empty()) {
+        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
+        monitor_output->start();
+    }
+
+    auto reason = monitor::reason::absent;
+    try {
+        auto id = parse_job_id(job, "get the status of the restore job");
+        auto transport = std::make_unique<tateyama::bootstrap::wire::transport>(tateyama::framework::service_id_datastore);
+        ::tateyama::proto::datastore::request::Request request{};
+        request.mutable_restore_status()->set_id(id);
+        auto response = transport->send<::tateyama::proto::datastore::response::RestoreStatus>(request);
+        request.clear_restore_status();
+        transport->close();
+
+        if (response) {
+            const auto& status = response.value();
+            switch (status.result_case()) {
+            case ::tateyama::proto::datastore::response::RestoreStatus::kSuccess: {
+                const auto& success = status.success();
+                std::cout << "id = " << success.id()
+                          << ", status = " << to_string_view(success.status())
+                          << ", progress = " << success.progress()
+                          << ", label = " << success.label()
+                          << ", owner = " << success.owner()
+                          << ", source = " << success.source()
+                          << ", start_time = " << success.start_time()
+                          << ", elapsed_finish_time = " << success.elapsed_finish_time() << '\n' << std::flush;
+                if (monitor_output) {
+                    monitor_output->restore_status(success.id(), to_string_view(success.status()), success.progress());
+                    monitor_output->finish(monitor::reason::absent);
+                }
+                return tgctl::return_code::ok;
+            }
+            case ::tateyama::proto::datastore::response::RestoreStatus::kNotFound:
+                std::cerr << "could not get the status of the restore job " << id << ", as it is not found\n" << std::flush;
+                reason = monitor::reason::not_found;
+                break;
+            default:
+                std::cerr << "could not get the status of the restore job " << id << ", as " << status.unknown_error().message() << '\n' << std::flush;
+                reason = monitor::reason::server;
+            }
+        } else {
+            std::cerr << "RestoreStatus response error: \n" << std::flush;
+            reason = monitor::reason::payload_broken;
+        }
+    } catch (tgctl::runtime_error &ex) {
+        std::cerr << ex.what() << '\n' << std::flush;
+        reason = ex.code();
+    }
+
+    if (monitor_output) {
+        monitor_output->finish(reason);
+    }
+    return tgctl::return_code::err;
+}
+
+tgctl::return_code tgctl_restore_cancel(const std::string& job) {
+    std::unique_ptr<monitor::monitor> monitor_output{};
+
+    if (!FLAGS_monitor.empty()) {
+        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
+        monitor_output->start();
+    }
+
+    auto reason = monitor::reason::absent;
+    try {
+        auto id = parse_job_id(job, "cancel the restore job");
+        auto transport = std::make_unique<tateyama::bootstrap::wire::transport>(tateyama::framework::service_id_datastore);
+        ::tateyama::proto::datastore::request::Request request{};
+        request.mutable_restore_cancel()->set_id(id);
+        auto response = transport->send<::tateyama::proto::datastore::response::RestoreCancel>(request);
+        request.clear_restore_cancel();
+        transport->close();
+
+        if (response) {
+            switch (response.value().result_case()) {
+            case ::tateyama::proto::datastore::response::RestoreCancel::kSuccess:
+                std::cout << "restore job " << id << " has been canceled\n" << std::flush;
+                if (monitor_output) {
+                    monitor_output->finish(monitor::reason::absent);
+                }
+                return tgctl::return_code::ok;
+            case ::tateyama::proto::datastore::response::RestoreCancel::kNotFound:
+                std::cerr << "could not cancel the restore job " << id << ", as it is not found\n" << std::flush;
+                reason = monitor::reason::not_found;
+                break;
+            case ::tateyama::proto::datastore::response::RestoreCancel::kPermissionError:
+                std::cerr << "could not cancel the restore job " << id << ", as it is not permitted\n" << std::flush;
+                reason = monitor::reason::permission;
+                break;
+            case ::tateyama::proto::datastore::response::RestoreCancel::kRejected:
+                std::cerr << "could not cancel the restore job " << id << ", as it is already running\n" << std::flush;
+                reason = monitor::reason::invalid_status;
+                break;
+            default:
+                std::cerr << "could not cancel the restore job " << id << ", as " << response.value().unknown_error().message() << '\n' << std::flush;
+                reason = monitor::reason::server;
+            }
+        } else {
+            std::cerr << "RestoreCancel response error: \n" << std::flush;
+            reason = monitor::reason::payload_broken;
+        }
+    } catch (tgctl::runtime_error &ex) {
+        std::cerr << ex.what() << '\n' << std::flush;
+        reason = ex.code();
+    }
+
+    if (monitor_output) {
+        monitor_output->finish(reason);
+    }
+    return tgctl::return_code::err;
+}
+
+}  // tateyama::datastore
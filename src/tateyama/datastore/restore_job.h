@@ -0,0 +1,51 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+#include "tateyama/monitor/monitor.h"
+
+namespace tateyama::datastore {
+
+/**
+ * @brief the size of the backup being restored, from which the bytes and files restored are estimated
+ */
+struct restore_size {
+    std::uintmax_t bytes{};
+    std::size_t files{};
+};
+
+/**
+ * @brief returns the size of the regular files in the backup directory, excluding the manifest
+ */
+restore_size restore_size_of(const std::filesystem::path& directory);
+
+/**
+ * @brief polls RestoreStatus of the restore job with backoff until it finishes, then disposes it
+ * @details the progress is reported to the console and the monitor, in which the bytes and files restored
+ * are estimated from the progress given by the server and the size of the backup.
+ * @param id the restore job ID
+ * @param size the size of the backup, or zero if unknown
+ * @param monitor_output the monitor, or nullptr
+ * @return monitor::reason::absent if the job has completed, or the reason of the failure
+ * @throws tgctl::runtime_error if the server cannot be connected
+ */
+monitor::reason wait_restore(std::uint64_t id, restore_size size, monitor::monitor* monitor_output);
+
+}  // tateyama::datastore
@@ -0,0 +1,298 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "tateyama/authentication/authenticator.h"
+#define BOOST_BIND_GLOBAL_PLACEHOLDERS  // FIXME (to retain the current behavior)
+#include "tateyama/transport/transport.h"
+#include "tateyama/tgctl/runtime_error.h"
+#include "tateyama/monitor/monitor.h"
+#include "backup.h"
+
+DEFINE_string(comment, "", "the comment of the tag created by backup tag add");  // NOLINT
+DECLARE_string(monitor);  // NOLINT
+
+namespace tateyama::datastore {
+
+using tag = ::tateyama::proto::datastore::common::Tag;
+
+static std::string to_timepoint_string(std::uint64_t msu) {
+    std::chrono::time_point<std::chrono::system_clock> e0{};
+    std::chrono::time_point<std::chrono::system_clock> t = e0 + std::chrono::milliseconds(static_cast<std::int64_t>(msu));
+
+    std::stringstream stream;
+    time_t epoch_seconds = std::chrono::system_clock::to_time_t(t);
+    struct tm buf{};
+    if (gmtime_r(&epoch_seconds, &buf) == &buf) {
+        stream << std::put_time(&buf, "%FT%TZ");
+        return stream.str();
+    }
+    return {};
+}
+
+static void show_tag(const tag& t, monitor::monitor* monitor_output) {
+    std::cout << std::left;
+    std::cout << std::setw(10) << "name" << t.name() << '\n';
+    std::cout << std::setw(10) << "comment" << t.comment() << '\n';
+    std::cout << std::setw(10) << "author" << t.author() << '\n';
+    std::cout << std::setw(10) << "created" << to_timepoint_string(t.timestamp()) << '\n' << std::flush;
+    if (monitor_output) {
+        monitor_output->tag_info(t.name(), t.comment(), t.author(), to_timepoint_string(t.timestamp()));
+    }
+}
+
+tgctl::return_code tgctl_backup_tag_add(const std::string& name) {
+    std::unique_ptr<monitor::monitor> monitor_output{};
+
+    if (!FLAGS_monitor.empty()) {
+        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
+        monitor_output->start();
+    }
+
+    auto reason = monitor::reason::absent;
+    try {
+        auto transport = std::make_unique<tateyama::bootstrap::wire::transport>(tateyama::framework::service_id_datastore);
+        ::tateyama::proto::datastore::request::Request request{};
+        auto* tag_add = request.mutable_tag_add();
+        tag_add->set_name(name);
+        tag_add->set_comment(FLAGS_comment);
+        auto response = transport->send<::tateyama::proto::datastore::response::TagAdd>(request);
+        request.clear_tag_add();
+        transport->close();
+
+        if (response) {
+            switch (response.value().result_case()) {
+            case ::tateyama::proto::datastore::response::TagAdd::kSuccess:
+                show_tag(response.value().success().tag(), monitor_output.get());
+                if (monitor_output) {
+                    monitor_output->finish(monitor::reason::absent);
+                }
+                return tgctl::return_code::ok;
+            case ::tateyama::proto::datastore::response::TagAdd::kAlreadyExists:
+                std::cerr << "could not add the tag '" << name << "', as it already exists\n" << std::flush;
+                reason = monitor::reason::invalid_argument;
+                break;
+            case ::tateyama::proto::datastore::response::TagAdd::kTooLongName:
+                std::cerr << "could not add the tag '" << name << "', as the name is longer than "
+                          << response.value().too_long_name().max_characters() << " characters\n" << std::flush;
+                reason = monitor::reason::invalid_argument;
+                break;
+            default:
+                std::cerr << "could not add the tag '" << name << "', as " << response.value().unknown_error().message() << '\n' << std::flush;
+                reason = monitor::reason::server;
+            }
+        } else {
+            std::cerr << "TagAdd response error: \n" << std::flush;
+            reason = monitor::reason::payload_broken;
+        }
+    } catch (tgctl::runtime_error &ex) {
+        std::cerr << ex.what() << '\n' << std::flush;
+        reason = ex.code();
+    }
+
+    if (monitor_output) {
+        monitor_output->finish(reason);
+    }
+    return tgctl::return_code::err;
+}
+
+tgctl::return_code tgctl_backup_tag_list() {
+    std::unique_ptr<monitor::monitor> monitor_output{};
+
+    if (!FLAGS_monitor.empty()) {
+        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
+        monitor_output->start();
+    }
+
+    auto reason = monitor::reason::absent;
+    try {
+        auto transport = std::make_unique<tateyama::bootstrap::wire::transport>(tateyama::framework::service_id_datastore);
+        ::tateyama::proto::datastore::request::Request request{};
+        (void) request.mutable_tag_list();
+        auto response = transport->send<::tateyama::proto::datastore::response::TagList>(request);
+        request.clear_tag_list();
+        transport->close();
+
+        if (response) {
+            switch (response.value().result_case()) {
+            case ::tateyama::proto::datastore::response::TagList::kSuccess: {
+                std::vector<const tag*> tags{};
+                for (auto&& t : response.value().success().tags()) {
+                    tags.emplace_back(&t);
+                }
+                // the oldest first, as the restore points are made in time
+                std::stable_sort(tags.begin(), tags.end(), [](const tag* a, const tag* b) { return a->timestamp() < b->timestamp(); });
+
+                std::size_t name_max{4};
+                std::size_t created_max{7};
+                std::size_t author_max{6};
+                for (auto* t : tags) {
+                    name_max = std::max(name_max, t->name().length());
+                    created_max = std::max(created_max, to_timepoint_string(t->timestamp()).length());
+                    author_max = std::max(author_max, t->author().length());
+                }
+                name_max += 2;
+                created_max += 2;
+                author_max += 2;
+                // Do not pad the comment, which is placed on the far right.
+
+                if (!tags.empty()) {
+                    std::cout << std::left;
+                    std::cout << std::setw(static_cast<int>(name_max)) << "name";
+                    std::cout << std::setw(static_cast<int>(created_max)) << "created";
+                    std::cout << std::setw(static_cast<int>(author_max)) << "author";
+                    std::cout << "comment" << '\n';
+                }
+                for (auto* t : tags) {
+                    std::cout << std::setw(static_cast<int>(name_max)) << t->name();
+                    std::cout << std::setw(static_cast<int>(created_max)) << to_timepoint_string(t->timestamp());
+                    std::cout << std::setw(static_cast<int>(author_max)) << t->author();
+                    std::cout << t->comment() << '\n';
+                    if (monitor_output) {
+                        monitor_output->tag_info(t->name(), t->comment(), t->author(), to_timepoint_string(t->timestamp()));
+                    }
+                }
+                std::cout << std::flush;
+                if (monitor_output) {
+                    monitor_output->finish(monitor::reason::absent);
+                }
+                return tgctl::return_code::ok;
+            }
+            default:
+                std::cerr << "could not list the tags, as " << response.value().unknown_error().message() << '\n' << std::flush;
+                reason = monitor::reason::server;
+            }
+        } else {
+            std::cerr << "TagList response error: \n" << std::flush;
+            reason = monitor::reason::payload_broken;
+        }
+    } catch (tgctl::runtime_error &ex) {
+        std::cerr << ex.what() << '\n' << std::flush;
+        reason = ex.code();
+    }
+
+    if (monitor_output) {
+        monitor_output->finish(reason);
+    }
+    return tgctl::return_code::err;
+}
+
+tgctl::return_code tgctl_backup_tag_show(const std::string& name) {
+    std::unique_ptr<monitor::monitor> monitor_output{};
+
+    if (!FLAGS_monitor.empty()) {
+        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
+        monitor_output->start();
+    }
+
+    auto reason = monitor::reason::absent;
+    try {
+        auto transport = std::make_unique<tateyama::bootstrap::wire::transport>(tateyama::framework::service_id_datastore);
+        ::tateyama::proto::datastore::request::Request request{};
+        request.mutable_tag_get()->set_name(name);
+        auto response = transport->send<::tateyama::proto::datastore::response::TagGet>(request);
+        request.clear_tag_get();
+        transport->close();
+
+        if (response) {
+            switch (response.value().result_case()) {
+            case ::tateyama::proto::datastore::response::TagGet::kSuccess:
+                show_tag(response.value().success().tag(), monitor_output.get());
+                if (monitor_output) {
+                    monitor_output->finish(monitor::reason::absent);
+                }
+                return tgctl::return_code::ok;
+            case ::tateyama::proto::datastore::response::TagGet::kNotFound:
+                std::cerr << "could not show the tag '" << name << "', as it is not found\n" << std::flush;
+                reason = monitor::reason::not_found;
+                break;
+            default:
+                std::cerr << "could not show the tag '" << name << "', as " << response.value().unknown_error().message() << '\n' << std::flush;
+                reason = monitor::reason::server;
+            }
+        } else {
+            std::cerr << "TagGet response error: \n" << std::flush;
+            reason = monitor::reason::payload_broken;
+        }
+    } catch (tgctl::runtime_error &ex) {
+        std::cerr << ex.what() << '\n' << std::flush;
+        reason = ex.code();
+    }
+
+    if (monitor_output) {
+        monitor_output->finish(reason);
+    }
+    return tgctl::return_code::err;
+}
+
+tgctl::return_code tgctl_backup_tag_remove(const std::string& name) {
+    std::unique_ptr<monitor::monitor> monitor_output{};
+
+    if (!FLAGS_monitor.empty()) {
+        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
+        monitor_output->start();
+    }
+
+    auto reason = monitor::reason::absent;
+    try {
+        auto transport = std::make_unique<tateyama::bootstrap::wire::transport>(tateyama::framework::service_id_datastore);
+        ::tateyama::proto::datastore::request::Request request{};
+        request.mutable_tag_remove()->set_name(name);
+        auto response = transport->send<::tateyama::proto::datastore::response::TagRemove>(request);
+        request.clear_tag_remove();
+        transport->close();
+
+        if (response) {
+            switch (response.value().result_case()) {
+            case ::tateyama::proto::datastore::response::TagRemove::kSuccess:
+                std::cout << "tag '" << name << "' has been removed\n" << std::flush;
+                if (monitor_output) {
+                    monitor_output->finish(monitor::reason::absent);
+                }
+                return tgctl::return_code::ok;
+            case ::tateyama::proto::datastore::response::TagRemove::kNotFound:
+                std::cerr << "could not remove the tag '" << name << "', as it is not found\n" << std::flush;
+                reason = monitor::reason::not_found;
+                break;
+            default:
+                std::cerr << "could not remove the tag '" << name << "', as " << response.value().unknown_error().message() << '\n' << std::flush;
+                reason = monitor::reason::server;
+            }
+        } else {
+            std::cerr << "TagRemove response error: \n" << std::flush;
+            reason = monitor::reason::payload_broken;
+        }
+    } catch (tgctl::runtime_error &ex) {
+        std::cerr << ex.what() << '\n' << std::flush;
+        reason = ex.code();
+    }
+
+    if (monitor_output) {
+        monitor_output->finish(reason);
+    }
+    return tgctl::return_code::err;
+}
+
+}  // tateyama::datastore
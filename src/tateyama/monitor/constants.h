@@ -156,5 +156,38 @@ constexpr static std::string_view FORMAT_CONFIG = R"("format": "config")";
 constexpr static std::string_view SECTION = R"("section": ")";
 constexpr static std::string_view KEY = R"("key": ")";
 constexpr static std::string_view VALUE = R"("value": ")";
+// file copy
+constexpr static std::string_view FORMAT_FILE_COPY = R"("format": "file_copy")";
+constexpr static std::string_view FILE_NAME = R"("file": ")";
+constexpr static std::string_view STRATEGY = R"("strategy": ")";
+constexpr static std::string_view BYTES = R"("bytes": )";
+// progress of a copy
+constexpr static std::string_view TOTAL_BYTES = R"("total_bytes": )";
+constexpr static std::string_view FILES = R"("files": )";
+constexpr static std::string_view TOTAL_FILES = R"("total_files": )";
+constexpr static std::string_view THROUGHPUT = R"("throughput": )";
+constexpr static std::string_view ETA = R"("eta": )";
+// restore status
+constexpr static std::string_view FORMAT_RESTORE_STATUS = R"("format": "restore_status")";
+constexpr static std::string_view RESTORE_ID = R"("id": )";
+// tag
+constexpr static std::string_view FORMAT_TAG = R"("format": "tag")";
+constexpr static std::string_view TAG_NAME = R"("name": ")";
+constexpr static std::string_view COMMENT = R"("comment": ")";
+constexpr static std::string_view AUTHOR = R"("author": ")";
+constexpr static std::string_view CREATED_AT = R"("created_at": ")";
+// export
+constexpr static std::string_view FORMAT_EXPORT = R"("format": "export")";
+constexpr static std::string_view QUERY = R"("query": )";
+// import
+constexpr static std::string_view FORMAT_IMPORT = R"("format": "import")";
+constexpr static std::string_view RECORDS = R"("records": )";
+constexpr static std::string_view MESSAGE = R"("message": ")";
+// supervisor
+constexpr static std::string_view FORMAT_SUPERVISOR = R"("format": "supervisor")";
+constexpr static std::string_view EVENT = R"("event": ")";
+constexpr static std::string_view PID = R"("pid": )";
+constexpr static std::string_view RESTARTS = R"("restarts": )";
+constexpr static std::string_view BACKOFF = R"("backoff": )";
 
 }  // tateyama::monitor
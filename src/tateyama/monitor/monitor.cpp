@@ -13,6 +13,8 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <array>
+#include <cstdio>
 #include <ctime>
 #include <iostream>
 
@@ -20,6 +22,29 @@
 
 namespace tateyama::monitor {
 
+static std::string escaped(std::string_view value) {
+    std::string result{};
+    result.reserve(value.length());
+    for (char c : value) {
+        switch (c) {
+        case '"': result += "\\\""; break;
+        case '\\': result += "\\\\"; break;
+        case '\n': result += "\\n"; break;
+        case '\r': result += "\\r"; break;
+        case '\t': result += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                std::array<char, 7> buf{};
+                std::snprintf(buf.data(), buf.size(), "\\u%04x", static_cast<unsigned int>(c));  // NOLINT(cppcoreguidelines-pro-type-vararg)
+                result += buf.data();
+            } else {
+                result += c;
+            }
+        }
+    }
+    return result;
+}
+
 monitor::monitor(std::string& file_name) : strm_(fstrm_), is_filestream_(true) {
     fstrm_.open(file_name, std::ios_base::out | std::ios_base::trunc);
 }
@@ -56,6 +81,47 @@ void monitor::progress(float ratio) {
     strm_.flush();
 }
 
+void monitor::progress(float ratio,
+                       std::uintmax_t bytes,
+                       std::uintmax_t total_bytes,
+                       std::size_t files,
+                       std::size_t total_files,
+                       std::uintmax_t bytes_per_second) {
+    strm_ << "{ " << TIME_STAMP << time(nullptr) << ", "
+          << KIND_PROGRESS << ", " << PROGRESS << ratio << ", "
+          << BYTES << bytes << ", "
+          << TOTAL_BYTES << total_bytes << ", "
+          << FILES << files << ", "
+          << TOTAL_FILES << total_files << ", "
+          << THROUGHPUT << bytes_per_second << " }\n";
+    strm_.flush();
+}
+
+void monitor::progress(float ratio,
+                       std::uintmax_t bytes,
+                       std::uintmax_t total_bytes,
+                       std::size_t files,
+                       std::size_t total_files,
+                       std::uintmax_t bytes_per_second,
+                       std::optional<std::uint64_t> eta_seconds,
+                       std::string_view file) {
+    strm_ << "{ " << TIME_STAMP << time(nullptr) << ", "
+          << KIND_PROGRESS << ", " << PROGRESS << ratio << ", "
+          << BYTES << bytes << ", "
+          << TOTAL_BYTES << total_bytes << ", "
+          << FILES << files << ", "
+          << TOTAL_FILES << total_files << ", "
+          << THROUGHPUT << bytes_per_second;
+    if (eta_seconds) {
+        strm_ << ", " << ETA << eta_seconds.value();
+    }
+    if (!file.empty()) {
+        strm_ << ", " << FILE_NAME << escaped(file) << "\"";
+    }
+    strm_ << " }\n";
+    strm_.flush();
+}
+
 void monitor::status(tateyama::monitor::status stat) {
     strm_ << "{ " << TIME_STAMP << time(nullptr) << ", "
           << KIND_DATA << ", " << FORMAT_STATUS << ", " << STATUS << to_string_view(stat) << "\" }\n";
@@ -106,4 +172,88 @@ void monitor::config_item(std::string_view section,
     strm_.flush();
 }
 
+void monitor::file_copy(std::string_view file,
+                        std::string_view strategy,
+                        std::uintmax_t bytes) {
+    strm_ << "{ " << TIME_STAMP << time(nullptr) << ", "
+          << KIND_DATA << ", " << FORMAT_FILE_COPY << ", "
+          << FILE_NAME << escaped(file) << "\", "
+          << STRATEGY << strategy << "\", "
+          << BYTES << bytes << " }\n";
+    strm_.flush();
+}
+
+void monitor::restore_status(std::uint64_t id,
+                             std::string_view status,
+                             float progress) {
+    strm_ << "{ " << TIME_STAMP << time(nullptr) << ", "
+          << KIND_DATA << ", " << FORMAT_RESTORE_STATUS << ", "
+          << RESTORE_ID << id << ", "
+          << STATUS << status << "\", "
+          << PROGRESS << progress << " }\n";
+    strm_.flush();
+}
+
+void monitor::tag_info(std::string_view name,
+                       std::string_view comment,
+                       std::string_view author,
+                       std::string_view created_at) {
+    // the comment is given by the user, thus it may contain the characters to be escaped
+    strm_ << "{ " << TIME_STAMP << time(nullptr) << ", "
+          << KIND_DATA << ", " << FORMAT_TAG << ", "
+          << TAG_NAME << escaped(name) << "\", "
+          << COMMENT << escaped(comment) << "\", "
+          << AUTHOR << escaped(author) << "\", "
+          << CREATED_AT << created_at << "\" }\n";
+    strm_.flush();
+}
+
+void monitor::export_file(std::size_t query,
+                          std::string_view file) {
+    strm_ << "{ " << TIME_STAMP << time(nullptr) << ", "
+          << KIND_DATA << ", " << FORMAT_EXPORT << ", "
+          << QUERY << query << ", "
+          << FILE_NAME << escaped(file) << "\" }\n";
+    strm_.flush();
+}
+
+void monitor::import_file(std::string_view file,
+                          std::uintmax_t bytes,
+                          std::uint64_t records,
+                          std::uint64_t elapsed_ms) {
+    strm_ << "{ " << TIME_STAMP << time(nullptr) << ", "
+          << KIND_DATA << ", " << FORMAT_IMPORT << ", "
+          << FILE_NAME << escaped(file) << "\", "
+          << BYTES << bytes << ", "
+          << RECORDS << records << ", "
+          << ELAPSED_TIME << elapsed_ms << ", "
+          << THROUGHPUT << bytes * 1000 / (elapsed_ms > 0 ? elapsed_ms : 1) << " }\n";
+    strm_.flush();
+}
+
+void monitor::import_failure(std::string_view file,
+                             reason rc,
+                             std::string_view message) {
+    // the message is given by the server, thus it may contain the characters to be escaped
+    strm_ << "{ " << TIME_STAMP << time(nullptr) << ", "
+          << KIND_DATA << ", " << FORMAT_IMPORT << ", "
+          << FILE_NAME << escaped(file) << "\", "
+          << REASON << to_string_view(rc) << "\", "
+          << MESSAGE << escaped(message) << "\" }\n";
+    strm_.flush();
+}
+
+void monitor::supervisor_event(std::string_view event,
+                               std::int64_t pid,
+                               std::size_t restarts,
+                               std::int64_t backoff_ms) {
+    strm_ << "{ " << TIME_STAMP << time(nullptr) << ", "
+          << KIND_DATA << ", " << FORMAT_SUPERVISOR << ", "
+          << EVENT << event << "\", "
+          << PID << pid << ", "
+          << RESTARTS << restarts << ", "
+          << BACKOFF << backoff_ms << " }\n";
+    strm_.flush();
+}
+
 }  // tateyama::monitor
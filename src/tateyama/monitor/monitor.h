@@ -40,6 +40,20 @@ public:
     void start();
     void finish(reason rc);
     void progress(float ratio);
+    void progress(float ratio,
+                  std::uintmax_t bytes,
+                  std::uintmax_t total_bytes,
+                  std::size_t files,
+                  std::size_t total_files,
+                  std::uintmax_t bytes_per_second);
+    void progress(float ratio,
+                  std::uintmax_t bytes,
+                  std::uintmax_t total_bytes,
+                  std::size_t files,
+                  std::size_t total_files,
+                  std::uintmax_t bytes_per_second,
+                  std::optional<std::uint64_t> eta_seconds,
+                  std::string_view file);
     void status(status stat);
     void session_info(std::string_view session_id,
                       std::string_view label,
@@ -65,6 +79,41 @@ public:
                      std::string_view key,
                      std::string_view value);
 
+    // backup
+    void file_copy(std::string_view file,
+                   std::string_view strategy,
+                   std::uintmax_t bytes);
+
+    // restore
+    void restore_status(std::uint64_t id,
+                        std::string_view status,
+                        float progress);
+
+    // tag
+    void tag_info(std::string_view name,
+                  std::string_view comment,
+                  std::string_view author,
+                  std::string_view created_at);
+
+    // export
+    void export_file(std::size_t query,
+                     std::string_view file);
+
+    // import
+    void import_file(std::string_view file,
+                     std::uintmax_t bytes,
+                     std::uint64_t records,
+                     std::uint64_t elapsed_ms);
+    void import_failure(std::string_view file,
+                        reason rc,
+                        std::string_view message);
+
+    // supervisor
+    void supervisor_event(std::string_view event,
+                          std::int64_t pid,
+                          std::size_t restarts,
+                          std::int64_t backoff_ms);
+
 private:
     std::ostream& strm_;
     bool is_filestream_;
@@ -19,6 +19,9 @@
 #include <cstdlib>
 #include <thread>
 #include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
 #include <unistd.h>
 #include <sys/wait.h>
 
@@ -30,10 +33,12 @@
 #include <tateyama/logging.h>
 
 #include "tateyama/server/status_info.h"
+#include "tateyama/server/diagnostic_request.h"
 #include "tateyama/transport/client_wire.h"
 #include "tateyama/tgctl/runtime_error.h"
 #include "tateyama/monitor/monitor.h"
 #include "process.h"
+#include "pid_watcher.h"
 
 DEFINE_string(conf, "", "the file name of the configuration");  // NOLINT
 DEFINE_string(monitor, "", "the file name to which monitoring info. is to be output");  // NOLINT
@@ -48,6 +53,15 @@ DEFINE_int32(timeout, -1, "timeout for tgctl shutdown, no timeout control takes
 DEFINE_bool(q, false, "do not display command execution results on the console");  // NOLINT
 DEFINE_bool(quiet, false, "do not display command execution results on the console");  // NOLINT
 
+// for supervised mode
+DEFINE_bool(supervise, false, "keep a supervisor process that relaunches tsurugidb when it exits abnormally");  // NOLINT for tgctl start
+DEFINE_string(supervisor_monitor, "", "the file name to which the supervisor events are appended");  // NOLINT for tgctl start
+
+// for placement of tsurugidb
+DEFINE_string(cpu_affinity, "", "cpus on which tsurugidb runs");  // NOLINT for tgctl_start()
+DEFINE_string(numa_memory_policy, "", "numa memory policy of tsurugidb, one of default, bind, preferred or interleave");  // NOLINT for tgctl_start()
+DEFINE_string(numa_nodes, "", "numa nodes for numa_memory_policy");  // NOLINT for tgctl_start()
+
 // for control and session
 DEFINE_bool(graceful, false, "graceful shutdown");  // NOLINT
 DEFINE_bool(forceful, false, "forceful shutdown");  // NOLINT
@@ -180,13 +194,34 @@ static void build_args(std::vector<std::string>& args, tateyama::framework::boot
     if (FLAGS_tpch) {
         args.emplace_back("--tpch");
     }
+    if (!FLAGS_cpu_affinity.empty()) {
+        args.emplace_back("--cpu_affinity");
+        args.emplace_back(FLAGS_cpu_affinity);
+    }
+    if (!FLAGS_numa_memory_policy.empty()) {
+        args.emplace_back("--numa_memory_policy");
+        args.emplace_back(FLAGS_numa_memory_policy);
+    }
+    if (!FLAGS_numa_nodes.empty()) {
+        args.emplace_back("--numa_nodes");
+        args.emplace_back(FLAGS_numa_nodes);
+    }
+}
+
+static boost::filesystem::path server_executable(const boost::filesystem::path& base_path) {
+    return base_path / boost::filesystem::path("libexec") / boost::filesystem::path(std::string(server_name_string));
 }
 
 static void wait_for_signal(int){
     while( 0 >= waitpid(-1, nullptr, WNOHANG) );
 }
 
-tgctl::return_code tgctl_start(const std::string& argv0, bool need_check, tateyama::framework::boot_mode mode) { //NOLINT(readability-function-cognitive-complexity)
+tgctl::return_code tgctl_start(const std::string& argv0, bool need_check, tateyama::framework::boot_mode mode) {
+    auto bst_conf = configuration::bootstrap_configuration::create_bootstrap_configuration(FLAGS_conf);
+    return tgctl_start(argv0, need_check, mode, bst_conf);
+}
+
+tgctl::return_code tgctl_start(const std::string& argv0, bool need_check, tateyama::framework::boot_mode mode, configuration::bootstrap_configuration& bst_conf) { //NOLINT(readability-function-cognitive-complexity)
     std::unique_ptr<monitor::monitor> monitor_output{};
 
     if (!FLAGS_monitor.empty() && need_check) {
@@ -195,11 +230,11 @@ tgctl::return_code tgctl_start(const std::string& argv0, bool need_check, tateya
     }
     auto rtnv = tgctl::return_code::ok;
     auto reason = monitor::reason::absent;
-    auto bst_conf = configuration::bootstrap_configuration::create_bootstrap_configuration(FLAGS_conf);
 
     if (bst_conf.valid()) {
         if (!FLAGS_start_mode.empty()) {
             if (FLAGS_start_mode == "force") {
+                stop_supervisor(bst_conf.lock_file());
                 auto file_mutex = std::make_unique<proc_mutex>(bst_conf.lock_file(), false);
                 if (rtnv = tgctl_kill(file_mutex.get(), bst_conf); rtnv != tgctl::return_code::ok) {
                     std::cerr << "cannot tgctl kill before start\n" << std::flush;
@@ -243,8 +278,7 @@ tgctl::return_code tgctl_start(const std::string& argv0, bool need_check, tateya
         if (signal(SIGCHLD, wait_for_signal) == SIG_ERR) {  // NOLINT  #define SIG_ERR  ((__sighandler_t) -1) in a system header file
             std::cerr << "cannot register signal handler\n" << std::flush;
         }
-        std::string server_name(server_name_string);
-        auto exec = base_path / boost::filesystem::path("libexec") / boost::filesystem::path(server_name);
+        auto exec = server_executable(base_path);
         std::vector<std::string> args{};
         build_args(args, mode);
         boost::process::child cld(exec, boost::process::args (args));
@@ -575,6 +609,8 @@ tgctl::return_code tgctl_shutdown_kill(bool force, bool status_output) { //NOLIN
                     }
                     return tgctl::return_code::ok;
                 }
+                // the supervisor must not relaunch the tsurugidb being stopped
+                stop_supervisor(bst_conf.lock_file());
                 auto file_mutex = std::make_unique<proc_mutex>(bst_conf.lock_file(), false);
                 if (force) {
                     rtnv = tgctl_kill(file_mutex.get(), bst_conf);
@@ -635,6 +671,177 @@ tgctl::return_code tgctl_shutdown_kill(bool force, bool status_output) { //NOLIN
     return rtnv;
 }
 
+tateyama::framework::boot_mode boot_mode_from_flags() {
+    if (FLAGS_maintenance_server) {
+        return tateyama::framework::boot_mode::maintenance_server;
+    }
+    if (FLAGS_quiesce) {
+        return tateyama::framework::boot_mode::quiescent_server;
+    }
+    return tateyama::framework::boot_mode::database_server;
+}
+
+static std::int64_t elapsed_ms(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count();
+}
+
+tgctl::return_code tgctl_restart(const std::string& argv0) { //NOLINT(readability-function-cognitive-complexity)
+    std::unique_ptr<monitor::monitor> monitor_output{};
+
+    if (!FLAGS_monitor.empty()) {
+        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
+        monitor_output->start();
+    }
+    auto finish = [&monitor_output](monitor::reason reason) {
+        if (monitor_output) {
+            monitor_output->finish(reason);
+        }
+    };
+
+    // the configuration is resolved once and used for both the shutdown and the start
+    auto bst_conf = configuration::bootstrap_configuration::create_bootstrap_configuration(FLAGS_conf);
+    if (!bst_conf.valid() || bst_conf.get_configuration() == nullptr) {
+        if (!FLAGS_quiet) {
+            std::cout << "restart was not performed, as there is no valid configuration file.\n" << std::flush;
+        }
+        finish(monitor::reason::not_found);
+        return tgctl::return_code::err;
+    }
+    if (FLAGS_graceful && FLAGS_forceful) {
+        std::cout << "restart was not performed, as both forceful and graceful options specified\n" << std::flush;
+        finish(monitor::reason::invalid_argument);
+        return tgctl::return_code::err;
+    }
+
+    // validate the server executable before stopping the running one
+    boost::filesystem::path exec{};
+    try {
+        exec = server_executable(get_base_path(argv0));
+    } catch (std::exception &e) {
+        std::cerr << e.what() << '\n' << std::flush;
+        finish(monitor::reason::not_found);
+        return tgctl::return_code::err;
+    }
+    if (!boost::filesystem::is_regular_file(exec) || access(exec.string().c_str(), X_OK) != 0) {
+        if (!FLAGS_quiet) {
+            std::cout << "restart was not performed, as " << exec.string() << " is not an executable file.\n" << std::flush;
+        }
+        finish(monitor::reason::not_found);
+        return tgctl::return_code::err;
+    }
+
+    auto mode = boot_mode_from_flags();
+    auto quiet_previous = FLAGS_quiet;
+    auto monitor_previous = FLAGS_monitor;
+    auto state = status_check_internal(bst_conf);
+    if (state == status_check_result::no_file ||
+        state == status_check_result::not_locked ||
+        state == status_check_result::deactivated) {
+        // nothing to stop, thus just start the server
+        FLAGS_quiet = true;
+        FLAGS_monitor = "";
+        auto rtnv = tgctl_start(argv0, true, mode, bst_conf);
+        FLAGS_quiet = quiet_previous;
+        FLAGS_monitor = monitor_previous;
+        if (rtnv != tgctl::return_code::ok) {
+            if (!FLAGS_quiet) {
+                std::cout << "could not restart " << server_name_string << ", as " << server_name_string << " failed to start.\n" << std::flush;
+            }
+            finish(monitor::reason::initialization);
+            return rtnv;
+        }
+        if (!FLAGS_quiet) {
+            std::cout << "successfully launched " << server_name_string << ", as no " << server_name_string << " was running.\n" << std::flush;
+        }
+        finish(monitor::reason::absent);
+        return rtnv;
+    }
+    if (state != status_check_result::activated) {
+        if (!FLAGS_quiet) {
+            std::cout << "restart was not performed, as " << server_name_string << " is neither running nor stopped.\n" << std::flush;
+        }
+        finish(monitor::reason::invalid_status);
+        return tgctl::return_code::err;
+    }
+
+    std::chrono::steady_clock::time_point shutdown_requested{};
+    std::chrono::steady_clock::time_point exited{};
+    // the supervisor, if any, is stopped so as not to take the restart for a crash, and is relaunched afterwards
+    bool supervised = stop_supervisor(bst_conf.lock_file());
+    try {
+        auto file_mutex = std::make_unique<proc_mutex>(bst_conf.lock_file(), false);
+        auto pid = file_mutex->pid(false);
+        if (pid == 0) {
+            throw tgctl::runtime_error(monitor::reason::ambiguous, "contents of the file (" + file_mutex->name() + ") cannot be used");
+        }
+        pid_watcher watcher(pid);
+        auto status_info = std::make_unique<server::status_info_bridge>(bst_conf.digest());
+
+        auto shutdown_type = FLAGS_graceful ? tateyama::status_info::shutdown_type::graceful : tateyama::status_info::shutdown_type::forceful;
+        shutdown_requested = std::chrono::steady_clock::now();
+        if (!status_info->request_shutdown(shutdown_type)) {
+            if (!FLAGS_quiet) {
+                std::cout << "restart was not performed, as shutdown is already requested.\n" << std::flush;
+            }
+            finish(monitor::reason::invalid_status);
+            return tgctl::return_code::err;
+        }
+        status_info = nullptr;  // detach from the shared memory, which will be removed by the exiting server
+
+        std::chrono::milliseconds timeout{static_cast<std::int64_t>(sleep_time_unit_shutdown * check_count_shutdown)};
+        if (FLAGS_timeout > 0) {
+            timeout = std::chrono::milliseconds(1000L * FLAGS_timeout);
+        } else if (FLAGS_timeout == 0) {
+            timeout = std::chrono::milliseconds(-1);  // no timeout
+        }
+        if (!watcher.wait_for_exit(timeout)) {
+            if (!FLAGS_quiet) {
+                std::cout << "could not restart " << server_name_string << ", as shutdown is still in progress after "
+                          << timeout.count() / 1000 << " seconds.\n" << std::flush;
+            }
+            finish(monitor::reason::timeout);
+            return tgctl::return_code::err;
+        }
+        exited = std::chrono::steady_clock::now();
+    } catch (tgctl::runtime_error &e) {
+        if (!FLAGS_quiet) {
+            std::cout << "restart was not performed, as " << e.what() << ".\n" << std::flush;
+        }
+        finish(e.code());
+        return tgctl::return_code::err;
+    }
+
+    // launch the replacement with the same arguments as tgctl start
+    FLAGS_quiet = true;
+    FLAGS_monitor = "";
+    auto rtnv = tgctl_start(argv0, true, mode, bst_conf);
+    FLAGS_quiet = quiet_previous;
+    FLAGS_monitor = monitor_previous;
+    auto activated = std::chrono::steady_clock::now();
+
+    if (rtnv != tgctl::return_code::ok) {
+        if (!FLAGS_quiet) {
+            std::cout << "could not restart " << server_name_string << ", as " << server_name_string
+                      << " has stopped but failed to start again.\n" << std::flush;
+        }
+        finish(monitor::reason::initialization);
+        return rtnv;
+    }
+    if (supervised && !launch_supervisor(argv0, mode, bst_conf)) {
+        if (!FLAGS_quiet) {
+            std::cout << "could not relaunch the supervisor, " << server_name_string << " is running without supervision.\n" << std::flush;
+        }
+    }
+    if (!FLAGS_quiet) {
+        std::cout << "successfully restarted " << server_name_string << ", unavailable for "
+                  << elapsed_ms(shutdown_requested, activated) << " ms (shutdown "
+                  << elapsed_ms(shutdown_requested, exited) << " ms, start "
+                  << elapsed_ms(exited, activated) << " ms).\n" << std::flush;
+    }
+    finish(monitor::reason::absent);
+    return rtnv;
+}
+
 tgctl::return_code tgctl_status() {
     std::unique_ptr<monitor::monitor> monitor_output{};
 
@@ -724,27 +931,79 @@ tgctl::return_code tgctl_status() {
     return rtnv;
 }
 
-static pid_t get_pid() {
-    auto bst_conf = configuration::bootstrap_configuration::create_bootstrap_configuration(FLAGS_conf);
+static pid_t get_pid(configuration::bootstrap_configuration& bst_conf) {
     if (bst_conf.valid()) {
         if (auto conf = bst_conf.get_configuration(); conf != nullptr) {
             auto file_mutex = std::make_unique<proc_mutex>(bst_conf.lock_file(), false);
-            while (true) {
+            // the pid is written to the file just after the file is locked, thus it should not take long
+            for (std::size_t i = 0; i < check_count_startup; i++) {
                 if (auto pid = file_mutex->pid(); pid != 0) {
                     return pid;
                 }
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                usleep(sleep_time_unit_regular * 1000);
             }
+            throw tgctl::runtime_error(monitor::reason::timeout, "cannot get the pid of " + std::string(server_name_string));
         }
         throw tgctl::runtime_error(monitor::reason::internal, "error in create_configuration");
     }
     throw tgctl::runtime_error(monitor::reason::internal, "cannot find any valid configuration file");
 }
+static pid_t get_pid() {
+    auto bst_conf = configuration::bootstrap_configuration::create_bootstrap_configuration(FLAGS_conf);
+    return get_pid(bst_conf);
+}
+
+// returns the file of diagnostics written by tsurugidb for the token, or an empty path if it does not exist yet
+static std::filesystem::path find_diagnostic_file(const std::filesystem::path& lock_file, std::uint32_t token) {
+    auto prefix = lock_file.stem().string() + std::string(server::diagnostic_file_infix);
+    auto suffix = server::diagnostic_file_suffix(token);
+    std::error_code ec{};
+    for (const auto& entry : std::filesystem::directory_iterator(lock_file.parent_path(), ec)) {
+        auto name = entry.path().filename().string();
+        if (name.rfind(prefix, 0) == 0 && name.length() > suffix.length() &&
+            name.compare(name.length() - suffix.length(), suffix.length(), suffix) == 0) {
+            return entry.path();
+        }
+    }
+    return {};
+}
 
 tgctl::return_code tgctl_diagnostic() {
     try {
-        kill(get_pid(), SIGHUP);
-        return tgctl::return_code::ok;
+        auto bst_conf = configuration::bootstrap_configuration::create_bootstrap_configuration(FLAGS_conf);
+        auto pid = get_pid(bst_conf);
+
+        // tsurugidb writes the diagnostics to a file whose name contains the token sent with the signal,
+        // which is random so that neither another tgctl nor a file left by an earlier request is confused with this request
+        std::uint32_t token = 0;
+        std::random_device device{};
+        while (token == 0) {
+            token = static_cast<std::uint32_t>(device());
+        }
+        union sigval value{};
+        value.sival_int = static_cast<int>(token);
+        if (sigqueue(pid, server::diagnostic_request_signal(), value) != 0) {
+            throw tgctl::runtime_error(monitor::reason::internal, "cannot send a signal to " + std::string(server_name_string));
+        }
+
+        std::size_t check_count = check_count_startup;
+        if (FLAGS_timeout > 0) {
+            check_count = (1000L * FLAGS_timeout) / sleep_time_unit_regular;  // in mS
+        } else if(FLAGS_timeout == 0) {
+            check_count = INT64_MAX;  // practically infinite time
+        }
+        for (std::size_t i = 0; i < check_count; i++) {
+            if (auto file = find_diagnostic_file(bst_conf.lock_file(), token); !file.empty()) {
+                std::ifstream strm(file);
+                std::cout << strm.rdbuf() << std::flush;
+                strm.close();
+                std::filesystem::remove(file);
+                return tgctl::return_code::ok;
+            }
+            usleep(sleep_time_unit_regular * 1000);
+        }
+        std::cerr << "could not get the diagnostics within " << (sleep_time_unit_regular * check_count) / 1000 << " seconds\n" << std::flush;
+        return tgctl::return_code::err;
     } catch (tgctl::runtime_error &e) {
         std::cerr << e.what() << '\n' << std::flush;
         return tgctl::return_code::err;
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdint>
+#include <thread>
+#include <poll.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace tateyama::process {
+
+/**
+ * @brief watches a process (not necessarily a child) until it exits
+ * @details uses pidfd where the kernel supports it, and falls back to polling with kill(pid, 0) otherwise.
+ */
+class pid_watcher {
+public:
+    explicit pid_watcher(pid_t pid) : pid_(pid) {
+#ifdef SYS_pidfd_open
+        fd_ = static_cast<int>(syscall(SYS_pidfd_open, pid_, 0));
+#endif
+    }
+    ~pid_watcher() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    pid_watcher(pid_watcher const& other) = delete;
+    pid_watcher& operator=(pid_watcher const& other) = delete;
+    pid_watcher(pid_watcher&& other) noexcept = delete;
+    pid_watcher& operator=(pid_watcher&& other) noexcept = delete;
+
+    /**
+     * @brief wait for the process to exit
+     * @param timeout the maximum time to wait, a negative value means no timeout
+     * @return true if the process has exited, false if the timeout has expired
+     */
+    bool wait_for_exit(std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (true) {
+            if (!alive()) {
+                return true;
+            }
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (timeout.count() >= 0 && remaining.count() <= 0) {
+                return false;
+            }
+            if (fd_ >= 0) {
+                struct pollfd pfd{fd_, POLLIN, 0};
+                int wait_ms = (timeout.count() < 0) ? -1 : static_cast<int>(std::min(static_cast<std::int64_t>(remaining.count()), static_cast<std::int64_t>(INT_MAX)));
+                if (auto rv = poll(&pfd, 1, wait_ms); rv > 0) {
+                    return true;
+                }
+                // rv == 0 (timeout) or EINTR, both of which are checked at the top of the loop
+                continue;
+            }
+            auto wait_ms = polling_interval_ms;
+            if (timeout.count() >= 0) {
+                wait_ms = std::min(wait_ms, static_cast<std::int64_t>(remaining.count()));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(wait_ms));
+        }
+    }
+
+    /**
+     * @brief returns whether the process is alive
+     */
+    [[nodiscard]] bool alive() const {
+        return kill(pid_, 0) == 0 || errno == EPERM;
+    }
+
+    /**
+     * @brief returns whether pidfd is used to watch the process
+     */
+    [[nodiscard]] bool use_pidfd() const noexcept {
+        return fd_ >= 0;
+    }
+
+    [[nodiscard]] pid_t pid() const noexcept {
+        return pid_;
+    }
+
+private:
+    pid_t pid_;
+    int fd_{-1};
+    static constexpr std::int64_t polling_interval_ms = 10;
+};
+
+}  // tateyama::process
@@ -74,14 +74,14 @@ class proc_mutex {
     void lock() {
         std::unique_lock<std::mutex> lock(mtx_);
 
+        // truncates the file after the lock is acquired, not to erase the pid written by the process holding the lock
+        if (flock(fd_, LOCK_EX | LOCK_NB) != 0) {  // NOLINT
+            throw tgctl::runtime_error(monitor::reason::internal, "cannot lock the lock file");
+        }
+        owner_ = true;
         if (ftruncate(fd_, 0) < 0) {
             throw tgctl::runtime_error(monitor::reason::internal, "cannot truncate the lock file");
         }
-        if (flock(fd_, LOCK_EX | LOCK_NB) == 0) {  // NOLINT
-            owner_ = true;
-            return;
-        }
-        throw tgctl::runtime_error(monitor::reason::internal, "cannot lock the lock file");
     }
     void unlock(bool has_lock = false) const {
         std::unique_lock<std::mutex> lock(mtx_, std::defer_lock);
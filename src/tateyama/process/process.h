@@ -36,12 +36,18 @@
 namespace tateyama::process {
 
     tgctl::return_code tgctl_start(const std::string& argv0, bool need_check, tateyama::framework::boot_mode mode = tateyama::framework::boot_mode::database_server);
+    tgctl::return_code tgctl_start(const std::string& argv0, bool need_check, tateyama::framework::boot_mode mode, configuration::bootstrap_configuration& bst_conf);
+    tgctl::return_code tgctl_start_supervised(const std::string& argv0, tateyama::framework::boot_mode mode = tateyama::framework::boot_mode::database_server);
+    tgctl::return_code tgctl_restart(const std::string& argv0);
     tgctl::return_code tgctl_status();
     tgctl::return_code tgctl_kill(proc_mutex* file_mutex, configuration::bootstrap_configuration& bst_conf);
     tgctl::return_code tgctl_shutdown_kill(bool force, bool status_output = true);
     tgctl::return_code tgctl_diagnostic();
     tgctl::return_code tgctl_pid();
     bool is_running();
+    tateyama::framework::boot_mode boot_mode_from_flags();
+    bool launch_supervisor(const std::string& argv0, tateyama::framework::boot_mode mode, configuration::bootstrap_configuration& bst_conf);
+    bool stop_supervisor(const std::filesystem::path& lock_file);
 
     static boost::filesystem::path get_base_path(const std::string& argv0) {
         boost::filesystem::path path_for_this{};
@@ -0,0 +1,291 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <gflags/gflags.h>
+
+#include "tateyama/server/status_info.h"
+#include "tateyama/transport/client_wire.h"
+#include "tateyama/tgctl/runtime_error.h"
+#include "tateyama/monitor/monitor.h"
+#include "process.h"
+#include "pid_watcher.h"
+
+DECLARE_string(conf);
+DECLARE_string(monitor);
+DECLARE_string(start_mode);
+DECLARE_bool(quiet);
+DECLARE_string(supervisor_monitor);
+
+namespace tateyama::process {
+
+constexpr std::string_view server_name_string = "tsurugidb";
+constexpr std::int64_t supervisor_backoff_initial_ms = 1000;
+constexpr std::int64_t supervisor_backoff_max_ms = 60000;
+constexpr std::int64_t supervisor_stable_run_ms = 60000;     // the backoff is reset if tsurugidb has run longer than this
+constexpr std::size_t supervisor_max_consecutive_failures = 5;
+constexpr std::chrono::milliseconds supervisor_check_interval{100};
+constexpr std::chrono::milliseconds supervisor_stop_timeout{10000};
+
+static volatile std::sig_atomic_t supervisor_stop_requested = 0;  // NOLINT
+
+static void supervisor_stop_handler(int) {
+    supervisor_stop_requested = 1;
+}
+
+static std::filesystem::path supervisor_file(const std::filesystem::path& lock_file, std::string_view suffix) {
+    auto name = lock_file.stem().string();
+    name += suffix;
+    return lock_file.parent_path() / std::filesystem::path(name);
+}
+
+// returns the pid of the process holding the lock of the file, or 0 if no process holds the lock
+static pid_t locked_by(const std::filesystem::path& file) {
+    proc_mutex mutex(file, false, false);
+    if (mutex.check() != proc_mutex::lock_state::locked) {
+        return 0;
+    }
+    try {
+        return mutex.pid(false);
+    } catch (std::filesystem::filesystem_error &e) {
+        return 0;
+    }
+}
+
+bool stop_supervisor(const std::filesystem::path& lock_file) {
+    auto pid = locked_by(supervisor_file(lock_file, "-supervisor.pid"));
+    if (pid == 0 || pid == getpid()) {
+        return false;
+    }
+    pid_watcher watcher(pid);
+    if (kill(pid, SIGTERM) != 0) {
+        return false;
+    }
+    if (!watcher.wait_for_exit(supervisor_stop_timeout)) {
+        std::cerr << "the supervisor (pid " << pid << ") did not stop within "
+                  << supervisor_stop_timeout.count() / 1000 << " seconds\n" << std::flush;
+    }
+    return true;
+}
+
+enum class server_exit {
+    shutdown,    // the lock file has been removed by tsurugidb itself
+    crashed,     // the lock file remains unlocked
+    taken_over,  // another tsurugidb has been launched by someone else
+};
+
+static server_exit examine_exit(configuration::bootstrap_configuration& bst_conf) {
+    proc_mutex file_mutex(bst_conf.lock_file(), false, false);
+    switch (file_mutex.check()) {
+    case proc_mutex::lock_state::no_file:
+        return server_exit::shutdown;
+    case proc_mutex::lock_state::locked:
+        return server_exit::taken_over;
+    default:
+        return server_exit::crashed;
+    }
+}
+
+// removes what the crashed tsurugidb has left, in the same way as tgctl kill does
+static void cleanup(configuration::bootstrap_configuration& bst_conf) {
+    unlink(bst_conf.lock_file().c_str());
+    try {
+        auto status_info = std::make_unique<server::status_info_bridge>(bst_conf.digest());
+        status_info->apply_shm_entry(tateyama::common::wire::session_wire_container::remove_shm_entry);
+        status_info->force_delete();
+    } catch (tgctl::runtime_error &e) {
+        // the shared memory for status_info does not exist, thus nothing to remove
+    }
+}
+
+// returns false if stop has been requested during the sleep
+static bool sleep_unless_stopped(std::int64_t ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (supervisor_stop_requested) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::min(supervisor_check_interval, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now())));
+    }
+    return supervisor_stop_requested == 0;
+}
+
+static void supervise(const std::string& argv0, tateyama::framework::boot_mode mode, configuration::bootstrap_configuration& bst_conf, pid_t server_pid, monitor::monitor& events) {  //NOLINT(readability-function-cognitive-complexity)
+    // the relaunch must neither kill the running one nor output to the console and the monitor of tgctl start
+    FLAGS_quiet = true;
+    FLAGS_monitor = "";
+    FLAGS_start_mode = "";
+
+    std::size_t restarts = 0;
+    std::size_t failures = 0;
+    std::int64_t backoff_ms = 0;
+    events.supervisor_event("started", server_pid, restarts, backoff_ms);
+    while (true) {
+        auto launched = std::chrono::steady_clock::now();
+        {
+            pid_watcher watcher(server_pid);
+            while (!supervisor_stop_requested && !watcher.wait_for_exit(supervisor_check_interval));
+        }
+        if (supervisor_stop_requested) {
+            events.supervisor_event("stopped", server_pid, restarts, 0);
+            return;
+        }
+        switch (examine_exit(bst_conf)) {
+        case server_exit::shutdown:
+            events.supervisor_event("shutdown", server_pid, restarts, 0);
+            return;
+        case server_exit::taken_over:
+            events.supervisor_event("taken_over", server_pid, restarts, 0);
+            return;
+        case server_exit::crashed:
+            break;
+        }
+        events.supervisor_event("crashed", server_pid, restarts, 0);
+        cleanup(bst_conf);
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - launched).count() >= supervisor_stable_run_ms) {
+            backoff_ms = 0;
+        }
+
+        while (true) {
+            events.supervisor_event("relaunching", server_pid, restarts, backoff_ms);
+            if (!sleep_unless_stopped(backoff_ms)) {
+                events.supervisor_event("stopped", 0, restarts, 0);
+                return;
+            }
+            backoff_ms = (backoff_ms == 0) ? supervisor_backoff_initial_ms : std::min(backoff_ms * 2, supervisor_backoff_max_ms);
+            restarts++;
+            tgctl_start(argv0, true, mode, bst_conf);
+            // tsurugidb may be alive even if its launch has not been confirmed in time
+            if (auto pid = locked_by(bst_conf.lock_file()); pid != 0) {
+                server_pid = pid;
+                failures = 0;
+                events.supervisor_event("relaunched", server_pid, restarts, 0);
+                break;
+            }
+            failures++;
+            events.supervisor_event("relaunch_failed", 0, restarts, backoff_ms);
+            if (failures >= supervisor_max_consecutive_failures) {
+                events.supervisor_event("gave_up", 0, restarts, 0);
+                return;
+            }
+            if (examine_exit(bst_conf) == server_exit::crashed) {
+                cleanup(bst_conf);
+            }
+        }
+    }
+}
+
+bool launch_supervisor(const std::string& argv0, tateyama::framework::boot_mode mode, configuration::bootstrap_configuration& bst_conf) {
+    auto server_pid = locked_by(bst_conf.lock_file());
+    if (server_pid == 0) {
+        return false;
+    }
+
+    // the child notifies the parent through the pipe after it has locked the pid file for the supervisor
+    int ready[2];  // NOLINT(cppcoreguidelines-avoid-c-arrays, modernize-avoid-c-arrays)
+    if (pipe(ready) != 0) {  // NOLINT(cppcoreguidelines-pro-bounds-array-to-pointer-decay)
+        return false;
+    }
+    auto pid = fork();
+    if (pid < 0) {
+        close(ready[0]);
+        close(ready[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(ready[0]);
+        setsid();  // not to be affected by signals sent to the terminal of tgctl
+        // not to hold the terminal or the pipe of tgctl, e.g. x=$(tgctl start --supervise), while the supervisor is running
+        if (int null_fd = open("/dev/null", O_RDWR | O_CLOEXEC); null_fd >= 0) {  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg, hicpp-signed-bitwise)
+            dup2(null_fd, STDIN_FILENO);
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+            close(null_fd);
+        }
+        int rv = EXIT_FAILURE;
+        {
+            std::unique_ptr<proc_mutex> mutex{};
+            try {
+                mutex = std::make_unique<proc_mutex>(supervisor_file(bst_conf.lock_file(), "-supervisor.pid"));
+                mutex->lock();
+                mutex->fill_contents();
+            } catch (tgctl::runtime_error &e) {
+                close(ready[1]);
+                _exit(EXIT_FAILURE);
+            }
+            if (signal(SIGTERM, supervisor_stop_handler) == SIG_ERR ||  // NOLINT  #define SIG_ERR  ((__sighandler_t) -1) in a system header file
+                signal(SIGINT, supervisor_stop_handler) == SIG_ERR) {   // NOLINT
+                close(ready[1]);
+                _exit(EXIT_FAILURE);
+            }
+            auto monitor_file = FLAGS_supervisor_monitor.empty() ? supervisor_file(bst_conf.lock_file(), "-supervisor.log").string() : FLAGS_supervisor_monitor;
+            std::ofstream strm(monitor_file, std::ios_base::out | std::ios_base::app);
+            monitor::monitor events(strm);
+
+            char c = 'r';
+            if (write(ready[1], &c, 1) == 1) {
+                rv = EXIT_SUCCESS;
+            }
+            close(ready[1]);
+            if (rv == EXIT_SUCCESS) {
+                supervise(argv0, mode, bst_conf, server_pid, events);
+            }
+        }  // the pid file is removed here
+        _exit(rv);
+    }
+    close(ready[1]);
+    char c{};
+    auto rv = read(ready[0], &c, 1);
+    close(ready[0]);
+    return rv == 1;
+}
+
+tgctl::return_code tgctl_start_supervised(const std::string& argv0, tateyama::framework::boot_mode mode) {
+    auto bst_conf = configuration::bootstrap_configuration::create_bootstrap_configuration(FLAGS_conf);
+    if (bst_conf.valid() && bst_conf.get_configuration() != nullptr) {
+        if (auto pid = locked_by(supervisor_file(bst_conf.lock_file(), "-supervisor.pid")); pid != 0) {
+            if (!FLAGS_quiet) {
+                std::cout << "could not launch " << server_name_string << ", as a supervisor (pid " << pid << ") is already running.\n" << std::flush;
+            }
+            return tgctl::return_code::err;
+        }
+    }
+    // tgctl_start() reports the configuration error, if any
+    if (auto rtnv = tgctl_start(argv0, true, mode, bst_conf); rtnv != tgctl::return_code::ok) {
+        return rtnv;
+    }
+    if (!launch_supervisor(argv0, mode, bst_conf)) {
+        if (!FLAGS_quiet) {
+            std::cout << "could not launch the supervisor, " << server_name_string << " is running without supervision.\n" << std::flush;
+        }
+        return tgctl::return_code::err;
+    }
+    if (!FLAGS_quiet) {
+        std::cout << "the supervisor is watching " << server_name_string << ".\n" << std::flush;
+    }
+    return tgctl::return_code::ok;
+}
+
+}  // tateyama::process
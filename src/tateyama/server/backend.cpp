@@ -45,6 +45,9 @@
 #include "utils.h"
 #include "logging.h"
 #include "glog_helper.h"
+#include "placement_helper.h"
+#include "memory_helper.h"
+#include "diagnostic_dumper.h"
 #ifdef ENABLE_ALTIMETER
 #include <altimeter/logger.h>
 #include "tateyama/altimeter/altimeter_helper.h"
@@ -63,6 +66,9 @@ DEFINE_bool(force, false, "an option for tgctl, do not use here");  // NOLINT  d
 DEFINE_bool(no_keep_backup, false, "an option for tgctl, do not use here");  // NOLINT  dummy
 DEFINE_bool(keep_backup, true, "an option for tgctl, do not use here");  // NOLINT  dummy obsolete
 DEFINE_string(start_mode, "", "start mode, only force is valid");  // NOLINT  dummy
+DEFINE_string(cpu_affinity, "", "cpus on which tsurugidb runs, overrides cpu_affinity in the system section");  // NOLINT
+DEFINE_string(numa_memory_policy, "", "numa memory policy, overrides numa_memory_policy in the system section");  // NOLINT
+DEFINE_string(numa_nodes, "", "numa nodes for numa_memory_policy, overrides numa_nodes in the system section");  // NOLINT
 
 namespace tateyama::server {
 
@@ -71,14 +77,6 @@ struct endpoint_context {
     std::unordered_map<std::string, std::string> options_{};
 };
 
-// for diagnostic resource
-static std::shared_ptr<tateyama::diagnostic::resource::diagnostic_resource> diagnostic_resource_body{};  // NOLINT
-static void sighup_handler([[maybe_unused]] int sig) {
-    if (diagnostic_resource_body) {
-        diagnostic_resource_body->print_diagnostics(std::cerr);
-    }
-}
-
 static int backend_main(int argc, char **argv) {
     // command arguments
     gflags::SetUsageMessage("tateyama database server");
@@ -102,6 +100,19 @@ static int backend_main(int argc, char **argv) {
         LOG(ERROR) << e.what();
         exit(1);
     }
+    // cpu and memory placement must be done before any thread is created
+    if (!setup_placement(conf.get(), FLAGS_cpu_affinity, FLAGS_numa_memory_policy, FLAGS_numa_nodes)) {
+        LOG(ERROR) << "Starting server failed due to an error in cpu or numa placement.";
+        exit(1);
+    }
+    // the signals requesting diagnostics are received by the diagnostics thread through signalfd, thus they must be blocked in every thread
+    if (!diagnostic_dumper::block_signal()) {
+        LOG(ERROR) << "cannot block the signals for diagnostics";
+    }
+    if (!setup_memory_lock(conf.get())) {
+        LOG(ERROR) << "Starting server failed due to an error in locking memory.";
+        exit(1);
+    }
 #ifdef ENABLE_ALTIMETER
     auto altimeter_object = std::make_unique<tateyama::altimeter::altimeter_helper>(conf.get());
     bool altimeter_wellness = true;
@@ -172,9 +183,12 @@ static int backend_main(int argc, char **argv) {
     if (!tgsv.setup()) {
         status_info->whole(tateyama::status_info::state::boot_error);
         // detailed message must have been logged in the components where setup error occurs
+        report_memory_lock_failure(conf.get());
         LOG(ERROR) << "Starting server failed due to errors in setting up server application framework.";
         exit(1);
     }
+    // huge pages and prefaulting for the memory allocated in setup(), so that the first requests do not take page faults
+    setup_memory_backing(conf.get());
 #ifdef ENABLE_ALTIMETER
     if (!altimeter_wellness) {
         tgsv.shutdown();
@@ -222,10 +236,11 @@ static int backend_main(int argc, char **argv) {
     }
 
     // diagnostic
-    diagnostic_resource_body = tgsv.find_resource<tateyama::diagnostic::resource::diagnostic_resource>();
+    auto diagnostic_resource_body = tgsv.find_resource<tateyama::diagnostic::resource::diagnostic_resource>();
     diagnostic_resource_body->add_print_callback("sharksfin", sharksfin::print_diagnostics);
-    if (signal(SIGHUP, sighup_handler) == SIG_ERR) {  // NOLINT  #define SIG_ERR  ((__sighandler_t) -1) in a system header file
-        LOG(ERROR) << "cannot register signal handler";
+    auto diagnostics = std::make_unique<diagnostic_dumper>(diagnostic_resource_body, mutex_file.parent_path(), mutex_file.stem().string());
+    if (!diagnostics->start()) {
+        LOG(ERROR) << "cannot start the thread for diagnostics";
     }
 
     if (FLAGS_load) {
@@ -250,6 +265,7 @@ static int backend_main(int argc, char **argv) {
     // termination process
     LOG(INFO) << "exiting";
     status_info->whole(tateyama::status_info::state::deactivating);
+    diagnostics = nullptr;
     tgsv.shutdown();
 #ifdef ENABLE_ALTIMETER
     altimeter_object->shutdown();
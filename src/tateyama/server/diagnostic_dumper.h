@@ -0,0 +1,221 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+#include <glog/logging.h>
+#include <tateyama/diagnostic/resource/diagnostic_resource.h>
+
+#include "diagnostic_request.h"
+
+namespace tateyama::server {
+
+/**
+ * @brief dumps diagnostics on request from a dedicated thread
+ * @details the signals are received through signalfd, thus the diagnostics are printed outside of the signal context.
+ * On diagnostic_request_signal() sent with sigqueue(3) by tgctl diagnostic, the output is written to
+ * "<prefix>-diagnostic-<timestamp>-<token>.txt" in the directory, which tgctl removes once it has read it.
+ * The files left by the requests abandoned by tgctl are removed on the later requests and at startup.
+ * On SIGHUP sent by kill(1), the output is printed to the standard error as before.
+ */
+class diagnostic_dumper {
+public:
+    diagnostic_dumper(std::shared_ptr<tateyama::diagnostic::resource::diagnostic_resource> body, std::filesystem::path directory, std::string prefix)
+        : body_(std::move(body)), directory_(std::move(directory)), prefix_(std::move(prefix)) {
+    }
+    ~diagnostic_dumper() {
+        stop();
+        if (signal_fd_ >= 0) {
+            close(signal_fd_);
+        }
+        if (event_fd_ >= 0) {
+            close(event_fd_);
+        }
+    }
+
+    diagnostic_dumper(diagnostic_dumper const& other) = delete;
+    diagnostic_dumper& operator=(diagnostic_dumper const& other) = delete;
+    diagnostic_dumper(diagnostic_dumper&& other) noexcept = delete;
+    diagnostic_dumper& operator=(diagnostic_dumper&& other) noexcept = delete;
+
+    /**
+     * @brief blocks SIGHUP and diagnostic_request_signal() in the calling thread
+     * @details must be called before any thread is created, so that every thread inherits the signal mask
+     * and the signals are left pending until they are read from the signalfd.
+     * @return true if the signals have been blocked successfully
+     */
+    static bool block_signal() {
+        auto mask = signals();
+        return pthread_sigmask(SIG_BLOCK, &mask, nullptr) == 0;
+    }
+
+    /**
+     * @brief starts the thread that dumps diagnostics
+     * @return true if the thread has been started successfully
+     */
+    bool start() {
+        remove_files(std::filesystem::file_time_type::max());
+        auto mask = signals();
+        if (signal_fd_ = signalfd(-1, &mask, SFD_CLOEXEC); signal_fd_ < 0) {
+            LOG(ERROR) << "cannot create signalfd for diagnostics: " << strerror(errno);
+            return false;
+        }
+        if (event_fd_ = eventfd(0, EFD_CLOEXEC); event_fd_ < 0) {
+            LOG(ERROR) << "cannot create eventfd for diagnostics: " << strerror(errno);
+            return false;
+        }
+        thread_ = std::thread([this]{ run(); });
+        return true;
+    }
+
+    /**
+     * @brief stops the thread, which is also done in the destructor
+     */
+    void stop() {
+        if (thread_.joinable()) {
+            std::uint64_t one = 1;
+            if (write(event_fd_, &one, sizeof(one)) != sizeof(one)) {
+                LOG(ERROR) << "cannot notify the diagnostics thread to stop: " << strerror(errno);
+            }
+            thread_.join();
+        }
+    }
+
+private:
+    std::shared_ptr<tateyama::diagnostic::resource::diagnostic_resource> body_;
+    std::filesystem::path directory_;
+    std::string prefix_;
+    int signal_fd_{-1};
+    int event_fd_{-1};
+    std::thread thread_{};
+
+    // a file not read by tgctl for this duration is of a request it has abandoned, as tgctl polls the file frequently
+    static constexpr auto abandoned_after = std::chrono::minutes(1);
+
+    static sigset_t signals() {
+        sigset_t mask{};
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGHUP);
+        sigaddset(&mask, diagnostic_request_signal());
+        return mask;
+    }
+
+    void run() {
+        std::array<struct pollfd, 2> fds{{{signal_fd_, POLLIN, 0}, {event_fd_, POLLIN, 0}}};
+        while (true) {
+            if (poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                LOG(ERROR) << "diagnostics thread exits due to an error in poll: " << strerror(errno);
+                return;
+            }
+            if ((fds.at(1).revents & POLLIN) != 0) {  // NOLINT(hicpp-signed-bitwise)
+                return;
+            }
+            if ((fds.at(0).revents & POLLIN) != 0) {  // NOLINT(hicpp-signed-bitwise)
+                struct signalfd_siginfo info{};
+                if (read(signal_fd_, &info, sizeof(info)) != sizeof(info)) {
+                    continue;
+                }
+                if (static_cast<int>(info.ssi_signo) == diagnostic_request_signal() && info.ssi_code == SI_QUEUE) {
+                    remove_files(std::filesystem::file_time_type::clock::now() - abandoned_after);
+                    dump(static_cast<std::uint32_t>(info.ssi_int));
+                } else if (info.ssi_signo == SIGHUP) {
+                    print_header(std::cerr);
+                    body_->print_diagnostics(std::cerr);
+                }
+            }
+        }
+    }
+
+    static std::string timestamp() {
+        auto now = std::chrono::system_clock::now();
+        auto tt = std::chrono::system_clock::to_time_t(now);
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+        struct tm tm{};
+        localtime_r(&tt, &tm);
+        std::ostringstream strm{};
+        strm << std::put_time(&tm, "%Y%m%d-%H%M%S") << '.' << std::setw(3) << std::setfill('0') << ms;
+        return strm.str();
+    }
+
+    static void print_header(std::ostream& strm) {
+        strm << "diagnostics of tsurugidb (pid " << getpid() << ") at " << timestamp() << '\n';
+    }
+
+    // removes the files of diagnostics, including the temporary ones, last written before the time
+    void remove_files(std::filesystem::file_time_type before) {
+        auto prefix = prefix_ + std::string(diagnostic_file_infix);
+        std::error_code ec{};
+        for (const auto& entry : std::filesystem::directory_iterator(directory_, ec)) {
+            auto name = entry.path().filename().string();
+            if (name.rfind(prefix, 0) != 0) {
+                continue;
+            }
+            std::error_code time_ec{};
+            if (auto time = std::filesystem::last_write_time(entry.path(), time_ec); !time_ec && time < before) {
+                std::filesystem::remove(entry.path(), time_ec);
+            }
+        }
+    }
+
+    void dump(std::uint32_t token) {
+        auto name = prefix_ + std::string(diagnostic_file_infix) + timestamp() + diagnostic_file_suffix(token);
+
+        // written to a temporary file and renamed, so that the file appears only when it is complete
+        auto file = directory_ / std::filesystem::path(name);
+        auto tmp = file;
+        tmp += ".tmp";
+        {
+            std::ofstream strm(tmp, std::ios_base::out | std::ios_base::trunc);
+            if (!strm) {
+                LOG(ERROR) << "cannot create the file for diagnostics: " << tmp.string();
+                return;
+            }
+            print_header(strm);
+            body_->print_diagnostics(strm);
+        }
+        std::error_code ec{};
+        std::filesystem::rename(tmp, file, ec);
+        if (ec) {
+            LOG(ERROR) << "cannot rename the file for diagnostics to " << file.string() << ": " << ec.message();
+            return;
+        }
+        LOG(INFO) << "diagnostics has been written to " << file.string();
+    }
+};
+
+}  // tateyama::server
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace tateyama::server {
+
+/**
+ * @brief the infix of the files of diagnostics, which follows the stem of the pid file
+ */
+static constexpr std::string_view diagnostic_file_infix = "-diagnostic-";
+
+/**
+ * @brief returns the realtime signal by which tgctl diagnostic requests diagnostics
+ * @details the token identifying the request is sent as the value of the signal. Unlike SIGHUP,
+ * realtime signals are queued, thus the requests made at the same time are not merged into one.
+ */
+inline int diagnostic_request_signal() noexcept {
+    return SIGRTMIN + 1;  // NOLINT(hicpp-signed-bitwise)
+}
+
+/**
+ * @brief returns the end of the name of the file into which the diagnostics requested with the token are written
+ */
+inline std::string diagnostic_file_suffix(std::uint32_t token) {
+    std::array<char, 16> buf{};
+    std::snprintf(buf.data(), buf.size(), "-%08x.txt", token);  // NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    return {buf.data()};
+}
+
+}  // tateyama::server
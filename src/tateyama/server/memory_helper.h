@@ -0,0 +1,347 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <glog/logging.h>
+#include <tateyama/api/configuration.h>
+
+#include "logging.h"
+
+namespace tateyama::server {
+
+/**
+ * @brief a memory region read from /proc/self/maps
+ */
+struct memory_region {
+    std::uintptr_t begin{};
+    std::uintptr_t end{};
+    bool accessible{};
+    bool writable{};
+    bool shared{};
+    std::string path{};
+};
+
+/**
+ * @brief parses a line of /proc/self/maps
+ * @param line the line such as "7f00a0000000-7f00a4000000 rw-s 00000000 00:1a 123 /dev/shm/tsurugi"
+ * @return the memory region, or std::nullopt if the line is malformed
+ */
+inline std::optional<memory_region> parse_maps_line(std::string_view line) {
+    auto next_field = [&line]() {
+        while (!line.empty() && line.front() == ' ') {
+            line.remove_prefix(1);
+        }
+        auto pos = line.find(' ');
+        auto field = line.substr(0, pos);
+        line = (pos == std::string_view::npos) ? std::string_view{} : line.substr(pos);
+        return field;
+    };
+    auto to_address = [](std::string_view str) -> std::optional<std::uintptr_t> {
+        if (str.empty() || str.length() > sizeof(std::uintptr_t) * 2) {
+            return std::nullopt;
+        }
+        std::uintptr_t value = 0;
+        for (auto c : str) {
+            std::uintptr_t digit{};
+            if (c >= '0' && c <= '9') {
+                digit = c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                digit = c - 'a' + 10;
+            } else {
+                return std::nullopt;
+            }
+            value = (value << 4U) | digit;
+        }
+        return value;
+    };
+
+    memory_region region{};
+    auto range = next_field();
+    auto hyphen = range.find('-');
+    if (hyphen == std::string_view::npos) {
+        return std::nullopt;
+    }
+    auto begin = to_address(range.substr(0, hyphen));
+    auto end = to_address(range.substr(hyphen + 1));
+    if (!begin || !end || begin.value() >= end.value()) {
+        return std::nullopt;
+    }
+    region.begin = begin.value();
+    region.end = end.value();
+
+    auto perms = next_field();
+    if (perms.length() != 4) {
+        return std::nullopt;
+    }
+    region.accessible = perms.substr(0, 3) != "---";
+    region.writable = perms[1] == 'w';
+    region.shared = perms[3] == 's';
+
+    next_field();  // offset
+    next_field();  // device
+    if (next_field().empty()) {  // inode
+        return std::nullopt;
+    }
+    while (!line.empty() && line.front() == ' ') {
+        line.remove_prefix(1);
+    }
+    region.path = std::string(line);
+    return region;
+}
+
+/**
+ * @brief selects the regions to which transparent huge pages are applied, of which prefaulted_region() tells those prefaulted
+ * @details they are the heap, i.e. [heap] and the private anonymous mappings, and the shared memory whose path begins with
+ * shm_prefix. A private anonymous mapping just above an inaccessible one is excluded, as it is the stack of a thread
+ * above its guard page, whose reservation must not be committed.
+ * @param regions the regions in the order of /proc/self/maps
+ * @param shm_prefix the prefix of the path of the shared memory, or empty for no shared memory
+ */
+inline std::vector<memory_region> backing_regions(const std::vector<memory_region>& regions, std::string_view shm_prefix) {
+    std::vector<memory_region> selected{};
+    const memory_region* previous = nullptr;
+    for (auto&& region : regions) {
+        bool heap = region.path == "[heap]";
+        if (region.path.empty() && !region.shared) {
+            bool above_guard = previous != nullptr && previous->end == region.begin && !previous->accessible;
+            heap = !above_guard;
+        }
+        bool shm = !shm_prefix.empty() && region.shared && region.path.rfind(shm_prefix, 0) == 0;
+        if (region.writable && (heap || shm)) {
+            selected.emplace_back(region);
+        }
+        previous = &region;
+    }
+    return selected;
+}
+
+/**
+ * @brief returns whether the region selected by backing_regions() is prefaulted
+ * @details only [heap] and the shared memory are, as a private anonymous mapping can be a reservation made with MAP_NORESERVE,
+ * such as an arena of an allocator, all of whose pages would be committed by prefaulting.
+ */
+inline bool prefaulted_region(const memory_region& region) {
+    return region.path == "[heap]" || region.shared;
+}
+
+/**
+ * @brief returns whether RLIMIT_MEMLOCK is enough for mlockall(MCL_CURRENT | MCL_FUTURE)
+ * @details as every allocation made after mlockall() counts against the limit and fails beyond it, the limit must cover
+ * all the memory tsurugidb can use, i.e. the physical memory, rather than what it uses at startup.
+ * @param limit the soft limit of RLIMIT_MEMLOCK
+ * @param physical_bytes the size of the physical memory
+ */
+inline bool memlock_limit_sufficient(rlim_t limit, std::uint64_t physical_bytes) {
+    return limit == RLIM_INFINITY || static_cast<std::uint64_t>(limit) >= physical_bytes;
+}
+
+/**
+ * @brief memory settings in the system section
+ */
+struct memory_settings {
+    bool memory_lock{};
+    bool transparent_huge_pages{};
+    bool prefault_memory{};
+};
+
+static memory_settings memory_settings_of(tateyama::api::configuration::whole* conf) {
+    auto* system_section = conf->get_section("system");
+    memory_settings settings{};
+    if (auto opt = system_section->get<bool>("memory_lock"); opt) {
+        settings.memory_lock = opt.value();
+    }
+    if (auto opt = system_section->get<bool>("transparent_huge_pages"); opt) {
+        settings.transparent_huge_pages = opt.value();
+    }
+    if (auto opt = system_section->get<bool>("prefault_memory"); opt) {
+        settings.prefault_memory = opt.value();
+    }
+    return settings;
+}
+
+static std::string memlock_limit_string() {
+    struct rlimit limit{};
+    if (getrlimit(RLIMIT_MEMLOCK, &limit) != 0) {
+        return "unknown";
+    }
+    if (limit.rlim_cur == RLIM_INFINITY) {
+        return "unlimited";
+    }
+    return std::to_string(limit.rlim_cur) + " bytes";
+}
+
+// returns VmLck in /proc/self/status in bytes
+static std::size_t locked_memory_bytes() {
+    std::ifstream status("/proc/self/status");
+    std::string line{};
+    while (std::getline(status, line)) {
+        if (line.rfind("VmLck:", 0) == 0) {
+            return std::strtoull(line.c_str() + std::strlen("VmLck:"), nullptr, 10) * 1024;
+        }
+    }
+    return 0;
+}
+
+// returns whether the process has CAP_IPC_LOCK in CapEff of /proc/self/status, with which RLIMIT_MEMLOCK does not apply
+static bool has_ipc_lock_capability() {
+    static constexpr unsigned int cap_ipc_lock = 14;
+    std::ifstream status("/proc/self/status");
+    std::string line{};
+    while (std::getline(status, line)) {
+        if (line.rfind("CapEff:", 0) == 0) {
+            return ((std::strtoull(line.c_str() + std::strlen("CapEff:"), nullptr, 16) >> cap_ipc_lock) & 1U) != 0;
+        }
+    }
+    return false;
+}
+
+// intended to be included from backend.cpp only once, and to be called before tgsv.setup()
+static bool setup_memory_lock(tateyama::api::configuration::whole* conf) {
+    auto settings = memory_settings_of(conf);
+    LOG(INFO) << system_config_prefix
+              << std::boolalpha
+              << "memory_lock: " << settings.memory_lock << ", "
+              << "whether the memory of tsurugidb is locked into RAM.";
+    LOG(INFO) << system_config_prefix
+              << std::boolalpha
+              << "transparent_huge_pages: " << settings.transparent_huge_pages << ", "
+              << "whether transparent huge pages are requested for the heap and the shared memory.";
+    LOG(INFO) << system_config_prefix
+              << std::boolalpha
+              << "prefault_memory: " << settings.prefault_memory << ", "
+              << "whether the heap and the shared memory are prefaulted at startup.";
+    if (!settings.memory_lock) {
+        return true;
+    }
+    // mlockall() would succeed with a low limit, making the allocations fail later while the server is running
+    if (struct rlimit limit{}; !has_ipc_lock_capability() && getrlimit(RLIMIT_MEMLOCK, &limit) == 0) {
+        auto physical_bytes = static_cast<std::uint64_t>(sysconf(_SC_PHYS_PAGES)) * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+        if (!memlock_limit_sufficient(limit.rlim_cur, physical_bytes)) {
+            LOG(ERROR) << "memory_lock needs RLIMIT_MEMLOCK (" << memlock_limit_string() << ") to be unlimited or at least the physical memory ("
+                       << physical_bytes << " bytes), as all the memory allocated while the server is running is locked as well"
+                       << "; raise the limit with 'ulimit -l unlimited' or LimitMEMLOCK=infinity, or set memory_lock to false";
+            return false;
+        }
+    }
+    // MCL_FUTURE makes the memory allocated in tgsv.setup() locked (and thus faulted in) as well
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        auto err = errno;
+        if (err == ENOMEM || err == EPERM || err == EAGAIN) {
+            LOG(ERROR) << "failed to lock memory, as RLIMIT_MEMLOCK (" << memlock_limit_string() << ") is too low: " << strerror(err)
+                       << "; raise the limit with 'ulimit -l unlimited' or LimitMEMLOCK=infinity, or set memory_lock to false";
+        } else {
+            LOG(ERROR) << "failed to lock memory: " << strerror(err);
+        }
+        return false;
+    }
+    return true;
+}
+
+// called when tgsv.setup() fails, as an allocation exceeding RLIMIT_MEMLOCK fails under MCL_FUTURE
+static void report_memory_lock_failure(tateyama::api::configuration::whole* conf) {
+    if (memory_settings_of(conf).memory_lock) {
+        LOG(ERROR) << "memory_lock is enabled, the error might be caused by RLIMIT_MEMLOCK (" << memlock_limit_string() << ") being too low; "
+                   << "locked " << locked_memory_bytes() << " bytes so far";
+    }
+}
+
+// intended to be included from backend.cpp only once, and to be called just after tgsv.setup()
+static void setup_memory_backing(tateyama::api::configuration::whole* conf) {
+    auto settings = memory_settings_of(conf);
+    if (!settings.transparent_huge_pages && !settings.prefault_memory) {
+        if (settings.memory_lock) {
+            LOG(INFO) << "locked " << locked_memory_bytes() << " bytes of memory (RLIMIT_MEMLOCK: " << memlock_limit_string() << ")";
+        }
+        return;
+    }
+
+    std::string shm_prefix{};
+    if (auto database_name_opt = conf->get_section("ipc_endpoint")->get<std::string>("database_name"); database_name_opt) {
+        shm_prefix = "/dev/shm/" + database_name_opt.value();
+    }
+    std::vector<memory_region> regions{};
+    {
+        std::ifstream maps("/proc/self/maps");
+        std::string line{};
+        while (std::getline(maps, line)) {
+            if (auto region = parse_maps_line(line); region) {
+                regions.emplace_back(std::move(region.value()));
+            }
+        }
+    }
+
+    // madvise() fails with ENOMEM rather than faults if a region has been unmapped by another thread in the meantime
+    std::size_t huge_page_bytes = 0;
+    std::size_t prefaulted_bytes = 0;
+    std::size_t skipped_bytes = 0;
+#ifdef MADV_POPULATE_WRITE
+    bool prefault = settings.prefault_memory;
+#else
+    bool prefault = false;
+    if (settings.prefault_memory) {
+        LOG(WARNING) << "prefault_memory is ignored, as MADV_POPULATE_WRITE is unavailable";
+    }
+#endif
+    for (auto&& region : backing_regions(regions, shm_prefix)) {
+        auto* addr = reinterpret_cast<void*>(region.begin);  // NOLINT(performance-no-int-to-ptr)
+        std::size_t length = region.end - region.begin;
+
+        if (settings.transparent_huge_pages) {
+            if (madvise(addr, length, MADV_HUGEPAGE) == 0) {
+                huge_page_bytes += length;
+            } else if (errno != ENOMEM) {
+                LOG(WARNING) << "madvise(MADV_HUGEPAGE) failed for " << std::hex << region.begin << "-" << region.end << std::dec << ": " << strerror(errno);
+            }
+        }
+#ifdef MADV_POPULATE_WRITE
+        if (prefault && !prefaulted_region(region)) {
+            skipped_bytes += length;
+        } else if (prefault) {
+            if (madvise(addr, length, MADV_POPULATE_WRITE) == 0) {
+                prefaulted_bytes += length;
+            } else if (errno == EINVAL) {
+                LOG(WARNING) << "prefault_memory is ignored, as MADV_POPULATE_WRITE is unavailable in this kernel";
+                prefault = false;
+            } else if (errno != ENOMEM) {
+                LOG(WARNING) << "madvise(MADV_POPULATE_WRITE) failed for " << std::hex << region.begin << "-" << region.end << std::dec << ": " << strerror(errno);
+            }
+        }
+#endif
+    }
+    if (settings.transparent_huge_pages) {
+        LOG(INFO) << "requested transparent huge pages for " << huge_page_bytes << " bytes of memory";
+    }
+    if (settings.prefault_memory) {
+        LOG(INFO) << "prefaulted " << prefaulted_bytes << " bytes of memory, skipping " << skipped_bytes << " bytes of the private anonymous mappings";
+    }
+    if (settings.memory_lock) {
+        LOG(INFO) << "locked " << locked_memory_bytes() << " bytes of memory (RLIMIT_MEMLOCK: " << memlock_limit_string() << ")";
+    }
+}
+
+}  // tateyama::server
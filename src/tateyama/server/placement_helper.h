@@ -0,0 +1,193 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+
+#include <glog/logging.h>
+#include <tateyama/api/configuration.h>
+
+#include "logging.h"
+
+namespace tateyama::server {
+
+// the largest number of numa nodes supported by the kernel, i.e. 1 << CONFIG_NODES_SHIFT at most
+constexpr std::size_t max_numa_nodes = 1024;
+
+/**
+ * @brief parses an id list such as "0-3,8,10-11", which is used for cpu and numa node sets
+ * @param list the list to be parsed
+ * @param limit the upper bound of the ids, exclusive, which is checked before a range is expanded
+ * @return the ids in ascending order, or std::nullopt if the list is malformed or has an id not less than limit
+ */
+inline std::optional<std::set<std::size_t>> parse_id_list(std::string_view list, std::size_t limit) {
+    std::set<std::size_t> ids{};
+    auto to_number = [limit](std::string_view str) -> std::optional<std::size_t> {
+        if (str.empty() || str.length() > 9) {
+            return std::nullopt;
+        }
+        std::size_t value = 0;
+        for (auto c : str) {
+            if (c < '0' || c > '9') {
+                return std::nullopt;
+            }
+            value = value * 10 + static_cast<std::size_t>(c - '0');
+        }
+        if (value >= limit) {
+            return std::nullopt;
+        }
+        return value;
+    };
+    while (!list.empty()) {
+        auto pos = list.find(',');
+        auto element = list.substr(0, pos);
+        list = (pos == std::string_view::npos) ? std::string_view{} : list.substr(pos + 1);
+        while (!element.empty() && element.front() == ' ') {
+            element.remove_prefix(1);
+        }
+        while (!element.empty() && element.back() == ' ') {
+            element.remove_suffix(1);
+        }
+        if (auto hyphen = element.find('-'); hyphen != std::string_view::npos) {
+            auto first = to_number(element.substr(0, hyphen));
+            auto last = to_number(element.substr(hyphen + 1));
+            if (!first || !last || first.value() > last.value()) {
+                return std::nullopt;
+            }
+            for (auto i = first.value(); i <= last.value(); i++) {
+                ids.emplace(i);
+            }
+        } else {
+            auto id = to_number(element);
+            if (!id) {
+                return std::nullopt;
+            }
+            ids.emplace(id.value());
+        }
+    }
+    if (ids.empty()) {
+        return std::nullopt;
+    }
+    return ids;
+}
+
+/**
+ * @brief returns the set_mempolicy(2) mode corresponding to the name
+ * @return the mode, or std::nullopt if the name is unknown
+ */
+inline std::optional<int> numa_memory_policy_mode(std::string_view name) {
+    if (name.empty() || name == "default") {
+        return MPOL_DEFAULT;
+    }
+    if (name == "bind") {
+        return MPOL_BIND;
+    }
+    if (name == "preferred") {
+        return MPOL_PREFERRED;
+    }
+    if (name == "interleave") {
+        return MPOL_INTERLEAVE;
+    }
+    return std::nullopt;
+}
+
+// intended to be included from backend.cpp only once, and to be called before any thread is created
+static bool setup_placement(tateyama::api::configuration::whole* conf,
+                            const std::string& cpu_affinity_flag,
+                            const std::string& numa_memory_policy_flag,
+                            const std::string& numa_nodes_flag) {
+    auto* system_section = conf->get_section("system");
+    auto value_of = [system_section](const std::string& flag, std::string_view key) {
+        if (!flag.empty()) {
+            return flag;
+        }
+        if (auto opt = system_section->get<std::string>(key); opt) {
+            return opt.value();
+        }
+        return std::string{};
+    };
+    auto cpu_affinity = value_of(cpu_affinity_flag, "cpu_affinity");
+    auto numa_memory_policy = value_of(numa_memory_policy_flag, "numa_memory_policy");
+    auto numa_nodes = value_of(numa_nodes_flag, "numa_nodes");
+
+    // cpu affinity, which is inherited by all threads created afterwards
+    if (!cpu_affinity.empty()) {
+        auto cpus = parse_id_list(cpu_affinity, CPU_SETSIZE);
+        if (!cpus) {
+            LOG(ERROR) << "invalid cpu_affinity: '" << cpu_affinity << "'";
+            return false;
+        }
+        cpu_set_t set{};
+        CPU_ZERO(&set);
+        for (auto cpu : cpus.value()) {
+            CPU_SET(cpu, &set);  // NOLINT
+        }
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            LOG(ERROR) << "failed to set cpu_affinity to '" << cpu_affinity << "': " << strerror(errno);
+            return false;
+        }
+    }
+    LOG(INFO) << system_config_prefix
+              << "cpu_affinity: \"" << cpu_affinity << "\", "
+              << "cpus on which tsurugidb runs, all cpus are used if empty.";
+
+    // numa memory policy, which is inherited by all threads created afterwards
+    auto mode = numa_memory_policy_mode(numa_memory_policy);
+    if (!mode) {
+        LOG(ERROR) << "invalid numa_memory_policy: '" << numa_memory_policy << "', must be one of default, bind, preferred or interleave";
+        return false;
+    }
+    if (mode.value() != MPOL_DEFAULT) {
+        auto nodes = parse_id_list(numa_nodes, max_numa_nodes);
+        if (!nodes) {
+            LOG(ERROR) << "numa_nodes must be specified properly when numa_memory_policy is '" << numa_memory_policy << "': '" << numa_nodes << "'";
+            return false;
+        }
+        constexpr std::size_t bits = sizeof(unsigned long) * CHAR_BIT;  // NOLINT(google-runtime-int)
+        auto max_node = *nodes->rbegin();
+        std::vector<unsigned long> mask((max_node / bits) + 1, 0);  // NOLINT(google-runtime-int)
+        for (auto node : nodes.value()) {
+            mask.at(node / bits) |= (1UL << (node % bits));
+        }
+        // the kernel regards the last bit of maxnode as unused
+        if (syscall(SYS_set_mempolicy, mode.value(), mask.data(), max_node + 2) != 0) {
+            LOG(ERROR) << "failed to set numa_memory_policy to '" << numa_memory_policy << "' on numa_nodes '" << numa_nodes << "': " << strerror(errno);
+            return false;
+        }
+    } else if (!numa_nodes.empty()) {
+        LOG(WARNING) << "numa_nodes is ignored as numa_memory_policy is default";
+    }
+    LOG(INFO) << system_config_prefix
+              << "numa_memory_policy: " << (numa_memory_policy.empty() ? "default" : numa_memory_policy) << ", "
+              << "memory allocation policy of tsurugidb.";
+    LOG(INFO) << system_config_prefix
+              << "numa_nodes: \"" << numa_nodes << "\", "
+              << "numa nodes used by numa_memory_policy.";
+    return true;
+}
+
+}  // tateyama::server
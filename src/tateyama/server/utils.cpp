@@ -18,11 +18,21 @@
 #include <vector>
 #include <fstream>
 #include <string>
+#include <string_view>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <algorithm>
 
 #include "gflags/gflags.h"
+#include "glog/logging.h"
 
 DEFINE_int32(dump_batch_size, 1024, "Batch size for dump");  //NOLINT
 DEFINE_int32(load_batch_size, 1024, "Batch size for load");  //NOLINT
+DEFINE_int32(table_parallelism, 0, "Number of tables loaded or dumped concurrently, 0 for the number of hardware threads");  //NOLINT
 
 namespace jogasaki::utils {
 
@@ -50,30 +60,114 @@ namespace jogasaki::utils {
         return dir;
     }
 
-    void
-    dump([[maybe_unused]] jogasaki::api::database& tgdb, std::string &location)
-    {
+    static constexpr std::string_view secondary_suffix = "_SECONDARY";
+
+    /**
+     * @brief groups the tables into chains processed one after another, the secondary index follows its primary table
+     * @details a table named XXX_SECONDARY is placed in the chain of XXX, and the chains are independent each other.
+     */
+    static std::vector<std::vector<std::string>> chains_of(const std::vector<std::string>& names) {
+        std::vector<std::vector<std::string>> chains{};
+        for (auto& name : names) {
+            if (name.length() > secondary_suffix.length() && name.compare(name.length() - secondary_suffix.length(), secondary_suffix.length(), secondary_suffix) == 0) {
+                auto primary = name.substr(0, name.length() - secondary_suffix.length());
+                auto it = std::find_if(chains.begin(), chains.end(), [&primary](auto& c){ return c.front() == primary; });
+                if (it != chains.end()) {
+                    it->emplace_back(name);
+                    continue;
+                }
+            }
+            chains.emplace_back(std::vector<std::string>{name});
+        }
+        return chains;
+    }
+
+    /**
+     * @brief applies the function to each table on at most FLAGS_table_parallelism threads
+     * @details the first exception thrown by the function is rethrown after all the threads have finished,
+     * and the tables not yet started by then are left unprocessed.
+     */
+    static void for_each_table(const std::vector<std::string>& names, std::string_view action, const std::function<void(const std::string&)>& func) {
+        auto chains = chains_of(names);
+        std::size_t parallelism = FLAGS_table_parallelism > 0 ? static_cast<std::size_t>(FLAGS_table_parallelism) : std::max(std::thread::hardware_concurrency(), 1U);
+        parallelism = std::min(parallelism, chains.size());
+
+        std::atomic<std::size_t> next{};
+        std::mutex mtx{};
+        std::exception_ptr error{};
+        auto worker = [&]() {
+            for (std::size_t i = next.fetch_add(1); i < chains.size(); i = next.fetch_add(1)) {
+                for (auto& table : chains.at(i)) {
+                    {
+                        std::unique_lock<std::mutex> lock(mtx);
+                        if (error) {
+                            return;
+                        }
+                    }
+                    try {
+                        auto begin = std::chrono::steady_clock::now();
+                        func(table);
+                        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+                        LOG(INFO) << action << " table " << table << " in " << ms << " ms";
+                    } catch (...) {
+                        std::unique_lock<std::mutex> lock(mtx);
+                        if (!error) {
+                            error = std::current_exception();
+                        }
+                        return;
+                    }
+                }
+            }
+        };
+
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads{};
+        for (std::size_t i = 1; i < parallelism; i++) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : threads) {
+            t.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+        LOG(INFO) << action << " " << names.size() << " tables in " << ms << " ms with " << parallelism << " threads";
+    }
+
+    static void dump_tables(jogasaki::api::database& tgdb, const std::vector<std::string>& names, std::string &location) {
         std::filesystem::path dir = prepare(location);
-        for (auto& table : tables) {
+        for_each_table(names, "dumped", [&tgdb, &dir](const std::string& table) {
             std::ofstream ofs((dir / (table+".tbldmp")).c_str());
             if (ofs.fail()) {
                 throw std::ios_base::failure("Failed to open file.");
             }
             tgdb.dump(ofs, table, FLAGS_dump_batch_size);
-        }
+        });
     }
 
-    void
-    load([[maybe_unused]] jogasaki::api::database& tgdb, std::string &location)
-    {
+    static void load_tables(jogasaki::api::database& tgdb, const std::vector<std::string>& names, std::string &location) {
         std::filesystem::path dir = prepare(location);
-        for (auto& table : tables) {
+        for_each_table(names, "loaded", [&tgdb, &dir](const std::string& table) {
             std::ifstream ifs((dir / (table+".tbldmp")).c_str());
             if (ifs.fail()) {
                 throw std::ios_base::failure("Failed to open file.");
             }
-            tgdb.load(ifs, table,  FLAGS_load_batch_size);
-        }
+            tgdb.load(ifs, table, FLAGS_load_batch_size);
+        });
+    }
+
+    void
+    dump(jogasaki::api::database& tgdb, std::string &location)
+    {
+        dump_tables(tgdb, tables, location);
+    }
+
+    void
+    load(jogasaki::api::database& tgdb, std::string &location)
+    {
+        load_tables(tgdb, tables, location);
     }
 
 
@@ -91,27 +185,13 @@ namespace jogasaki::utils {
     void
     dump_tpch(jogasaki::api::database& tgdb, std::string &location)
     {
-        std::filesystem::path dir = prepare(location);
-        for (auto& table : tpch_tables) {
-            std::ofstream ofs((dir / (table+".tbldmp")).c_str());
-            if (ofs.fail()) {
-                throw std::ios_base::failure("Failed to open file.");
-            }
-            tgdb.dump(ofs, table, FLAGS_dump_batch_size);
-        }
+        dump_tables(tgdb, tpch_tables, location);
     }
 
     void
     load_tpch(jogasaki::api::database& tgdb, std::string &location)
     {
-        std::filesystem::path dir = prepare(location);
-        for (auto& table : tpch_tables) {
-            std::ifstream ifs((dir / (table+".tbldmp")).c_str());
-            if (ifs.fail()) {
-                throw std::ios_base::failure("Failed to open file.");
-            }
-            tgdb.load(ifs, table, FLAGS_load_batch_size);
-        }
+        load_tables(tgdb, tpch_tables, location);
     }
 
 }  // jogasaki::utils
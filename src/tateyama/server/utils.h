@@ -20,6 +20,7 @@
 
 DECLARE_int32(dump_batch_size);  //NOLINT
 DECLARE_int32(load_batch_size);  //NOLINT
+DECLARE_int32(table_parallelism);  //NOLINT
 
 namespace jogasaki::utils {
 
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "tateyama/monitor/monitor.h"
+#include "record_reader.h"
+#include "sql_client.h"
+#include "sql.h"
+
+DEFINE_string(sql, "", "the queries exported by tgctl export, separated by semicolons");  // NOLINT
+DEFINE_string(dir, "", "the directory into which tsurugidb writes the files exported");  // NOLINT
+DEFINE_int64(max_records_per_file, 0, "the maximum number of records in each file exported, 0 means unlimited");  // NOLINT
+DECLARE_string(format);  // NOLINT  parquet or arrow for export
+DECLARE_int32(parallel);  // NOLINT
+DECLARE_string(label);  // NOLINT
+DECLARE_string(monitor);  // NOLINT
+
+namespace tateyama::sql {
+
+static constexpr std::string_view default_label = "tgctl export";
+
+static std::optional<::jogasaki::proto::sql::request::DumpOption> dump_option() {
+    ::jogasaki::proto::sql::request::DumpOption option{};
+    option.set_max_record_count_per_file(static_cast<std::uint64_t>(std::max(FLAGS_max_records_per_file, static_cast<std::int64_t>(0))));
+
+    // --format is shared with the other subcommands, whose default is not for export
+    if (gflags::GetCommandLineFlagInfoOrDie("format").is_default || FLAGS_format == "parquet") {
+        (void) option.mutable_parquet();
+        return option;
+    }
+    if (FLAGS_format == "arrow") {
+        (void) option.mutable_arrow();
+        return option;
+    }
+    return std::nullopt;
+}
+
+tgctl::return_code tgctl_export() {
+    std::unique_ptr<monitor::monitor> monitor_output{};
+
+    if (!FLAGS_monitor.empty()) {
+        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
+        monitor_output->start();
+    }
+
+    auto reason = monitor::reason::absent;
+    try {
+        auto queries = split_statements(FLAGS_sql);
+        auto option = dump_option();
+        if (queries.empty()) {
+            std::cerr << "could not export, as no query is given by --sql\n" << std::flush;
+            reason = monitor::reason::invalid_argument;
+        } else if (FLAGS_dir.empty()) {
+            std::cerr << "could not export, as the directory is not given by --dir\n" << std::flush;
+            reason = monitor::reason::invalid_argument;
+        } else if (!option) {
+            std::cerr << "could not export, as the format '" << FLAGS_format << "' is neither parquet nor arrow\n" << std::flush;
+            reason = monitor::reason::invalid_argument;
+        }
+        if (reason != monitor::reason::absent) {
+            if (monitor_output) {
+                monitor_output->finish(reason);
+            }
+            return tgctl::return_code::err;
+        }
+
+        // tsurugidb runs in another directory, the files of each query are placed in its own directory if there are several
+        auto directory = std::filesystem::absolute(FLAGS_dir);
+        std::vector<std::filesystem::path> directories{};
+        for (std::size_t i = 0; i < queries.size(); i++) {
+            directories.emplace_back(queries.size() > 1 ? directory / std::to_string(i + 1) : directory);
+            std::error_code ec{};
+            std::filesystem::create_directories(directories.back(), ec);
+            if (ec) {
+                std::cerr << "could not export, as the directory " << directories.back().string() << " cannot be created: " << ec.message() << '\n' << std::flush;
+                if (monitor_output) {
+                    monitor_output->finish(monitor::reason::io);
+                }
+                return tgctl::return_code::err;
+            }
+        }
+
+        // the sessions are opened one by one, as the credential may be asked on the console
+        std::size_t parallel = FLAGS_parallel > 0 ? std::min(static_cast<std::size_t>(FLAGS_parallel), queries.size()) : queries.size();
+        std::vector<std::unique_ptr<sql_client>> clients{};
+        for (std::size_t i = 0; i < parallel; i++) {
+            clients.emplace_back(std::make_unique<sql_client>());
+        }
+
+        std::atomic<std::size_t> next{};
+        std::mutex mtx{};
+        auto worker = [&](sql_client& client) {
+            for (std::size_t i = next.fetch_add(1); i < queries.size(); i = next.fetch_add(1)) {
+                std::vector<std::string> files{};
+                auto r = monitor::reason::absent;
+                std::string message{};
+                try {
+                    // a read only transaction sees the snapshot without being aborted by the others
+                    auto transaction = client.begin(::jogasaki::proto::sql::request::TransactionType::READ_ONLY,
+                                                    FLAGS_label.empty() ? default_label : FLAGS_label);
+                    try {
+                        files = client.dump(transaction, queries.at(i), directories.at(i).string(), option.value());
+                        client.commit(transaction);
+                    } catch (...) {
+                        client.rollback(transaction);
+                        throw;
+                    }
+                } catch (tgctl::runtime_error &ex) {
+                    r = ex.code();
+                    message = ex.what();
+                } catch (std::exception &ex) {
+                    r = monitor::reason::unknown;
+                    message = ex.what();
+                }
+
+                std::unique_lock<std::mutex> lock(mtx);
+                if (r != monitor::reason::absent) {
+                    std::cerr << "could not export the query '" << queries.at(i) << "', as " << message << '\n' << std::flush;
+                    if (reason == monitor::reason::absent) {
+                        reason = r;
+                    }
+                    continue;
+                }
+                for (auto&& f : files) {
+                    std::cout << f << '\n';
+                    if (monitor_output) {
+                        monitor_output->export_file(i + 1, f);
+                    }
+                }
+                std::cout << std::flush;
+            }
+        };
+
+        std::vector<std::thread> threads{};
+        for (std::size_t i = 1; i < parallel; i++) {
+            threads.emplace_back(worker, std::ref(*clients.at(i)));
+        }
+        worker(*clients.at(0));
+        for (auto&& t : threads) {
+            t.join();
+        }
+    } catch (tgctl::runtime_error &ex) {
+        std::cerr << "could not export, as " << ex.what() << '\n' << std::flush;
+        reason = ex.code();
+    }
+
+    if (monitor_output) {
+        monitor_output->finish(reason);
+    }
+    return reason == monitor::reason::absent ? tgctl::return_code::ok : tgctl::return_code::err;
+}
+
+}  // tateyama::sql
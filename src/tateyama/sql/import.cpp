@@ -0,0 +1,289 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glob.h>
+
+#include <gflags/gflags.h>
+
+#include "tateyama/monitor/monitor.h"
+#include "sql_client.h"
+#include "sql.h"
+
+DEFINE_string(table, "", "the table into which tgctl import loads the files");  // NOLINT
+DEFINE_string(files, "", "the Parquet or Arrow files loaded by tgctl import, which may contain wildcards");  // NOLINT
+DECLARE_int32(parallel);  // NOLINT
+DECLARE_string(label);  // NOLINT
+DECLARE_string(monitor);  // NOLINT
+
+namespace tateyama::sql {
+
+static constexpr std::string_view default_label = "tgctl import";
+
+// the requests on a session are limited by its slots, one of which is used to keep the session alive
+static constexpr std::size_t max_requests_per_session = 8;
+
+static constexpr double mebibytes = 1024.0 * 1024.0;
+
+/**
+ * @brief expands the wildcards in the patterns
+ * @return the files in the absolute paths, as they are read by tsurugidb, or std::nullopt if a pattern matches nothing
+ */
+static std::optional<std::vector<std::string>> expand(const std::vector<std::string>& patterns) {
+    std::vector<std::string> files{};
+    for (auto&& pattern : patterns) {
+        glob_t matched{};
+        auto rc = ::glob(pattern.c_str(), 0, nullptr, &matched);
+        if (rc != 0) {
+            globfree(&matched);
+            std::cerr << "could not import, as no file matches '" << pattern << "'\n" << std::flush;
+            return std::nullopt;
+        }
+        for (std::size_t i = 0; i < matched.gl_pathc; i++) {
+            auto file = std::filesystem::absolute(matched.gl_pathv[i]).string();  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            if (std::find(files.begin(), files.end(), file) == files.end()) {
+                files.emplace_back(std::move(file));
+            }
+        }
+        globfree(&matched);
+    }
+    return files;
+}
+
+static std::string delimited(std::string_view name) {
+    std::string rv{"\""};
+    for (auto c : name) {
+        if (c == '"') {
+            rv += '"';
+        }
+        rv += c;
+    }
+    rv += '"';
+    return rv;
+}
+
+// delimits each part of the table name, which can be qualified by the schema such as schema.table
+static std::string delimited_table_name(std::string_view name) {
+    std::string rv{};
+    while (true) {
+        auto dot = name.find('.');
+        rv += delimited(name.substr(0, dot));
+        if (dot == std::string_view::npos) {
+            return rv;
+        }
+        rv += '.';
+        name.remove_prefix(dot + 1);
+    }
+}
+
+/**
+ * @brief the insert statement loading the files, in which each column of the table is given by the file column of the same name
+ */
+class insert_statement {
+public:
+    explicit insert_statement(const ::jogasaki::proto::sql::response::DescribeTable::Success& table) {
+        std::string columns{};
+        std::string values{};
+        for (auto&& column : table.columns()) {
+            if (column.type_info_case() != ::jogasaki::proto::sql::common::Column::TypeInfoCase::kAtomType) {
+                throw tgctl::runtime_error(monitor::reason::invalid_argument, "the column " + column.name() + " is not of an atom type");
+            }
+            auto name = "p" + std::to_string(placeholders_.size());
+            if (!columns.empty()) {
+                columns += ", ";
+                values += ", ";
+            }
+            columns += delimited(column.name());
+            values += ":" + name;
+
+            auto& placeholder = placeholders_.emplace_back();
+            placeholder.set_name(name);
+            placeholder.set_atom_type(column.atom_type());
+            auto& parameter = parameters_.emplace_back();
+            parameter.set_name(name);
+            parameter.set_reference_column_name(column.name());
+        }
+        sql_ = "INSERT INTO " + delimited_table_name(FLAGS_table) + " (" + columns + ") VALUES (" + values + ")";
+    }
+
+    [[nodiscard]] const std::string& sql() const noexcept {
+        return sql_;
+    }
+    [[nodiscard]] const std::vector<::jogasaki::proto::sql::request::Placeholder>& placeholders() const noexcept {
+        return placeholders_;
+    }
+    [[nodiscard]] const std::vector<::jogasaki::proto::sql::request::Parameter>& parameters() const noexcept {
+        return parameters_;
+    }
+
+private:
+    std::string sql_{};
+    std::vector<::jogasaki::proto::sql::request::Placeholder> placeholders_{};
+    std::vector<::jogasaki::proto::sql::request::Parameter> parameters_{};
+};
+
+tgctl::return_code tgctl_import(const std::vector<std::string>& file_args) {
+    std::unique_ptr<monitor::monitor> monitor_output{};
+
+    if (!FLAGS_monitor.empty()) {
+        monitor_output = std::make_unique<monitor::monitor>(FLAGS_monitor);
+        monitor_output->start();
+    }
+
+    auto reason = monitor::reason::absent;
+    std::vector<std::unique_ptr<sql_client>> clients{};
+    std::vector<prepared_statement_handle> statements{};
+    try {
+        // the files expanded by the shell follow --files as the arguments
+        std::vector<std::string> patterns{};
+        if (!FLAGS_files.empty()) {
+            patterns.emplace_back(FLAGS_files);
+        }
+        patterns.insert(patterns.end(), file_args.begin(), file_args.end());
+        std::optional<std::vector<std::string>> files{};
+        if (FLAGS_table.empty()) {
+            std::cerr << "could not import, as the table is not given by --table\n" << std::flush;
+            reason = monitor::reason::invalid_argument;
+        } else if (patterns.empty()) {
+            std::cerr << "could not import, as no file is given by --files\n" << std::flush;
+            reason = monitor::reason::invalid_argument;
+        } else if (files = expand(patterns); !files) {
+            reason = monitor::reason::not_found;
+        }
+        if (reason != monitor::reason::absent) {
+            if (monitor_output) {
+                monitor_output->finish(reason);
+            }
+            return tgctl::return_code::err;
+        }
+
+        std::size_t parallel = FLAGS_parallel > 0 ? static_cast<std::size_t>(FLAGS_parallel) : std::max(std::thread::hardware_concurrency(), 1U);
+        parallel = std::min(parallel, files.value().size());
+
+        // the insert statement is prepared once in each session, as the prepared statement belongs to the session,
+        // and the sessions are opened one by one, as the credential may be asked on the console
+        std::size_t sessions = (parallel + max_requests_per_session - 1) / max_requests_per_session;
+        for (std::size_t i = 0; i < sessions; i++) {
+            clients.emplace_back(std::make_unique<sql_client>());
+        }
+        insert_statement statement{clients.at(0)->describe_table(FLAGS_table)};
+        for (auto&& client : clients) {
+            statements.emplace_back(client->prepare(statement.sql(), statement.placeholders()));
+        }
+
+        std::atomic<std::size_t> next{};
+        std::mutex mtx{};
+        std::size_t loaded_files{};
+        std::uint64_t loaded_records{};
+        auto worker = [&](std::size_t session) {
+            auto& client = *clients.at(session);
+            for (std::size_t i = next.fetch_add(1); i < files.value().size(); i = next.fetch_add(1)) {
+                const auto& file = files.value().at(i);
+                std::uint64_t records{};
+                auto r = monitor::reason::absent;
+                std::string message{};
+                auto begin = std::chrono::steady_clock::now();
+                try {
+                    // each file is loaded in a long transaction, which is not aborted by the other loads
+                    auto transaction = client.begin(::jogasaki::proto::sql::request::TransactionType::LONG,
+                                                    FLAGS_label.empty() ? default_label : FLAGS_label,
+                                                    {FLAGS_table});
+                    try {
+                        records = client.load(transaction, statements.at(session), statement.parameters(), {file});
+                        client.commit(transaction);
+                    } catch (...) {
+                        client.rollback(transaction);
+                        throw;
+                    }
+                } catch (tgctl::runtime_error &ex) {
+                    r = ex.code();
+                    message = ex.what();
+                } catch (std::exception &ex) {
+                    r = monitor::reason::unknown;
+                    message = ex.what();
+                }
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+                std::error_code ec{};
+                auto bytes = std::filesystem::file_size(file, ec);
+                if (ec) {
+                    bytes = 0;
+                }
+
+                std::unique_lock<std::mutex> lock(mtx);
+                if (r != monitor::reason::absent) {
+                    std::cerr << "could not import the file " << file << ", as " << message << '\n' << std::flush;
+                    if (monitor_output) {
+                        monitor_output->import_failure(file, r, message);
+                    }
+                    if (reason == monitor::reason::absent) {
+                        reason = r;
+                    }
+                    continue;
+                }
+                loaded_files++;
+                loaded_records += records;
+                auto seconds = static_cast<double>(elapsed) / 1000.0;
+                std::cout << std::fixed << std::setprecision(1)
+                          << "loaded " << file << ": " << records << " records, "
+                          << static_cast<double>(bytes) / mebibytes << " MiB in " << seconds << " s";
+                if (elapsed > 0) {
+                    std::cout << " (" << static_cast<double>(bytes) / mebibytes / seconds << " MiB/s)";
+                }
+                std::cout << '\n' << std::flush;
+                if (monitor_output) {
+                    monitor_output->import_file(file, bytes, records, static_cast<std::uint64_t>(elapsed));
+                }
+            }
+        };
+
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads{};
+        for (std::size_t i = 1; i < parallel; i++) {
+            threads.emplace_back(worker, i / max_requests_per_session);
+        }
+        worker(0);
+        for (auto&& t : threads) {
+            t.join();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << std::fixed << std::setprecision(1)
+                  << "imported " << loaded_files << " of " << files.value().size() << " files, "
+                  << loaded_records << " records in " << elapsed << " s\n" << std::flush;
+    } catch (tgctl::runtime_error &ex) {
+        std::cerr << "could not import, as " << ex.what() << '\n' << std::flush;
+        reason = ex.code();
+    }
+
+    for (std::size_t i = 0; i < statements.size(); i++) {
+        clients.at(i)->dispose(statements.at(i));
+    }
+    if (monitor_output) {
+        monitor_output->finish(reason);
+    }
+    return reason == monitor::reason::absent ? tgctl::return_code::ok : tgctl::return_code::err;
+}
+
+}  // tateyama::sql
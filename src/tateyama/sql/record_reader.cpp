@@ -0,0 +1,205 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cctype>
+#include <stdexcept>
+
+#include "record_reader.h"
+
+namespace tateyama::sql {
+
+// the entry headers of the value format
+constexpr static std::uint8_t header_embed_positive_int = 0x00U;  // 0 to 63
+constexpr static std::uint8_t header_embed_character = 0x40U;  // 1 to 64 bytes
+constexpr static std::uint8_t header_embed_row = 0x80U;  // 1 to 32 columns
+constexpr static std::uint8_t header_embed_array = 0xa0U;
+constexpr static std::uint8_t header_embed_negative_int = 0xc0U;  // -16 to -1
+constexpr static std::uint8_t header_embed_octet = 0xd0U;
+constexpr static std::uint8_t header_unknown = 0xe8U;  // null
+constexpr static std::uint8_t header_int = 0xe9U;
+constexpr static std::uint8_t header_character = 0xf0U;
+constexpr static std::uint8_t header_row = 0xf8U;
+constexpr static std::uint8_t header_end_of_contents = 0xffU;
+
+constexpr static std::size_t max_varint_bytes = 10;
+
+void record_reader::append(std::string_view chunk) {
+    if (position_ > 0 && position_ >= buffer_.size() / 2) {
+        buffer_.erase(0, position_);
+        position_ = 0;
+    }
+    buffer_.append(chunk);
+}
+
+bool record_reader::next(std::vector<column_value>& record) {
+    if (end_of_contents_ || position_ >= buffer_.size()) {
+        return false;
+    }
+    std::size_t pos = position_;
+    auto header = static_cast<std::uint8_t>(buffer_.at(pos++));
+    if (header == header_end_of_contents) {
+        position_ = pos;
+        end_of_contents_ = true;
+        return false;
+    }
+
+    std::uint64_t columns{};
+    if (header >= header_embed_row && header < header_embed_array) {
+        columns = header - header_embed_row + 1U;
+    } else if (header == header_row) {
+        auto count = read_uint(pos);
+        if (!count) {
+            return false;
+        }
+        columns = count.value();
+    } else {
+        throw std::runtime_error("the record does not begin with a row entry");
+    }
+
+    std::vector<column_value> values{};
+    for (std::uint64_t i = 0; i < columns; i++) {
+        auto value = read_value(pos);
+        if (!value) {
+            return false;
+        }
+        values.emplace_back(std::move(value.value()));
+    }
+    record = std::move(values);
+    position_ = pos;
+    return true;
+}
+
+std::optional<std::uint64_t> record_reader::read_uint(std::size_t& pos) const {
+    std::uint64_t value{};
+    for (std::size_t i = 0; i < max_varint_bytes; i++) {
+        if (pos >= buffer_.size()) {
+            return std::nullopt;
+        }
+        auto byte = static_cast<std::uint8_t>(buffer_.at(pos++));
+        value |= static_cast<std::uint64_t>(byte & 0x7fU) << (7U * i);
+        if ((byte & 0x80U) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("the variable length integer is too long");
+}
+
+std::optional<std::int64_t> record_reader::read_sint(std::size_t& pos) const {
+    auto value = read_uint(pos);
+    if (!value) {
+        return std::nullopt;
+    }
+    // zigzag encoding
+    auto v = value.value();
+    return static_cast<std::int64_t>(v >> 1U) ^ -static_cast<std::int64_t>(v & 1U);
+}
+
+std::optional<column_value> record_reader::read_value(std::size_t& pos) const {
+    if (pos >= buffer_.size()) {
+        return std::nullopt;
+    }
+    auto header = static_cast<std::uint8_t>(buffer_.at(pos++));
+
+    if (header < header_embed_character) {
+        return column_value{static_cast<std::int64_t>(header - header_embed_positive_int)};
+    }
+    if (header >= header_embed_negative_int && header < header_embed_octet) {
+        return column_value{static_cast<std::int64_t>(header - header_embed_negative_int) - 16};
+    }
+    std::uint64_t length{};
+    if (header >= header_embed_character && header < header_embed_row) {
+        length = header - header_embed_character + 1U;
+    } else if (header == header_character) {
+        auto l = read_uint(pos);
+        if (!l) {
+            return std::nullopt;
+        }
+        length = l.value();
+    } else if (header == header_unknown) {
+        return column_value{std::monostate{}};
+    } else if (header == header_int) {
+        auto v = read_sint(pos);
+        if (!v) {
+            return std::nullopt;
+        }
+        return column_value{v.value()};
+    } else {
+        throw std::runtime_error("the column of an unsupported type is found in the record");
+    }
+
+    if (buffer_.size() - pos < length) {
+        return std::nullopt;
+    }
+    std::string value = buffer_.substr(pos, length);
+    pos += length;
+    return column_value{std::move(value)};
+}
+
+static std::string trimmed(std::string_view text) {
+    std::size_t begin = 0;
+    std::size_t end = text.length();
+    while (begin < end && std::isspace(static_cast<unsigned char>(text.at(begin))) != 0) {
+        begin++;
+    }
+    while (end > begin && std::isspace(static_cast<unsigned char>(text.at(end - 1))) != 0) {
+        end--;
+    }
+    return std::string(text.substr(begin, end - begin));
+}
+
+std::vector<std::string> split_statements(std::string_view text) {
+    std::vector<std::string> statements{};
+    std::size_t begin = 0;
+    std::size_t pos = 0;
+    bool content = false;  // whether the statement has anything other than the white spaces and comments
+    auto emit = [&statements, &text, &content](std::size_t b, std::size_t e) {
+        if (content) {
+            statements.emplace_back(trimmed(text.substr(b, e - b)));
+        }
+        content = false;
+    };
+
+    while (pos < text.length()) {
+        char c = text.at(pos);
+        if (c == '\'' || c == '"') {
+            // a quote in the quoted text is escaped by doubling it, which is read as two quoted texts
+            auto close = text.find(c, pos + 1);
+            pos = (close == std::string_view::npos) ? text.length() : close + 1;
+            content = true;
+            continue;
+        }
+        if (text.substr(pos, 2) == "--" || text.substr(pos, 2) == "//") {
+            auto eol = text.find('\n', pos);
+            pos = (eol == std::string_view::npos) ? text.length() : eol + 1;
+            continue;
+        }
+        if (text.substr(pos, 2) == "/*") {
+            auto close = text.find("*/", pos + 2);
+            pos = (close == std::string_view::npos) ? text.length() : close + 2;
+            continue;
+        }
+        if (c == ';') {
+            emit(begin, pos);
+            begin = pos + 1;
+        } else if (std::isspace(static_cast<unsigned char>(c)) == 0) {
+            content = true;
+        }
+        pos++;
+    }
+    emit(begin, text.length());
+    return statements;
+}
+
+}  // tateyama::sql
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace tateyama::sql {
+
+/**
+ * @brief a column value of the records, std::monostate for null
+ */
+using column_value = std::variant<std::monostate, std::int64_t, std::string>;
+
+/**
+ * @brief reads the records sent through the result set wire
+ * @details the records are serialized by the SQL service in its value format, where each record is a row entry followed
+ * by its column entries. Only the types of the columns of the results tgctl receives, which are the integers and the
+ * character strings, are decoded, and the others are regarded as broken.
+ * A record may be split across the chunks, thus the bytes of the incomplete record are kept until the next chunk.
+ */
+class record_reader {
+public:
+    /**
+     * @brief appends a chunk received from the result set wire
+     */
+    void append(std::string_view chunk);
+
+    /**
+     * @brief reads the next record
+     * @param record the column values of the record read
+     * @return true if a record has been read, false if the record is not completed by the chunks appended
+     * @throws std::runtime_error if the record is broken
+     */
+    bool next(std::vector<column_value>& record);
+
+    /**
+     * @brief returns whether the end of contents has been read
+     */
+    [[nodiscard]] bool end_of_contents() const noexcept {
+        return end_of_contents_;
+    }
+
+    /**
+     * @brief returns whether any bytes remain, which have not been read as a record
+     */
+    [[nodiscard]] bool has_remaining() const noexcept {
+        return position_ < buffer_.size();
+    }
+
+private:
+    std::string buffer_{};
+    std::size_t position_{};
+    bool end_of_contents_{};
+
+    std::optional<std::uint64_t> read_uint(std::size_t& pos) const;
+    std::optional<std::int64_t> read_sint(std::size_t& pos) const;
+    std::optional<column_value> read_value(std::size_t& pos) const;
+};
+
+/**
+ * @brief splits the text into SQL statements at the semicolons which are not in quotes nor comments
+ * @return the statements with the surrounding white spaces removed, omitting those having only comments
+ */
+std::vector<std::string> split_statements(std::string_view text);
+
+}  // tateyama::sql
@@ -0,0 +1,249 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <variant>
+
+#include "tateyama/tgctl/runtime_error.h"
+#include "record_reader.h"
+#include "sql_client.h"
+
+namespace tateyama::sql {
+
+using response_type = ::jogasaki::proto::sql::response::Response;
+
+static void throw_error(const ::jogasaki::proto::sql::response::Error& error) {
+    std::string message = ::jogasaki::proto::sql::error::Code_Name(error.code());
+    if (!error.detail().empty()) {
+        message += " (";
+        message += error.detail();
+        message += ")";
+    }
+    throw tgctl::runtime_error(monitor::reason::server, message);
+}
+
+static void check_result_only(const response_type& response) {
+    if (response.response_case() != response_type::ResponseCase::kResultOnly) {
+        throw tgctl::runtime_error(monitor::reason::payload_broken, "the response is not a ResultOnly");
+    }
+    if (response.result_only().result_case() == ::jogasaki::proto::sql::response::ResultOnly::ResultCase::kError) {
+        throw_error(response.result_only().error());
+    }
+}
+
+static bool next_record(record_reader& reader, std::vector<column_value>& record) {
+    try {
+        return reader.next(record);
+    } catch (std::runtime_error &ex) {
+        throw tgctl::runtime_error(monitor::reason::payload_broken, ex.what());
+    }
+}
+
+sql_client::sql_client() : transport_(std::make_unique<tateyama::bootstrap::wire::transport>(tateyama::framework::service_id_sql)) {
+}
+
+sql_client::~sql_client() {
+    if (transport_) {
+        close();
+    }
+}
+
+void sql_client::close() {
+    transport_->close();
+    transport_ = nullptr;
+}
+
+response_type sql_client::send(::jogasaki::proto::sql::request::Request& request) {
+    auto slot_index = transport_->post(request);
+    if (!slot_index) {
+        throw tgctl::runtime_error(monitor::reason::internal, "could not send the request to the sql service");
+    }
+    return receive(slot_index.value());
+}
+
+response_type sql_client::receive(tateyama::common::wire::message_header::index_type slot_index) {
+    auto response = transport_->receive<response_type>(slot_index);
+    if (!response) {
+        throw tgctl::runtime_error(monitor::reason::payload_broken, "the response from the sql service is broken");
+    }
+    return response.value();
+}
+
+transaction_handle sql_client::begin(::jogasaki::proto::sql::request::TransactionType type,
+                                     std::string_view label,
+                                     const std::vector<std::string>& write_preserves) {
+    ::jogasaki::proto::sql::request::Request request{};
+    auto* option = request.mutable_begin()->mutable_option();
+    option->set_type(type);
+    option->set_label(std::string(label));
+    for (auto&& table : write_preserves) {
+        option->add_write_preserves()->set_table_name(table);
+    }
+    auto response = send(request);
+
+    if (response.response_case() != response_type::ResponseCase::kBegin) {
+        throw tgctl::runtime_error(monitor::reason::payload_broken, "the response is not a Begin");
+    }
+    if (response.begin().result_case() == ::jogasaki::proto::sql::response::Begin::ResultCase::kError) {
+        throw_error(response.begin().error());
+    }
+    return response.begin().success().transaction_handle();
+}
+
+void sql_client::commit(const transaction_handle& transaction) {
+    ::jogasaki::proto::sql::request::Request request{};
+    auto* commit = request.mutable_commit();
+    *(commit->mutable_transaction_handle()) = transaction;
+    commit->mutable_option()->set_auto_dispose(true);
+    check_result_only(send(request));
+}
+
+void sql_client::rollback(const transaction_handle& transaction) noexcept {
+    try {
+        ::jogasaki::proto::sql::request::Request request{};
+        *(request.mutable_rollback()->mutable_transaction_handle()) = transaction;
+        (void) send(request);
+
+        ::jogasaki::proto::sql::request::Request dispose{};
+        *(dispose.mutable_dispose_transaction()->mutable_transaction_handle()) = transaction;
+        (void) send(dispose);
+    } catch (std::exception &ex) {
+        // the error which has caused the rollback is reported
+    }
+}
+
+std::vector<std::string> sql_client::dump(const transaction_handle& transaction,
+                                          std::string_view sql,
+                                          std::string_view directory,
+                                          const ::jogasaki::proto::sql::request::DumpOption& option) {
+    ::jogasaki::proto::sql::request::Request request{};
+    auto* dump = request.mutable_execute_dump_by_text();
+    *(dump->mutable_transaction_handle()) = transaction;
+    dump->set_sql(std::string(sql));
+    dump->set_directory(std::string(directory));
+    *(dump->mutable_option()) = option;
+
+    auto slot_index = transport_->post(request);
+    if (!slot_index) {
+        throw tgctl::runtime_error(monitor::reason::internal, "could not send the request to the sql service");
+    }
+
+    // the body head names the result set through which the files are reported, which is omitted on an early error
+    std::vector<std::string> files{};
+    auto response = receive(slot_index.value());
+    if (response.response_case() == response_type::ResponseCase::kExecuteQuery) {
+        auto resultset_wire = transport_->create_resultset_wire(response.execute_query().name());
+        record_reader reader{};
+        std::vector<column_value> record{};
+        while (true) {
+            auto chunk = resultset_wire->get_chunk();
+            if (chunk.data() == nullptr) {
+                break;
+            }
+            reader.append(chunk);
+            resultset_wire->dispose();
+            while (next_record(reader, record)) {
+                if (record.empty() || !std::holds_alternative<std::string>(record.front())) {
+                    throw tgctl::runtime_error(monitor::reason::payload_broken, "the record of the dump result is not a file name");
+                }
+                files.emplace_back(std::get<std::string>(record.front()));
+            }
+        }
+        resultset_wire->set_closed();
+        if (reader.has_remaining() && !reader.end_of_contents()) {
+            throw tgctl::runtime_error(monitor::reason::payload_broken, "the dump result ends in the middle of a record");
+        }
+        response = receive(slot_index.value());
+    }
+    check_result_only(response);
+    return files;
+}
+
+::jogasaki::proto::sql::response::DescribeTable::Success sql_client::describe_table(std::string_view name) {
+    ::jogasaki::proto::sql::request::Request request{};
+    request.mutable_describe_table()->set_name(std::string(name));
+    auto response = send(request);
+
+    if (response.response_case() != response_type::ResponseCase::kDescribeTable) {
+        throw tgctl::runtime_error(monitor::reason::payload_broken, "the response is not a DescribeTable");
+    }
+    if (response.describe_table().result_case() == ::jogasaki::proto::sql::response::DescribeTable::ResultCase::kError) {
+        throw_error(response.describe_table().error());
+    }
+    return response.describe_table().success();
+}
+
+prepared_statement_handle sql_client::prepare(std::string_view sql, const std::vector<::jogasaki::proto::sql::request::Placeholder>& placeholders) {
+    ::jogasaki::proto::sql::request::Request request{};
+    auto* prepare = request.mutable_prepare();
+    prepare->set_sql(std::string(sql));
+    for (auto&& p : placeholders) {
+        *(prepare->add_placeholders()) = p;
+    }
+    auto response = send(request);
+
+    if (response.response_case() != response_type::ResponseCase::kPrepare) {
+        throw tgctl::runtime_error(monitor::reason::payload_broken, "the response is not a Prepare");
+    }
+    if (response.prepare().result_case() == ::jogasaki::proto::sql::response::Prepare::ResultCase::kError) {
+        throw_error(response.prepare().error());
+    }
+    return response.prepare().prepared_statement_handle();
+}
+
+void sql_client::dispose(const prepared_statement_handle& statement) noexcept {
+    try {
+        ::jogasaki::proto::sql::request::Request request{};
+        *(request.mutable_dispose_prepared_statement()->mutable_prepared_statement_handle()) = statement;
+        (void) send(request);
+    } catch (std::exception &ex) {
+        // the prepared statement is disposed of with the session anyway
+    }
+}
+
+std::uint64_t sql_client::load(const transaction_handle& transaction,
+                               const prepared_statement_handle& statement,
+                               const std::vector<::jogasaki::proto::sql::request::Parameter>& parameters,
+                               const std::vector<std::string>& files) {
+    ::jogasaki::proto::sql::request::Request request{};
+    auto* load = request.mutable_execute_load();
+    *(load->mutable_transaction_handle()) = transaction;
+    *(load->mutable_prepared_statement_handle()) = statement;
+    for (auto&& p : parameters) {
+        *(load->add_parameters()) = p;
+    }
+    for (auto&& f : files) {
+        load->add_file(f);
+    }
+    auto response = send(request);
+
+    // older servers report the result of a load by ResultOnly
+    if (response.response_case() != response_type::ResponseCase::kExecuteResult) {
+        check_result_only(response);
+        return 0;
+    }
+    const auto& result = response.execute_result();
+    if (result.result_case() == ::jogasaki::proto::sql::response::ExecuteResult::ResultCase::kError) {
+        throw_error(result.error());
+    }
+    std::uint64_t inserted{};
+    for (auto&& counter : result.success().counters()) {
+        if (counter.type() == ::jogasaki::proto::sql::response::ExecuteResult::INSERTED_ROWS) {
+            inserted += static_cast<std::uint64_t>(counter.value());
+        }
+    }
+    return inserted;
+}
+
+}  // tateyama::sql
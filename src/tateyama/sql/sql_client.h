@@ -0,0 +1,111 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define BOOST_BIND_GLOBAL_PLACEHOLDERS  // FIXME (to retain the current behavior)
+#include "tateyama/transport/transport.h"
+
+namespace tateyama::sql {
+
+using transaction_handle = ::jogasaki::proto::sql::common::Transaction;
+using prepared_statement_handle = ::jogasaki::proto::sql::common::PreparedStatement;
+
+/**
+ * @brief a session of the SQL service, used by the bulk data commands
+ * @details each sql_client has its own session, thus the requests of different sql_clients are processed in parallel.
+ * The member functions can be called by several threads at a time, whose requests are pipelined on the session.
+ * The errors reported by the SQL service are thrown as tgctl::runtime_error with monitor::reason::server.
+ */
+class sql_client {
+public:
+    sql_client();
+    ~sql_client();
+
+    sql_client(sql_client const& other) = delete;
+    sql_client& operator=(sql_client const& other) = delete;
+    sql_client(sql_client&& other) noexcept = delete;
+    sql_client& operator=(sql_client&& other) noexcept = delete;
+
+    /**
+     * @brief begins a transaction
+     * @param write_preserves the tables the long transaction writes
+     */
+    transaction_handle begin(::jogasaki::proto::sql::request::TransactionType type,
+                             std::string_view label,
+                             const std::vector<std::string>& write_preserves = {});
+
+    /**
+     * @brief commits the transaction, which is disposed at the same time
+     */
+    void commit(const transaction_handle& transaction);
+
+    /**
+     * @brief aborts the transaction and disposes of it, any error is ignored as it is called on another error
+     */
+    void rollback(const transaction_handle& transaction) noexcept;
+
+    /**
+     * @brief dumps the result of the query into the files in the directory on the server
+     * @return the files the server has created, in the order they are reported
+     */
+    std::vector<std::string> dump(const transaction_handle& transaction,
+                                  std::string_view sql,
+                                  std::string_view directory,
+                                  const ::jogasaki::proto::sql::request::DumpOption& option);
+
+    /**
+     * @brief returns the definition of the table
+     */
+    ::jogasaki::proto::sql::response::DescribeTable::Success describe_table(std::string_view name);
+
+    /**
+     * @brief prepares the statement
+     */
+    prepared_statement_handle prepare(std::string_view sql, const std::vector<::jogasaki::proto::sql::request::Placeholder>& placeholders);
+
+    /**
+     * @brief disposes of the prepared statement, any error is ignored
+     */
+    void dispose(const prepared_statement_handle& statement) noexcept;
+
+    /**
+     * @brief executes the prepared statement for each record in the files on the server
+     * @param parameters the placeholders and the columns of the files which give their values
+     * @return the number of the records inserted, or 0 if it is not reported
+     */
+    std::uint64_t load(const transaction_handle& transaction,
+                       const prepared_statement_handle& statement,
+                       const std::vector<::jogasaki::proto::sql::request::Parameter>& parameters,
+                       const std::vector<std::string>& files);
+
+    /**
+     * @brief closes the session
+     */
+    void close();
+
+private:
+    std::unique_ptr<tateyama::bootstrap::wire::transport> transport_;
+
+    ::jogasaki::proto::sql::response::Response send(::jogasaki::proto::sql::request::Request& request);
+    ::jogasaki::proto::sql::response::Response receive(tateyama::common::wire::message_header::index_type slot_index);
+};
+
+}  // tateyama::sql
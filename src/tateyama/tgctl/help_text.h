@@ -40,6 +40,12 @@ static constexpr std::string_view help_text {  // NOLINT
 "      --timeout (timeout for tgctl start in second, no timeout control takes place if 0 is specified) type: int32 default: 10\n"
 "      --quiesce (invoke in quiesce mode) type: bool default: false\n"
 "      --maintenance_server (invoke in maintenance_server mode) type: bool default: false\n"
+"      --supervise (keep a supervisor that relaunches tsurugidb with exponential backoff when it exits abnormally) type: bool default: false\n"
+"      --supervisor_monitor (the file to which the supervisor events are appended, <pid_directory>/tsurugi-<digest>-supervisor.log if empty) type: string default: \"\"\n"
+"    the following options override the placement of tsurugidb given in the system section of the configuration\n"
+"      --cpu_affinity (cpus on which tsurugidb runs, e.g. 0-7,16-23) type: string default: \"\"\n"
+"      --numa_memory_policy (numa memory policy, one of default, bind, preferred or interleave) type: string default: \"\"\n"
+"      --numa_nodes (numa nodes for numa_memory_policy, e.g. 0 or 0-1) type: string default: \"\"\n"
 "    the following options are to specify how to handle tsurugidb log\n"
 "      --logtostderr (log messages go to stderr instead of logfiles) type: bool default: false\n"
 "      --stderrthreshold (log messages at or above this level are copied to stderr in addition to logfiles.  This flag obsoletes --alsologtostderr.) type: int32 default: 2\n"
@@ -49,6 +55,17 @@ static constexpr std::string_view help_text {  // NOLINT
 "      --v (Show all VLOG(m) messages for m <= this. Overridable by --vmodule.)  type: int32 default: 0\n"
 "      --logbuflevel (Buffer log messages logged at this level or lower (-1 meanss don't buffer; 0 means buffer INFO only; ...)) type: int32 default: 0\n"
 "\n"
+"  restart : shutdown the tsurugidb and start it up again immediately.\n"
+"    <args>\n"
+"      none\n"
+"    <options>\n"
+"      --timeout (timeout for the shutdown in second, no timeout control takes place if 0 is specified) type: int32 default: 300\n"
+"      --forceful (forceful shutdown) type: bool default: false\n"
+"      --graceful (graceful shutdown) type: bool default: false\n"
+"      --quiesce (restart in quiesce mode) type: bool default: false\n"
+"      --maintenance_server (restart in maintenance_server mode) type: bool default: false\n"
+"    the time during which tsurugidb is unavailable is reported in milliseconds.\n"
+"\n"
 "  shutdown : shutdown the tsurugidb.\n"
 "    <args>\n"
 "      none\n"
@@ -71,18 +88,81 @@ static constexpr std::string_view help_text {  // NOLINT
 "\n"
 "  backup create : create a backup of the database\n"
 "    <args>\n"
-"      path : backup directory\n"
+"      path : backup directory, which is not needed with --stream or --repository\n"
 "    <options>\n"
 "      --label (label for this operation) type: string default: \"\"\n"
+"      --parallel (the number of threads copying files, determined from the numbers of cores and devices if 0) type: int32 default: 0\n"
+"      --incremental-from (the previous backup, from which the files unchanged are linked instead of being copied) type: string default: \"\"\n"
+"      --compress (compression of the backup files, zstd or lz4 optionally followed by :level, e.g. zstd:3) type: string default: \"\"\n"
+"      --backup-type (standard or transaction, the server is asked for the detail of the files with their log range, and the mutable files are copied after the others) type: string default: \"\"\n"
+"      --stream (the file or pipe into which the backup is written in the tar format instead of the backup directory, - for the standard output, e.g. --stream - | ssh host 'cat > backup.tar') type: string default: \"\"\n"
+"      --repository (the chunk repository into which the backup is stored as a new generation, where the files are split into chunks by their contents and each chunk is stored once, created if the directory does not exist or is empty) type: string default: \"\"\n"
+"      --resume (resume the backup interrupted in the backup directory, skipping the files completed by the previous run and unchanged since then) type: bool default: false\n"
+"      --offline (when tsurugidb is not running, copy the files in datastore.log_location directly, holding the lock which keeps tsurugidb from starting, instead of starting tsurugidb in maintenance_server mode) type: bool default: false\n"
+"      --progress (report the progress on the standard error every second, with the bytes copied, the rate, the estimated time to finish and the file being copied, which are reported to --monitor as well) type: bool default: false\n"
+"    the following options reduce the impact of the backup on the database\n"
+"      --max-rate (the maximum rate of reading the database files in MB/s, shared by all the threads, unlimited if 0) type: int32 default: 0\n"
+"      --io-class (the I/O scheduling class of tgctl while copying, idle or best-effort, which takes effect with the I/O schedulers supporting it such as bfq) type: string default: \"\"\n"
+"      --drop-cache (drop the pages of the files copied from the page cache, not to evict the pages used by the database) type: bool default: false\n"
+"      --direct-io (copy the files with O_DIRECT, bypassing the page cache, if the file systems support it) type: bool default: false\n"
 "\n"
-"  restore backup : restore database from the backup\n"
+"  backup estimate : estimate the size of a backup, and how much an incremental backup copies and how long it takes\n"
+"    <args>\n"
+"      path : the backup destination into which the sample is copied, the temporary directory if omitted\n"
+"    <options>\n"
+"      --incremental-from (the previous backup, compared with which the files copied by an incremental backup are counted) type: string default: \"\"\n"
+"      --compress (the compression of the backup to be created, as given to backup create, which tells the files reusable from the previous backup) type: string default: \"\"\n"
+"      --sample-size (the size of the sample copied in MB to measure the copy rate at --parallel and --max-rate, from which the duration is estimated, no sample is taken if 0) type: int32 default: 0\n"
+"      --parallel (the number of threads copying the sample, determined from the numbers of cores and devices if 0) type: int32 default: 0\n"
+"      --max-rate (the maximum rate of reading the database files in MB/s, unlimited if 0) type: int32 default: 0\n"
+"    the files are listed by beginning a backup, which is ended at once, if --incremental-from or --sample-size is given\n"
+"\n"
+"  backup verify : verify the files in the backup with the checksums recorded when it was created\n"
 "    <args>\n"
 "      path : backup directory\n"
 "    <options>\n"
+"      --parallel (the number of threads reading files, determined from the numbers of cores and devices if 0) type: int32 default: 0\n"
+"\n"
+"  backup tag add : add a Point-in-Time recovery tag, a restore point made without copying the database, which can be restored by restore tag\n"
+"    <args>\n"
+"      name : tag name\n"
+"    <options>\n"
+"      --comment (the comment of the tag) type: string default: \"\"\n"
+"\n"
+"  backup tag list : list the tags with their creation time, author and comment\n"
+"\n"
+"  backup tag show : show the tag\n"
+"    <args>\n"
+"      name : tag name\n"
+"\n"
+"  backup tag remove : remove the tag\n"
+"    <args>\n"
+"      name : tag name\n"
+"\n"
+"  restore backup : restore database from the backup\n"
+"    <args>\n"
+"      path : backup directory, which is not needed with --stream, or the generation with --repository, the latest if omitted\n"
+"    <options>\n"
 "      --keep_backup (backup files will be kept) type: bool default: true\n"
 "      --force (execute without prompting for confirmation) type: bool default: false\n"
 "      --use-file-list </path/to/file-list> (target files for backup are specified by a json file describing the file list) type: string default: \"\"\n"
 "      --label (label for this operation) type: string default: \"\"\n"
+"      --staging-dir (the directory where a compressed backup or a stream is extracted before restore, the temporary directory if empty) type: string default: \"\"\n"
+"      --stream (the file or pipe from which the backup written by backup create --stream is read, - for the standard input, which requires --force) type: string default: \"\"\n"
+"      --repository (the chunk repository from which the generation is materialized into the staging directory and restored) type: string default: \"\"\n"
+"      --wait (wait for the restore job to finish, reporting its progress, and dispose of the job) type: bool default: false\n"
+"\n"
+"  restore status : display the status of a restore job\n"
+"    <args>\n"
+"      id : the restore job id\n"
+"    <options>\n"
+"      none\n"
+"\n"
+"  restore cancel : cancel a restore job which has not started running\n"
+"    <args>\n"
+"      id : the restore job id\n"
+"    <options>\n"
+"      none\n"
 "\n"
 "  session list\n"
 "    <args>\n"
@@ -156,6 +236,29 @@ static constexpr std::string_view help_text {  // NOLINT
 "        session-id : id of the session to which the request belongs\n"
 "        payload : the request message in base64 encoding\n"
 "\n"
+"  export : export the results of the queries into Parquet or Arrow files written by tsurugidb\n"
+"    <args>\n"
+"        none\n"
+"    <options>\n"
+"        --sql (the queries, separated by semicolons when there are several) type: string default: \"\"\n"
+"        --dir (the directory into which the files are written, a subdirectory 1, 2, ... is used for each query when there are several) type: string default: \"\"\n"
+"        --format (parquet or arrow) type: string default: parquet\n"
+"        --max_records_per_file (the maximum number of records in each file, 0 means unlimited) type: int64 default: 0\n"
+"        --parallel (the number of queries exported concurrently, each in its own session, 0 means all of them) type: int32 default: 0\n"
+"        --label (the label of the read only transactions) type: string default: \"tgctl export\"\n"
+"    the files written are displayed one per line.\n"
+"\n"
+"  import : load Parquet or Arrow files into a table through the insert statement prepared from the table definition\n"
+"    <args>\n"
+"        the files, which are also loaded, as the files matched by the wildcards in --files are expanded by the shell\n"
+"    <options>\n"
+"        --table (the table into which the files are loaded) type: string default: \"\"\n"
+"        --files (the files, which may contain wildcards, quoted not to be expanded by the shell) type: string default: \"\"\n"
+"        --parallel (the number of files loaded concurrently, 0 means the number of cores) type: int32 default: 0\n"
+"        --label (the label of the long transactions, in each of which a file is loaded) type: string default: \"tgctl import\"\n"
+"    each column of the table is given by the column of the same name in the files.\n"
+"    the records and the throughput of each file loaded are displayed, and are written to --monitor with the files failed.\n"
+"\n"
 "  credentials : make a credential file\n"
 "    <args>\n"
 "        none\n"
@@ -30,6 +30,7 @@
 #endif
 #include "tateyama/authentication/authenticator.h"
 #include "tateyama/request/request.h"
+#include "tateyama/sql/sql.h"
 
 #include "help_text.h"
 
@@ -43,9 +44,13 @@ DECLARE_int32(timeout);
 // control
 DECLARE_bool(q);
 DECLARE_bool(quiet);
+DECLARE_bool(supervise);
 
 // backup
 DECLARE_string(use_file_list);
+DECLARE_string(stream);
+DECLARE_bool(offline);
+DECLARE_string(repository);
 
 namespace tateyama::tgctl {
 
@@ -57,9 +62,17 @@ static int tgctl_main(const std::vector<std::string>& args) { //NOLINT(readabili
         return tateyama::tgctl::return_code::err;
     }
 
-    // simple subcommnads (start, shutdown, kill, status, diagnostic, pid, quiesce, and version)
+    // simple subcommnads (start, restart, shutdown, kill, status, diagnostic, pid, quiesce, and version)
     if (args.at(1) == "start") {
-        return tateyama::process::tgctl_start(args.at(0), true);
+        // the supervisor relaunches tsurugidb in the same mode
+        auto mode = tateyama::process::boot_mode_from_flags();
+        if (FLAGS_supervise) {
+            return tateyama::process::tgctl_start_supervised(args.at(0), mode);
+        }
+        return tateyama::process::tgctl_start(args.at(0), true, mode);
+    }
+    if (args.at(1) == "restart") {
+        return tateyama::process::tgctl_restart(args.at(0));
     }
     if (args.at(1) == "shutdown") {
         return tateyama::process::tgctl_shutdown_kill(false);
@@ -77,6 +90,9 @@ static int tgctl_main(const std::vector<std::string>& args) { //NOLINT(readabili
         return tateyama::process::tgctl_pid();
     }
     if (args.at(1) == "quiesce") {
+        if (FLAGS_supervise) {
+            return tateyama::process::tgctl_start_supervised(args.at(0), tateyama::framework::boot_mode::quiescent_server);
+        }
         return tateyama::process::tgctl_start(args.at(0), true, tateyama::framework::boot_mode::quiescent_server);
     }
     if (args.at(1) == "version") {
@@ -91,15 +107,22 @@ static int tgctl_main(const std::vector<std::string>& args) { //NOLINT(readabili
             return tateyama::tgctl::return_code::err;
         }
         if (args.at(2) == "create") {
-            if (args.size() < 4) {
-                std::cerr << "need to specify path/to/backup\n" << std::flush;
-                return tateyama::tgctl::return_code::err;
-            }
-            if (tateyama::datastore::tgctl_backup_directory_check(args.at(3)) != tgctl::return_code::ok) {
-                return tateyama::tgctl::return_code::err;
+            // the backup directory is not used when the backup is written into a stream or a repository
+            if (FLAGS_stream.empty() && FLAGS_repository.empty()) {
+                if (args.size() < 4) {
+                    std::cerr << "need to specify path/to/backup\n" << std::flush;
+                    return tateyama::tgctl::return_code::err;
+                }
+                if (tateyama::datastore::tgctl_backup_directory_check(args.at(3)) != tgctl::return_code::ok) {
+                    return tateyama::tgctl::return_code::err;
+                }
             }
 
             bool is_running = tateyama::process::is_running();
+            if (!is_running && FLAGS_offline) {
+                // copies the files of the datastore stopped, without the recovery taking place on startup
+                return tateyama::datastore::tgctl_backup_create_offline(args.size() > 3 ? args.at(3) : std::string());
+            }
             if (!is_running) {
                 auto FLAGS_quiet_previous = FLAGS_quiet;
                 auto FLAGS_monitor_previous = FLAGS_monitor;
@@ -115,7 +138,7 @@ static int tgctl_main(const std::vector<std::string>& args) { //NOLINT(readabili
                 FLAGS_quiet = FLAGS_quiet_previous;
                 FLAGS_monitor = FLAGS_monitor_previous;
             }
-            auto rv = tateyama::datastore::tgctl_backup_create(args.at(3));
+            auto rv = tateyama::datastore::tgctl_backup_create(args.size() > 3 ? args.at(3) : std::string());
             if (!is_running) {
                 FLAGS_quiet = true;
                 FLAGS_monitor = "";
@@ -127,7 +150,39 @@ static int tgctl_main(const std::vector<std::string>& args) { //NOLINT(readabili
             return rv;
         }
         if (args.at(2) == "estimate") {
-            return tateyama::datastore::tgctl_backup_estimate();
+            // the directory into which a sample is copied, which is the temporary directory if omitted
+            return tateyama::datastore::tgctl_backup_estimate(args.size() > 3 ? args.at(3) : std::string());
+        }
+        if (args.at(2) == "verify") {
+            if (args.size() < 4) {
+                std::cerr << "need to specify path/to/backup\n" << std::flush;
+                return tateyama::tgctl::return_code::err;
+            }
+            return tateyama::datastore::tgctl_backup_verify(args.at(3));
+        }
+        if (args.at(2) == "tag") {
+            if (args.size() < 4) {
+                std::cerr << "need to specify tag subcommand\n" << std::flush;
+                return tateyama::tgctl::return_code::err;
+            }
+            if (args.at(3) == "list") {
+                return tateyama::datastore::tgctl_backup_tag_list();
+            }
+            if (args.at(3) != "add" && args.at(3) != "show" && args.at(3) != "remove") {
+                std::cerr << "unknown tag subcommand '" << args.at(3) << "'\n" << std::flush;
+                return tateyama::tgctl::return_code::err;
+            }
+            if (args.size() < 5) {
+                std::cerr << "need to specify tag name\n" << std::flush;
+                return tateyama::tgctl::return_code::err;
+            }
+            if (args.at(3) == "add") {
+                return tateyama::datastore::tgctl_backup_tag_add(args.at(4));
+            }
+            if (args.at(3) == "show") {
+                return tateyama::datastore::tgctl_backup_tag_show(args.at(4));
+            }
+            return tateyama::datastore::tgctl_backup_tag_remove(args.at(4));
         }
         std::cerr << "unknown backup subcommand '" << args.at(2) << "'\n" << std::flush;
         return tateyama::tgctl::return_code::err;
@@ -135,6 +190,17 @@ static int tgctl_main(const std::vector<std::string>& args) { //NOLINT(readabili
 
     // restore
     if (args.at(1) == "restore") {
+        if (args.size() > 2 && (args.at(2) == "status" || args.at(2) == "cancel")) {
+            // inquires of the tsurugidb running the restore job, instead of starting one in maintenance_server mode
+            if (args.size() < 4) {
+                std::cerr << "need to specify the restore job id\n" << std::flush;
+                return tateyama::tgctl::return_code::err;
+            }
+            if (args.at(2) == "status") {
+                return tateyama::datastore::tgctl_restore_status(args.at(3));
+            }
+            return tateyama::datastore::tgctl_restore_cancel(args.at(3));
+        }
         if (FLAGS_timeout != -1) {
             std::cerr << "timeout option cannot be specified to restore subcommand\n" << std::flush;
         }
@@ -147,7 +213,12 @@ static int tgctl_main(const std::vector<std::string>& args) { //NOLINT(readabili
                 return tateyama::tgctl::return_code::err;
             }
             if (args.at(2) == "backup") {
-                if (args.size() > 3) {
+                if (!FLAGS_stream.empty()) {
+                    rtnv = tateyama::datastore::tgctl_restore_backup_stream(FLAGS_stream);
+                } else if (!FLAGS_repository.empty()) {
+                    // the latest generation unless specified
+                    rtnv = tateyama::datastore::tgctl_restore_backup_repository(args.size() > 3 ? args.at(3) : std::string());
+                } else if (args.size() > 3) {
                     const auto& arg = args.at(3);
                     if (!FLAGS_use_file_list.empty()) {
                         rtnv = tateyama::datastore::tgctl_restore_backup_use_file_list(arg);
@@ -316,6 +387,16 @@ static int tgctl_main(const std::vector<std::string>& args) { //NOLINT(readabili
         return tateyama::tgctl::return_code::err;
     }
 
+    // export
+    if (args.at(1) == "export") {
+        return tateyama::sql::tgctl_export();
+    }
+
+    // import
+    if (args.at(1) == "import") {
+        return tateyama::sql::tgctl_import(std::vector<std::string>(args.begin() + 2, args.end()));
+    }
+
     // credentials
     if (args.at(1) == "credentials") {
         tateyama::authentication::authenticator authenticator{};
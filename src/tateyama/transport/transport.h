@@ -428,6 +428,15 @@ public:
     // sql(ExtractStatementInfo)
     template <typename T>
     std::optional<T> send(::jogasaki::proto::sql::request::Request& request) {
+        auto slot_index = post(request);
+        if (!slot_index) {
+            return std::nullopt;
+        }
+        return receive<T>(slot_index.value());
+    }
+
+    // sql, the response of which is received by receive() separately, as it may consist of the body head and the body
+    std::optional<tateyama::common::wire::message_header::index_type> post(::jogasaki::proto::sql::request::Request& request) {
         std::stringstream sst{};
         if(auto res = tateyama::utils::SerializeDelimitedToOstream(header_, std::addressof(sst)); ! res) {
             return std::nullopt;
@@ -439,7 +448,11 @@ public:
         }
         auto slot_index = wire_.search_slot();
         wire_.send(sst.str(), slot_index);
+        return slot_index;
+    }
 
+    template <typename T>
+    std::optional<T> receive(tateyama::common::wire::message_header::index_type slot_index) {
         std::string res_message{};
         wire_.receive(res_message, slot_index);
         ::tateyama::proto::framework::response::Header header{};
@@ -466,6 +479,13 @@ public:
         return std::nullopt;  // dummy to suppress compile error
     }
 
+    // result set, the name of which is given by the body head
+    std::unique_ptr<tateyama::common::wire::session_wire_container::resultset_wires_container> create_resultset_wire(std::string_view name) {
+        auto resultset_wire = wire_.create_resultset_wire();
+        resultset_wire->connect(name);
+        return resultset_wire;
+    }
+
     void close() {
         wire_.close();
         closed_ = true;
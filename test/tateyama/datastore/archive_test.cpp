@@ -0,0 +1,112 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fstream>
+#include <fcntl.h>
+#include "test_root.h"
+
+#include "tateyama/datastore/archive.h"
+#include "tateyama/datastore/crc32c.h"
+#include "tateyama/datastore/file_descriptor.h"
+
+namespace tateyama::datastore {
+
+class archive_test : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        helper_ = std::make_unique<directory_helper>("archive_test", 20605);
+        helper_->set_up();
+    }
+
+    virtual void TearDown() {
+        helper_->tear_down();
+    }
+
+protected:
+    std::unique_ptr<directory_helper> helper_{};
+
+    static std::string contents(const std::filesystem::path& file) {
+        std::ifstream strm(file, std::ios_base::binary);
+        return {std::istreambuf_iterator<char>(strm), std::istreambuf_iterator<char>()};
+    }
+};
+
+TEST_F(archive_test, round_trip) {
+    auto log = std::filesystem::path(helper_->abs_path("log"));
+    {
+        // larger than the buffer, so that the data is written across it
+        std::ofstream strm(log / "pwal_0000", std::ios_base::binary);
+        for (int i = 0; i < 1000000; i++) {
+            strm << "record " << i << '\n';
+        }
+    }
+    std::ofstream(log / "epoch") << "12345";
+    std::ofstream(log / "empty");
+
+    auto archive = std::filesystem::path(helper_->abs_path("backup")) / "backup.tar";
+    {
+        file_descriptor fd(open(archive.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644));
+        ASSERT_GE(fd.get(), 0);
+        archive_writer writer(fd.get());
+        for (auto&& name : {"pwal_0000", "epoch", "empty"}) {
+            auto result = writer.add(log / name, name);
+            EXPECT_EQ(result.checksum, crc32c_file(log / name));
+        }
+        writer.add_data("manifest.json", "{}");
+        writer.finish();
+        EXPECT_EQ(writer.bytes_written(), std::filesystem::file_size(archive));
+        EXPECT_EQ(std::filesystem::file_size(archive) % 512, 0);
+    }
+
+    auto restored = std::filesystem::path(helper_->abs_path("backup")) / "restored";
+    std::filesystem::create_directories(restored);
+    file_descriptor fd(open(archive.c_str(), O_RDONLY));
+    ASSERT_GE(fd.get(), 0);
+    archive_reader reader(fd.get());
+    auto files = reader.extract(restored, {});
+    ASSERT_EQ(files.size(), 4);
+    for (auto&& file : files) {
+        if (file.name == "manifest.json") {
+            EXPECT_EQ(contents(restored / file.name), "{}");
+            continue;
+        }
+        EXPECT_EQ(contents(restored / file.name), contents(log / file.name));
+        EXPECT_EQ(file.size, std::filesystem::file_size(log / file.name));
+        EXPECT_EQ(file.checksum, crc32c_file(log / file.name));
+    }
+}
+
+TEST_F(archive_test, truncated) {
+    auto log = std::filesystem::path(helper_->abs_path("log"));
+    std::ofstream(log / "epoch") << "12345";
+    auto archive = std::filesystem::path(helper_->abs_path("backup")) / "backup.tar";
+    {
+        file_descriptor fd(open(archive.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644));
+        ASSERT_GE(fd.get(), 0);
+        archive_writer writer(fd.get());
+        writer.add(log / "epoch", "epoch");
+        writer.finish();
+    }
+    std::filesystem::resize_file(archive, 512 + 2);
+
+    auto restored = std::filesystem::path(helper_->abs_path("backup")) / "restored";
+    std::filesystem::create_directories(restored);
+    file_descriptor fd(open(archive.c_str(), O_RDONLY));
+    ASSERT_GE(fd.get(), 0);
+    archive_reader reader(fd.get());
+    EXPECT_THROW(reader.extract(restored, {}), std::runtime_error);
+}
+
+}  // namespace tateyama::datastore
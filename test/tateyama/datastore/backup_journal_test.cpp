@@ -0,0 +1,80 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fstream>
+#include <unistd.h>
+#include "test_root.h"
+
+#include "tateyama/datastore/backup_journal.h"
+
+namespace tateyama::datastore {
+
+class backup_journal_test : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        helper_ = std::make_unique<directory_helper>("backup_journal_test", 20606);
+        helper_->set_up();
+    }
+
+    virtual void TearDown() {
+        helper_->tear_down();
+    }
+
+protected:
+    std::unique_ptr<directory_helper> helper_{};
+};
+
+TEST_F(backup_journal_test, resume) {
+    auto location = std::filesystem::path(helper_->abs_path("backup"));
+    {
+        backup_journal journal(location, false);
+        EXPECT_FALSE(journal.resuming());
+        journal.append("pwal_0000", manifest_entry{123, 1700000000123456789L, "crc32c:e3069283", 123});
+        journal.append("data/snapshot", manifest_entry{100, 1700000000000000000L, "crc32c:00000001", 200, false, true});
+    }
+    {
+        // a line torn by the interruption
+        std::ofstream strm(location / std::filesystem::path(backup_journal::file_name), std::ios_base::app);
+        strm << R"({"name":"pwal_0001","size":1)";
+    }
+
+    backup_journal journal(location, true);
+    EXPECT_TRUE(journal.resuming());
+    const auto* entry = journal.completed("pwal_0000");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->size, 123);
+    EXPECT_EQ(entry->mtime, 1700000000123456789L);
+    EXPECT_EQ(entry->checksum, "crc32c:e3069283");
+    ASSERT_NE(journal.completed("data/snapshot"), nullptr);
+    EXPECT_EQ(journal.completed("data/snapshot")->source_size, 200);
+    EXPECT_TRUE(journal.completed("data/snapshot")->detached);
+    EXPECT_EQ(journal.completed("pwal_0001"), nullptr);
+
+    // the lines appended after the torn line are read by the next run
+    journal.append("pwal_0001", manifest_entry{10, 1700000000000000000L, "crc32c:00000002", 10});
+    EXPECT_NE(backup_journal(location, true).completed("pwal_0001"), nullptr);
+
+    journal.remove();
+    EXPECT_FALSE(std::filesystem::exists(location / std::filesystem::path(backup_journal::file_name)));
+}
+
+TEST_F(backup_journal_test, restart) {
+    auto location = std::filesystem::path(helper_->abs_path("backup"));
+    backup_journal(location, false).append("pwal_0000", manifest_entry{123, 1700000000123456789L, "crc32c:e3069283", 123});
+    EXPECT_EQ(backup_journal(location, false).completed("pwal_0000"), nullptr);
+    EXPECT_EQ(backup_journal(location, true).completed("pwal_0000"), nullptr);
+}
+
+}  // namespace tateyama::datastore
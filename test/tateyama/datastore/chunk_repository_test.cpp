@@ -0,0 +1,145 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fstream>
+#include <random>
+#include <unistd.h>
+#include "test_root.h"
+
+#include "tateyama/datastore/chunk_repository.h"
+#include "tateyama/datastore/crc32c.h"
+
+namespace tateyama::datastore {
+
+class chunk_repository_test : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        helper_ = std::make_unique<directory_helper>("chunk_repository_test", 20607);
+        helper_->set_up();
+        src_ = helper_->abs_path("log");
+        write_random(src_ / "pwal_0000", 8UL * 1024UL * 1024UL, 1);
+        std::filesystem::create_directories(src_ / "data");
+        write_random(src_ / "data" / "snapshot", 3UL * 1024UL * 1024UL + 123UL, 2);
+        files_ = {
+            {src_ / "pwal_0000", "pwal_0000", false, false},
+            {src_ / "data" / "snapshot", "data/snapshot", false, true},
+        };
+    }
+
+    virtual void TearDown() {
+        helper_->tear_down();
+    }
+
+protected:
+    std::unique_ptr<directory_helper> helper_{};
+    std::filesystem::path src_{};
+    std::vector<repository_source> files_{};
+
+    static void write_random(const std::filesystem::path& file, std::size_t size, unsigned int seed) {
+        std::mt19937_64 engine(seed);
+        std::string data(size, '\0');
+        for (auto& c : data) {
+            c = static_cast<char>(engine());
+        }
+        std::ofstream strm(file, std::ios_base::binary);
+        strm << data;
+    }
+};
+
+TEST_F(chunk_repository_test, boundary) {
+    chunking params{};
+    std::string data(params.max_size * 2, 'a');
+    // no boundary in the data of the same bytes, thus cut at the maximum
+    EXPECT_EQ(chunk_boundary(data.data(), data.size(), params), params.max_size);
+    EXPECT_EQ(chunk_boundary(data.data(), params.min_size - 1, params), params.min_size - 1);
+}
+
+TEST_F(chunk_repository_test, store_and_materialize) {
+    auto location = std::filesystem::path(helper_->abs_path("backup")) / "repository";
+    chunk_repository repository(location);
+    auto first = repository.store(files_, log_range{"standard", 1, 2, {}}, 2, copy_options{}, nullptr);
+    EXPECT_EQ(repository.stats().new_chunks, repository.stats().chunks);
+    EXPECT_EQ(repository.stats().new_bytes, std::filesystem::file_size(src_ / "pwal_0000") + std::filesystem::file_size(src_ / "data" / "snapshot"));
+
+    // only the chunks around the change are stored again
+    {
+        std::fstream strm(src_ / "pwal_0000", std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+        strm.seekp(4L * 1024L * 1024L);
+        strm << "changed";
+    }
+    auto second = chunk_repository(location).store(files_, std::nullopt, 2, copy_options{}, nullptr);
+    EXPECT_NE(first, second);
+    chunk_repository reopened(location);
+    ASSERT_EQ(reopened.generations().size(), 2);
+    EXPECT_EQ(reopened.generations().back(), second);
+
+    std::size_t files = 0;
+    auto dst = std::filesystem::path(helper_->abs_path("backup")) / "materialized";
+    auto mf = reopened.materialize(second, dst, 2, [&files](const std::string&, std::uintmax_t, std::uintmax_t, std::uintmax_t) { files++; });
+    EXPECT_EQ(files, 2);
+    EXPECT_EQ(crc32c_file(dst / "pwal_0000"), crc32c_file(src_ / "pwal_0000"));
+    EXPECT_EQ(crc32c_file(dst / "data" / "snapshot"), crc32c_file(src_ / "data" / "snapshot"));
+
+    // the manifest is not among the files restored
+    EXPECT_FALSE(std::filesystem::exists(dst / std::filesystem::path(manifest::file_name)));
+    ASSERT_NE(mf.find("data/snapshot"), nullptr);
+    EXPECT_TRUE(mf.find("data/snapshot")->detached);
+}
+
+TEST_F(chunk_repository_test, stored_chunks_are_shared) {
+    auto location = std::filesystem::path(helper_->abs_path("backup")) / "repository";
+    chunk_repository(location).store(files_, std::nullopt, 2, copy_options{}, nullptr);
+    chunk_repository repository(location);
+    repository.store(files_, std::nullopt, 2, copy_options{}, nullptr);
+    EXPECT_EQ(repository.stats().new_chunks, 0);
+    EXPECT_EQ(repository.stats().new_bytes, 0);
+}
+
+TEST_F(chunk_repository_test, not_repository) {
+    EXPECT_THROW(chunk_repository{src_}, std::runtime_error);
+}
+
+TEST_F(chunk_repository_test, short_chunk_is_written_again) {
+    auto location = std::filesystem::path(helper_->abs_path("backup")) / "repository";
+    chunk_repository(location).store(files_, std::nullopt, 2, copy_options{}, nullptr);
+
+    // the chunks renamed into place but lost their contents by a crash
+    for (auto&& entry : std::filesystem::recursive_directory_iterator(location / "chunks")) {
+        if (entry.is_regular_file()) {
+            std::filesystem::resize_file(entry.path(), 0);
+        }
+    }
+    chunk_repository repository(location);
+    auto name = repository.store(files_, std::nullopt, 2, copy_options{}, nullptr);
+    EXPECT_EQ(repository.stats().new_chunks, repository.stats().chunks);
+
+    auto dst = std::filesystem::path(helper_->abs_path("backup")) / "materialized";
+    repository.materialize(name, dst, 2, nullptr);
+    EXPECT_EQ(crc32c_file(dst / "pwal_0000"), crc32c_file(src_ / "pwal_0000"));
+}
+
+TEST_F(chunk_repository_test, same_chunks_stored_at_once_are_counted_once) {
+    std::filesystem::copy_file(src_ / "pwal_0000", src_ / "pwal_0001");
+    std::vector<repository_source> files{
+        {src_ / "pwal_0000", "pwal_0000", false, false},
+        {src_ / "pwal_0001", "pwal_0001", false, false},
+    };
+    chunk_repository repository(std::filesystem::path(helper_->abs_path("backup")) / "repository");
+    repository.store(files, std::nullopt, 2, copy_options{}, nullptr);
+    EXPECT_EQ(repository.stats().new_chunks * 2, repository.stats().chunks);
+    EXPECT_EQ(repository.stats().new_bytes, std::filesystem::file_size(src_ / "pwal_0000"));
+}
+
+}  // namespace tateyama::datastore
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fstream>
+#include "test_root.h"
+
+#include "tateyama/datastore/compression.h"
+#include "tateyama/datastore/crc32c.h"
+
+namespace tateyama::datastore {
+
+class compression_test : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        helper_ = std::make_unique<directory_helper>("compression_test", 20604);
+        helper_->set_up();
+    }
+
+    virtual void TearDown() {
+        helper_->tear_down();
+    }
+
+protected:
+    std::unique_ptr<directory_helper> helper_{};
+
+    void round_trip(const std::string& spec) {
+        auto comp = parse_compression(spec);
+        ASSERT_TRUE(comp);
+        if (!compression_available(comp->codec)) {
+            GTEST_SKIP() << "built without " << to_string_view(comp->codec);
+        }
+        auto src = std::filesystem::path(helper_->abs_path("log")) / "pwal_0000";
+        {
+            // compressible data, a hole and a partial block at the end
+            std::ofstream strm(src, std::ios_base::binary);
+            for (int i = 0; i < 200000; i++) {
+                strm << "record " << (i % 100) << '\n';
+            }
+            strm.seekp(8L * 1024L * 1024L);
+            strm << "tail";
+        }
+        auto compressed = std::filesystem::path(helper_->abs_path("backup")) / ("pwal_0000" + std::string(compressed_suffix));
+        auto result = compress_file(src, compressed, comp.value(), 4);
+        EXPECT_EQ(result.strategy, copy_strategy::compress);
+        EXPECT_LT(std::filesystem::file_size(compressed), std::filesystem::file_size(src));
+        ASSERT_TRUE(result.checksum);
+        EXPECT_EQ(result.checksum.value(), crc32c_file(compressed));
+        EXPECT_EQ(original_size_of(compressed), std::filesystem::file_size(src));
+
+        auto restored = std::filesystem::path(helper_->abs_path("test")) / "pwal_0000";
+        decompress_file(compressed, restored, 4);
+        EXPECT_EQ(std::filesystem::file_size(restored), std::filesystem::file_size(src));
+        EXPECT_EQ(crc32c_file(restored), crc32c_file(src));
+    }
+};
+
+TEST_F(compression_test, parse) {
+    auto zstd = parse_compression("zstd");
+    ASSERT_TRUE(zstd);
+    EXPECT_EQ(to_string(zstd.value()), "zstd:3");
+    auto lz4 = parse_compression("lz4:9");
+    ASSERT_TRUE(lz4);
+    EXPECT_EQ(to_string(lz4.value()), "lz4:9");
+    EXPECT_FALSE(parse_compression("gzip"));
+    EXPECT_FALSE(parse_compression("zstd:"));
+    EXPECT_FALSE(parse_compression("zstd:0"));
+    EXPECT_FALSE(parse_compression("lz4:13"));
+}
+
+TEST_F(compression_test, zstd) {
+    round_trip("zstd:3");
+}
+
+TEST_F(compression_test, lz4) {
+    round_trip("lz4");
+}
+
+TEST_F(compression_test, broken) {
+    auto file = std::filesystem::path(helper_->abs_path("backup")) / "broken.tgcz";
+    {
+        std::ofstream strm(file);
+        strm << "not a compressed file";
+    }
+    auto dst = std::filesystem::path(helper_->abs_path("test")) / "broken";
+    EXPECT_THROW(decompress_file(file, dst, 1), std::filesystem::filesystem_error);
+    EXPECT_FALSE(std::filesystem::exists(dst));
+}
+
+}  // namespace tateyama::datastore
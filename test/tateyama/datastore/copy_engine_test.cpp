@@ -0,0 +1,125 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <sys/stat.h>
+#include "test_root.h"
+
+#include "tateyama/datastore/copy_engine.h"
+#include "tateyama/datastore/crc32c.h"
+#include "tateyama/datastore/io_control.h"
+
+namespace tateyama::datastore {
+
+class copy_engine_test : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        helper_ = std::make_unique<directory_helper>("copy_engine_test", 20602);
+        helper_->set_up();
+    }
+
+    virtual void TearDown() {
+        helper_->tear_down();
+    }
+
+protected:
+    std::unique_ptr<directory_helper> helper_{};
+
+    static std::string contents(const std::filesystem::path& file) {
+        std::ifstream strm(file, std::ios_base::binary);
+        return {std::istreambuf_iterator<char>(strm), std::istreambuf_iterator<char>()};
+    }
+};
+
+TEST_F(copy_engine_test, sparse) {
+    auto src = std::filesystem::path(helper_->abs_path("log")) / "sparse";
+    auto dst = std::filesystem::path(helper_->abs_path("backup")) / "sparse";
+    {
+        std::ofstream strm(src, std::ios_base::binary);
+        strm << "head";
+        strm.seekp(16L * 1024L * 1024L);
+        strm << "tail";
+    }
+
+    auto result = fast_copy_file(src, dst);
+    EXPECT_EQ(contents(src), contents(dst));
+    if (result.strategy != copy_strategy::reflink) {
+        // only the data segments are copied, thus the holes are kept
+        EXPECT_LT(result.data_bytes, std::filesystem::file_size(src));
+        struct stat st{};
+        ASSERT_EQ(stat(dst.c_str(), &st), 0);
+        EXPECT_LT(st.st_blocks * 512, std::filesystem::file_size(src));
+    }
+}
+
+TEST_F(copy_engine_test, exists) {
+    auto src = std::filesystem::path(helper_->abs_path("log")) / "file";
+    auto dst = std::filesystem::path(helper_->abs_path("backup")) / "file";
+    {
+        std::ofstream strm(src);
+        strm << "source";
+    }
+    {
+        std::ofstream strm(dst);
+        strm << "destination";
+    }
+    EXPECT_THROW(fast_copy_file(src, dst), std::filesystem::filesystem_error);
+    EXPECT_EQ(contents(dst), "destination");
+}
+
+TEST_F(copy_engine_test, throttled) {
+    auto src = std::filesystem::path(helper_->abs_path("log")) / "file";
+    auto dst = std::filesystem::path(helper_->abs_path("backup")) / "file";
+    {
+        std::ofstream strm(src, std::ios_base::binary);
+        strm << std::string(3L * 1024L * 1024L + 10L, 'x');  // not a multiple of the block size for O_DIRECT
+    }
+
+    rate_limiter limiter(4L * 1024L * 1024L, 1024L * 1024L);
+    auto start = std::chrono::steady_clock::now();
+    auto result = fast_copy_file(src, dst, copy_options{true, &limiter, true, true});
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(contents(src), contents(dst));
+    EXPECT_EQ(result.checksum, crc32c_file(src));
+    if (result.strategy != copy_strategy::reflink) {
+        // 2MB beyond the burst at 4MB/s
+        EXPECT_GE(elapsed, std::chrono::milliseconds(400));
+    }
+}
+
+TEST_F(copy_engine_test, canceled) {
+    auto src = std::filesystem::path(helper_->abs_path("log")) / "file";
+    auto dst = std::filesystem::path(helper_->abs_path("backup")) / "file";
+    {
+        std::ofstream strm(src, std::ios_base::binary);
+        strm << std::string(2L * 1024L * 1024L, 'x');
+    }
+
+    std::atomic_bool cancel{true};
+    copy_options options{};
+    options.cancel = &cancel;
+    try {
+        auto result = fast_copy_file(src, dst, options);
+        EXPECT_EQ(result.strategy, copy_strategy::reflink);  // no data is copied, thus nothing to be canceled
+    } catch (std::filesystem::filesystem_error &e) {
+        EXPECT_EQ(e.code().value(), ECANCELED);
+        EXPECT_FALSE(std::filesystem::exists(dst));
+    }
+}
+
+}  // namespace tateyama::datastore
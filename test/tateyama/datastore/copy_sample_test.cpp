@@ -0,0 +1,61 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fstream>
+#include <unistd.h>
+#include "test_root.h"
+
+#include "tateyama/datastore/copy_sample.h"
+
+namespace tateyama::datastore {
+
+class copy_sample_test : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        helper_ = std::make_unique<directory_helper>("copy_sample_test", 20608);
+        helper_->set_up();
+        for (std::size_t i = 0; i < 4; i++) {
+            auto file = std::filesystem::path(helper_->abs_path("log")) / ("pwal_000" + std::to_string(i));
+            std::ofstream strm(file);
+            strm << std::string((i + 1) * 1024 * 1024, 'a');
+            sources_.emplace_back(file);
+        }
+    }
+
+    virtual void TearDown() {
+        helper_->tear_down();
+    }
+
+protected:
+    std::unique_ptr<directory_helper> helper_{};
+    std::vector<std::filesystem::path> sources_{};
+};
+
+TEST_F(copy_sample_test, sample) {
+    auto dst = std::filesystem::path(helper_->abs_path("backup"));
+    auto result = sample_copy(sources_, dst, 3 * 1024 * 1024, 2, copy_options{});
+    EXPECT_EQ(result.bytes, 3 * 1024 * 1024);
+    EXPECT_EQ(result.parallelism, 1);  // a single segment taken from the largest file
+    EXPECT_GT(result.bytes_per_second(), 0.0);
+    EXPECT_TRUE(std::filesystem::is_empty(dst));
+
+    // bounded by the total size of the files
+    result = sample_copy(sources_, dst, 1024 * 1024 * 1024, 2, copy_options{});
+    EXPECT_EQ(result.bytes, 10 * 1024 * 1024);
+    EXPECT_EQ(result.parallelism, 2);
+    EXPECT_TRUE(std::filesystem::is_empty(dst));
+}
+
+}  // namespace tateyama::datastore
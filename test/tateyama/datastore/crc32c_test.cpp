@@ -0,0 +1,51 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <vector>
+#include "test_root.h"
+
+#include "tateyama/datastore/crc32c.h"
+
+namespace tateyama::datastore {
+
+class crc32c_test : public ::testing::Test {
+};
+
+TEST_F(crc32c_test, check_value) {
+    std::string data{"123456789"};
+    EXPECT_EQ(crc32c(0, data.data(), data.length()), 0xE3069283U);
+    EXPECT_EQ(crc32c(crc32c(0, data.data(), 4), data.data() + 4, data.length() - 4), 0xE3069283U);
+}
+
+TEST_F(crc32c_test, zeros) {
+    std::vector<char> zeros(3L * 1024L * 1024L + 7L, 0);
+    std::string head{"head"};
+    auto crc = crc32c(0, head.data(), head.length());
+    for (std::size_t length : {0UL, 1UL, 7UL, 8UL, 4096UL, 65537UL, zeros.size()}) {
+        EXPECT_EQ(crc32c_zeros(crc, length), crc32c(crc, zeros.data(), length)) << length;
+        EXPECT_EQ(crc32c_zeros(0, length), crc32c(0, zeros.data(), length)) << length;
+    }
+}
+
+TEST_F(crc32c_test, large_hole) {
+    // a hole of 1TiB costs no more than a few multiplications
+    auto start = std::chrono::steady_clock::now();
+    auto crc = crc32c_zeros(0, 1UL << 40U);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    EXPECT_EQ(crc32c_zeros(crc32c_zeros(0, 1UL << 39U), 1UL << 39U), crc);
+}
+
+}  // namespace tateyama::datastore
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fstream>
+#include <unistd.h>
+#include "test_root.h"
+
+#include "tateyama/datastore/copy_engine.h"
+#include "tateyama/datastore/crc32c.h"
+#include "tateyama/datastore/manifest.h"
+
+namespace tateyama::datastore {
+
+class manifest_test : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        helper_ = std::make_unique<directory_helper>("manifest_test", 20603);
+        helper_->set_up();
+    }
+
+    virtual void TearDown() {
+        helper_->tear_down();
+    }
+
+protected:
+    std::unique_ptr<directory_helper> helper_{};
+};
+
+TEST_F(manifest_test, write_and_read) {
+    auto location = std::filesystem::path(helper_->abs_path("backup"));
+    manifest written{};
+    written.incremental_from("/tmp/previous");
+    written.add("pwal_0000", manifest_entry{123, 1700000000123456789L, "crc32c:e3069283"});
+    written.add("epoch", manifest_entry{0, 1700000000000000000L, ""});
+    written.write(location);
+    EXPECT_TRUE(std::filesystem::exists(location / std::filesystem::path(manifest::file_name)));
+
+    manifest read{};
+    ASSERT_TRUE(read.read(location));
+    EXPECT_EQ(read.incremental_from(), "/tmp/previous");
+    EXPECT_EQ(read.entries().size(), 2);
+    const auto* entry = read.find("pwal_0000");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->size, 123);
+    EXPECT_EQ(entry->mtime, 1700000000123456789L);
+    EXPECT_EQ(entry->checksum, "crc32c:e3069283");
+    EXPECT_EQ(read.find("pwal_0001"), nullptr);
+}
+
+TEST_F(manifest_test, detail) {
+    auto location = std::filesystem::path(helper_->abs_path("backup"));
+    manifest written{};
+    written.detail(log_range{"transaction", 10, 20, 15});
+    written.add("data/snapshot", manifest_entry{100, 1700000000000000000L, "crc32c:00000001", 100, false, true});
+    written.add("pwal_0000", manifest_entry{200, 1700000000000000000L, "crc32c:00000002", 200, true, false});
+    written.write(location);
+
+    manifest read{};
+    ASSERT_TRUE(read.read(location));
+    ASSERT_TRUE(read.detail());
+    EXPECT_EQ(read.detail()->backup_type, "transaction");
+    EXPECT_EQ(read.detail()->log_begin, 10);
+    EXPECT_EQ(read.detail()->log_end, 20);
+    EXPECT_EQ(read.detail()->image_finish, 15);
+    EXPECT_TRUE(read.find("data/snapshot")->detached);
+    EXPECT_FALSE(read.find("data/snapshot")->is_mutable);
+    EXPECT_TRUE(read.find("pwal_0000")->is_mutable);
+}
+
+TEST_F(manifest_test, string_values) {
+    // the manifests written by boost::property_tree, which writes all the values as strings
+    auto location = std::filesystem::path(helper_->abs_path("backup"));
+    {
+        std::ofstream strm(location / std::filesystem::path(manifest::file_name));
+        strm << R"({ "version": "1", "created_at": "1700000000", "compression": "zstd:3",
+                     "detail": { "type": "standard", "log_begin": "10", "log_end": "20" },
+                     "files": [ { "path": "pwal_0000.zst", "size": "100", "mtime": "1700000000123456789",
+                                  "source_size": "123", "checksum": "crc32c:e3069283", "mutable": "true" } ] })";
+    }
+    manifest read{};
+    ASSERT_TRUE(read.read(location));
+    EXPECT_EQ(read.compression(), "zstd:3");
+    ASSERT_TRUE(read.detail());
+    EXPECT_EQ(read.detail()->log_end, 20);
+    EXPECT_FALSE(read.detail()->image_finish);
+    const auto* entry = read.find("pwal_0000.zst");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->size, 100);
+    EXPECT_EQ(entry->mtime, 1700000000123456789L);
+    EXPECT_EQ(entry->source_size, 123);
+    EXPECT_TRUE(entry->is_mutable);
+    EXPECT_FALSE(entry->detached);
+}
+
+TEST_F(manifest_test, broken) {
+    auto location = std::filesystem::path(helper_->abs_path("backup"));
+    {
+        std::ofstream strm(location / std::filesystem::path(manifest::file_name));
+        strm << R"({ "version": 1, "files": [ { "path": "pwal_0000", "size": "x" } ] })";
+    }
+    manifest read{};
+    EXPECT_FALSE(read.read(location));
+}
+
+TEST_F(manifest_test, no_manifest) {
+    manifest read{};
+    EXPECT_FALSE(read.read(std::filesystem::path(helper_->abs_path("backup"))));
+}
+
+TEST_F(manifest_test, is_metadata) {
+    EXPECT_TRUE(manifest::is_metadata("tgctl-backup-manifest.json"));
+    EXPECT_TRUE(manifest::is_metadata("tgctl-backup-journal"));
+    EXPECT_FALSE(manifest::is_metadata("pwal_0000"));
+    EXPECT_FALSE(manifest::is_metadata("data/tgctl-backup-manifest.json"));
+}
+
+TEST_F(manifest_test, crc32c) {
+    std::string_view data = "123456789";
+    EXPECT_EQ(crc32c(0, data.data(), data.length()), 0xe3069283);
+    EXPECT_EQ(crc32c(crc32c(0, data.data(), 4), data.data() + 4, data.length() - 4), 0xe3069283);
+    EXPECT_EQ(checksum_string(0xe3069283), "crc32c:e3069283");
+
+    auto file = std::filesystem::path(helper_->abs_path("log")) / "file";
+    {
+        std::ofstream strm(file, std::ios_base::binary);
+        strm << data;
+    }
+    EXPECT_EQ(crc32c_file(file), 0xe3069283);
+}
+
+TEST_F(manifest_test, clone_file) {
+    auto previous = std::filesystem::path(helper_->abs_path("log")) / "file";
+    auto dst = std::filesystem::path(helper_->abs_path("backup")) / "file";
+    {
+        std::ofstream strm(previous);
+        strm << "unchanged";
+    }
+    if (auto result = clone_file(previous, dst); result) {
+        EXPECT_EQ(result->strategy, copy_strategy::reflink);
+        EXPECT_EQ(std::filesystem::file_size(dst), std::filesystem::file_size(previous));
+
+        // the destination must not exist
+        EXPECT_FALSE(clone_file(previous, dst));
+    } else {
+        // the file system does not support reflinks, and nothing is left to be copied over
+        EXPECT_FALSE(std::filesystem::exists(dst));
+    }
+    // never shares the inode with the previous generation
+    EXPECT_EQ(std::filesystem::hard_link_count(previous), 1);
+    EXPECT_FALSE(clone_file(std::filesystem::path(helper_->abs_path("log")) / "missing", std::filesystem::path(helper_->abs_path("backup")) / "missing"));
+}
+
+TEST_F(manifest_test, verify) {
+    auto src = std::filesystem::path(helper_->abs_path("log"));
+    auto location = std::filesystem::path(helper_->abs_path("backup"));
+    manifest mf{};
+    for (auto&& name : {"pwal_0000", "pwal_0001", "pwal_0002"}) {
+        {
+            std::ofstream strm(src / name);
+            strm << "contents of " << name;
+        }
+        auto result = fast_copy_file(src / name, location / name, copy_options{true});
+        ASSERT_TRUE(result.checksum);
+        EXPECT_EQ(result.checksum.value(), crc32c_file(src / name));
+        mf.add(name, manifest_entry{std::filesystem::file_size(src / name), manifest::mtime_of(src / name), checksum_string(result.checksum.value())});
+    }
+    EXPECT_TRUE(verify_backup(location, mf, 2, nullptr).empty());
+
+    {
+        std::fstream strm(location / "pwal_0001", std::ios_base::in | std::ios_base::out);
+        strm << "C";  // same size, different contents
+    }
+    std::filesystem::remove(location / "pwal_0002");
+    auto failures = verify_backup(location, mf, 2, nullptr);
+    ASSERT_EQ(failures.size(), 2);
+    EXPECT_EQ(failures.at(0).name, "pwal_0001");
+    EXPECT_EQ(failures.at(1).name, "pwal_0002");
+}
+
+}  // namespace tateyama::datastore
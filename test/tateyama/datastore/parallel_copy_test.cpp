@@ -0,0 +1,160 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "test_root.h"
+
+#include "tateyama/datastore/parallel_copy.h"
+#include "tateyama/datastore/progress_meter.h"
+
+namespace tateyama::datastore {
+
+class parallel_copy_test : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        helper_ = std::make_unique<directory_helper>("parallel_copy_test", 20601);
+        helper_->set_up();
+        src_ = helper_->abs_path("log");
+        dst_ = helper_->abs_path("backup");
+        for (std::size_t i = 0; i < number_of_files; i++) {
+            std::ofstream strm(src_ / ("file" + std::to_string(i)));
+            strm << std::string(i * 1000, 'a' + static_cast<char>(i));
+        }
+    }
+
+    virtual void TearDown() {
+        helper_->tear_down();
+    }
+
+protected:
+    static constexpr std::size_t number_of_files = 10;
+    std::unique_ptr<directory_helper> helper_{};
+    std::filesystem::path src_{};
+    std::filesystem::path dst_{};
+};
+
+TEST_F(parallel_copy_test, copy) {
+    parallel_copy copier(3);
+    for (std::size_t i = 0; i < number_of_files; i++) {
+        copier.add(src_ / ("file" + std::to_string(i)), dst_ / ("file" + std::to_string(i)));
+    }
+    EXPECT_EQ(copier.total_bytes(), 45000);
+    EXPECT_EQ(copier.parallelism(), 3);
+
+    std::uintmax_t last = 0;
+    std::size_t count = 0;
+    copier.run([&last, &count](const std::filesystem::path&, copy_result result, std::uintmax_t completed_bytes, std::uintmax_t total_bytes) {
+        EXPECT_LE(result.data_bytes, completed_bytes - last);
+        EXPECT_GE(completed_bytes, last);
+        EXPECT_EQ(total_bytes, 45000);
+        last = completed_bytes;
+        count++;
+    });
+    EXPECT_EQ(last, 45000);
+    EXPECT_EQ(count, number_of_files);
+    for (std::size_t i = 0; i < number_of_files; i++) {
+        EXPECT_EQ(std::filesystem::file_size(dst_ / ("file" + std::to_string(i))), i * 1000);
+    }
+}
+
+TEST_F(parallel_copy_test, progress) {
+    // a large sparse file is counted as it is copied, and its holes as they are skipped
+    {
+        std::ofstream strm(src_ / "sparse", std::ios_base::binary);
+        strm << std::string(1024L * 1024L, 's');
+        strm.seekp(8L * 1024L * 1024L);
+        strm << "tail";
+    }
+    auto total_bytes = 45000 + std::filesystem::file_size(src_ / "sparse");
+    std::vector<progress_report> reports{};
+    progress_meter meter(total_bytes, number_of_files + 1, [&reports](const progress_report& r) { reports.emplace_back(r); }, std::chrono::milliseconds(0));
+
+    parallel_copy copier(3);
+    copier.measure(&meter);
+    for (std::size_t i = 0; i < number_of_files; i++) {
+        copier.add(src_ / ("file" + std::to_string(i)), dst_ / ("file" + std::to_string(i)));
+    }
+    copier.add(src_ / "sparse", dst_ / "sparse");
+    copier.run(nullptr);
+    meter.finish();
+
+    ASSERT_FALSE(reports.empty());
+    for (std::size_t i = 1; i < reports.size(); i++) {
+        EXPECT_GE(reports.at(i).bytes, reports.at(i - 1).bytes);
+    }
+    const auto& last = reports.back();
+    EXPECT_EQ(last.bytes, total_bytes);
+    EXPECT_EQ(last.total_bytes, total_bytes);
+    EXPECT_EQ(last.files, number_of_files + 1);
+    EXPECT_EQ(last.active_files, 0);
+    EXPECT_FLOAT_EQ(last.ratio(), 1.0F);
+    ASSERT_TRUE(last.eta_seconds);
+    EXPECT_EQ(last.eta_seconds.value(), 0);
+}
+
+TEST_F(parallel_copy_test, unchanged) {
+    // the previous generation, which is cloned if possible, or otherwise the source is copied, but never hard-linked
+    auto previous = dst_ / "previous";
+    std::filesystem::create_directories(previous);
+    std::filesystem::copy_file(src_ / "file3", previous / "file3");
+    parallel_copy copier(2);
+    copier.add(src_ / "file3", dst_ / "file3", previous / "file3");
+    copier.run(nullptr);
+
+    EXPECT_EQ(std::filesystem::file_size(dst_ / "file3"), 3000);
+    EXPECT_EQ(std::filesystem::hard_link_count(previous / "file3"), 1);
+    EXPECT_EQ(std::filesystem::hard_link_count(dst_ / "file3"), 1);
+}
+
+TEST_F(parallel_copy_test, error) {
+    {
+        std::ofstream strm(dst_ / "file5");
+    }
+    parallel_copy copier(2);
+    for (std::size_t i = 0; i < number_of_files; i++) {
+        copier.add(src_ / ("file" + std::to_string(i)), dst_ / ("file" + std::to_string(i)));
+    }
+    EXPECT_THROW(copier.run(nullptr), std::filesystem::filesystem_error);
+}
+
+TEST_F(parallel_copy_test, error_progress) {
+    // the files of the same name in different directories are told apart, and a file failed is no longer active
+    std::filesystem::create_directories(dst_ / "sub");
+    {
+        std::ofstream strm(dst_ / "sub" / "file5");
+    }
+    std::vector<progress_report> reports{};
+    progress_meter meter(2 * 5000, 2, [&reports](const progress_report& r) { reports.emplace_back(r); }, std::chrono::milliseconds(0));
+
+    parallel_copy copier(2);
+    copier.measure(&meter);
+    copier.add(src_ / "file5", dst_ / "file5");
+    copier.add(src_ / "file5", dst_ / "sub" / "file5");
+    EXPECT_THROW(copier.run(nullptr), std::filesystem::filesystem_error);
+    meter.finish();
+
+    ASSERT_FALSE(reports.empty());
+    const auto& last = reports.back();
+    EXPECT_EQ(last.active_files, 0);
+    EXPECT_TRUE(last.active_file.empty());
+    EXPECT_LE(last.files, 1);
+}
+
+TEST_F(parallel_copy_test, default_parallelism) {
+    auto n = parallel_copy::default_parallelism({src_, dst_});
+    EXPECT_GE(n, 1);
+    EXPECT_LE(n, std::max(std::thread::hardware_concurrency(), 1U));
+}
+
+}  // namespace tateyama::datastore
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test_root.h"
+
+#include <iostream>
+#include <sstream>
+
+#include <boost/thread/barrier.hpp>
+
+#include <tateyama/proto/datastore/request.pb.h>
+#include <tateyama/proto/datastore/response.pb.h>
+#include <tateyama/framework/component_ids.h>
+#include "tateyama/configuration/bootstrap_configuration.h"
+#include "tateyama/test_utils/server_mock.h"
+
+namespace tateyama::test_utils {
+
+template<>
+inline void server_mock::request_message<tateyama::proto::datastore::request::TagAdd>(tateyama::proto::datastore::request::TagAdd& rq) {
+    tateyama::proto::datastore::request::Request r{};
+    auto s = current_request();
+    EXPECT_TRUE(r.ParseFromString(s));
+    EXPECT_EQ(r.command_case(), tateyama::proto::datastore::request::Request::CommandCase::kTagAdd);
+    rq = r.tag_add();
+}
+
+template<>
+inline void server_mock::request_message<tateyama::proto::datastore::request::TagRemove>(tateyama::proto::datastore::request::TagRemove& rq) {
+    tateyama::proto::datastore::request::Request r{};
+    auto s = current_request();
+    EXPECT_TRUE(r.ParseFromString(s));
+    EXPECT_EQ(r.command_case(), tateyama::proto::datastore::request::Request::CommandCase::kTagRemove);
+    rq = r.tag_remove();
+}
+
+}  // tateyama::test_utils
+
+
+namespace tateyama::datastore {
+
+class tag_test : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        helper_ = std::make_unique<directory_helper>("tag_test", 20609);
+        helper_->set_up();
+        auto bst_conf = tateyama::configuration::bootstrap_configuration::create_bootstrap_configuration(helper_->conf_file_path());
+        server_mock_ = std::make_unique<tateyama::test_utils::server_mock>("tag_test", bst_conf.digest(), sync_);
+        sync_.wait();
+    }
+
+    virtual void TearDown() {
+        helper_->tear_down();
+    }
+
+protected:
+    std::unique_ptr<directory_helper> helper_{};
+    std::unique_ptr<tateyama::test_utils::server_mock> server_mock_{};
+    boost::barrier sync_{2};
+
+    std::string run(const std::string& args) {
+        std::string command = "tgctl backup tag " + args + " --conf " + helper_->conf_file_path();
+        std::cout << command << std::endl;
+        FILE* fp = popen(command.c_str(), "r");
+        if (fp == nullptr) {
+            std::cerr << "cannot tgctl backup tag" << std::endl;
+            return {};
+        }
+        std::stringstream ss{};
+        int c{};
+        while ((c = std::fgetc(fp)) != EOF) {
+            ss << static_cast<char>(c);
+        }
+        pclose(fp);
+        return ss.str();
+    }
+
+    static void set_tag(tateyama::proto::datastore::common::Tag* tag, const std::string& name, std::uint64_t timestamp) {
+        tag->set_name(name);
+        tag->set_comment("comment of " + name);
+        tag->set_author("tsurugi");
+        tag->set_timestamp(timestamp);
+    }
+};
+
+TEST_F(tag_test, add) {
+    {
+        tateyama::proto::datastore::response::TagAdd tag_add{};
+        set_tag(tag_add.mutable_success()->mutable_tag(), "before_ddl", 1790000000000UL);
+        server_mock_->push_response(tag_add.SerializeAsString());
+    }
+    auto result = run("add before_ddl --comment \"before altering the tables\"");
+    EXPECT_NE(std::string::npos, result.find("before_ddl"));
+    EXPECT_NE(std::string::npos, result.find("tsurugi"));
+    EXPECT_NE(std::string::npos, result.find("2026-09-21T"));
+
+    EXPECT_EQ(tateyama::framework::service_id_datastore, server_mock_->component_id());
+    tateyama::proto::datastore::request::TagAdd rq{};
+    server_mock_->request_message(rq);
+    EXPECT_EQ("before_ddl", rq.name());
+    EXPECT_EQ("before altering the tables", rq.comment());
+}
+
+TEST_F(tag_test, list) {
+    {
+        tateyama::proto::datastore::response::TagList tag_list{};
+        auto* success = tag_list.mutable_success();
+        set_tag(success->add_tags(), "second", 1790000100000UL);
+        set_tag(success->add_tags(), "first", 1790000000000UL);
+        server_mock_->push_response(tag_list.SerializeAsString());
+    }
+    auto result = run("list");
+    auto first = result.find("first");
+    auto second = result.find("second");
+    ASSERT_NE(std::string::npos, first);
+    ASSERT_NE(std::string::npos, second);
+    EXPECT_LT(first, second);  // the oldest first
+    EXPECT_NE(std::string::npos, result.find("comment of first"));
+}
+
+TEST_F(tag_test, remove_not_found) {
+    {
+        tateyama::proto::datastore::response::TagRemove tag_remove{};
+        tag_remove.mutable_not_found()->set_name("missing");
+        server_mock_->push_response(tag_remove.SerializeAsString());
+    }
+    std::string command = "tgctl backup tag remove missing --conf " + helper_->conf_file_path();
+    std::cout << command << std::endl;
+    EXPECT_NE(system(command.c_str()), 0);
+
+    tateyama::proto::datastore::request::TagRemove rq{};
+    server_mock_->request_message(rq);
+    EXPECT_EQ("missing", rq.name());
+}
+
+}  // namespace tateyama::datastore
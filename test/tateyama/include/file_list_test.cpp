@@ -40,4 +40,24 @@ TEST_F(file_list_test, simple) {
                      });
 }
 
+TEST_F(file_list_test, parse) {
+    std::vector<std::string> sources{};
+    std::vector<bool> detached{};
+
+    tateyama::datastore::file_list parser{};
+    EXPECT_TRUE(parser.parse("../../test/tateyama/include/json/file_list_partial.json", [&sources, &detached](std::string&& src, std::string&&, bool det) {
+                                 sources.emplace_back(std::move(src));
+                                 detached.emplace_back(det);
+                             }));
+    ASSERT_EQ(sources.size(), 2);
+    EXPECT_EQ(sources.at(0), "example_source1");
+    EXPECT_TRUE(detached.at(0));
+    EXPECT_EQ(sources.at(1), "example_source3");
+    EXPECT_FALSE(detached.at(1));
+    EXPECT_EQ(parser.entries_parsed(), 2);
+    EXPECT_EQ(parser.entries_skipped(), 1);
+
+    EXPECT_FALSE(parser.parse("../../test/tateyama/include/json/no_such_file.json", [](std::string&&, std::string&&, bool) {}));
+}
+
 }  // namespace tateyama::testing
@@ -115,4 +115,49 @@ TEST_F(backup_on_inactive_db_test, begin) {
     EXPECT_EQ(rv, 1);
 }
 
+
+TEST_F(backup_on_inactive_db_test, offline_round_trip) {
+    std::string command;
+
+    command = "tgctl backup create ";
+    command += helper_->abs_path("backup_offline");
+    command += " --offline --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl backup" << std::endl;
+        FAIL();
+    }
+
+    // placed in the same way as the online backup
+    for (auto&& entry : std::filesystem::directory_iterator(helper_->abs_path("backup_offline"))) {
+        EXPECT_TRUE(entry.is_regular_file()) << entry.path();
+    }
+
+    command = "tgctl restore backup ";
+    command += helper_->abs_path("backup_offline");
+    command += " --conf ";
+    command += helper_->conf_file_path();
+    command += " --force";
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl restore" << std::endl;
+        FAIL();
+    }
+
+    command = "tgctl start --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl start" << std::endl;
+        FAIL();
+    }
+    helper_->confirm_started();
+
+    command = "tgctl shutdown --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    EXPECT_EQ(system(command.c_str()), 0);
+}
+
 }  // namespace tateyama::testing
@@ -115,4 +115,38 @@ TEST_F(backup_test, begin) {
     EXPECT_EQ(rv, 1);
 }
 
+
+TEST_F(backup_test, parallel) {
+    std::string command;
+    FILE *fp;
+    int l;
+    int rv;
+
+    // the files copied and the progress are recorded from the threads copying the files
+    command = "tgctl backup create ";
+    command += helper_->abs_path("backup_parallel");
+    command += " --parallel 4 --conf ";
+    command += helper_->conf_file_path();
+    command += " --monitor ";
+    command += helper_->abs_path("test/backup_parallel.log");
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl backup" << std::endl;
+        FAIL();
+    }
+    EXPECT_TRUE(validate_json(helper_->abs_path("test/backup_parallel.log")));
+
+    command = "grep file_copy ";
+    command += helper_->abs_path("test/backup_parallel.log");
+    command += " | wc -l ";
+    std::cout << command << std::endl;
+    if((fp = popen(command.c_str(), "r")) == nullptr){
+        std::cerr << "cannot wc" << std::endl;
+    }
+
+    rv = fscanf(fp, "%d", &l);
+    EXPECT_TRUE(l >= 1);
+    EXPECT_EQ(rv, 1);
+}
+
 }  // namespace tateyama::testing
@@ -96,4 +96,100 @@ TEST_F(restore_test, begin) {
     EXPECT_EQ(rv, 1);
 }
 
+TEST_F(restore_test, wait) {
+    std::string command;
+
+    command = "tgctl restore backup ";
+    command += helper_->abs_path("backup");
+    command += " --conf ";
+    command += helper_->conf_file_path();
+    command += " --monitor ";
+    command += helper_->abs_path("test/restore_wait.log");
+    command += " --force --wait";
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl restore" << std::endl;
+        FAIL();
+    }
+    EXPECT_TRUE(validate_json(helper_->abs_path("test/restore_wait.log")));
+
+    // start, one or more progress records and finish
+    FILE *fp;
+    command = "grep -c progress ";
+    command += helper_->abs_path("test/restore_wait.log");
+    std::cout << command << std::endl;
+    if((fp = popen(command.c_str(), "r")) == nullptr){
+        std::cerr << "cannot grep" << std::endl;
+    }
+    int l;
+    auto rv = fscanf(fp, "%d", &l);
+    EXPECT_GE(l, 1);
+    EXPECT_EQ(rv, 1);
+}
+
+#ifdef ENABLE_BACKUP_COMPRESSION
+TEST_F(restore_test, compressed_without_wait) {
+    std::string command;
+
+    command = "tgctl start --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl start" << std::endl;
+        FAIL();
+    }
+    helper_->confirm_started();
+
+    command = "tgctl backup create ";
+    command += helper_->abs_path("backup_compressed");
+    command += " --compress zstd --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    auto backup_rc = system(command.c_str());
+
+    command = "tgctl shutdown --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl shutdown" << std::endl;
+        FAIL();
+    }
+    ASSERT_EQ(backup_rc, 0);
+
+    // the staging directory must be kept until the restore finishes even without --wait
+    command = "tgctl restore backup ";
+    command += helper_->abs_path("backup_compressed");
+    command += " --conf ";
+    command += helper_->conf_file_path();
+    command += " --staging_dir ";
+    command += helper_->abs_path("staging");
+    command += " --monitor ";
+    command += helper_->abs_path("test/restore_compressed.log");
+    command += " --force";
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl restore" << std::endl;
+        FAIL();
+    }
+    EXPECT_TRUE(validate_json(helper_->abs_path("test/restore_compressed.log")));
+
+    // the progress of the restore job, which has the files restored unlike that of the decompression, is reported as tgctl has waited for it
+    FILE *fp;
+    command = "grep -c total_files ";
+    command += helper_->abs_path("test/restore_compressed.log");
+    std::cout << command << std::endl;
+    if((fp = popen(command.c_str(), "r")) == nullptr){
+        std::cerr << "cannot grep" << std::endl;
+    }
+    int l;
+    auto rv = fscanf(fp, "%d", &l);
+    EXPECT_GE(l, 1);
+    EXPECT_EQ(rv, 1);
+
+    // and the staging directory is removed after the restore
+    std::filesystem::path staging{helper_->abs_path("staging")};
+    EXPECT_TRUE(!std::filesystem::exists(staging) || std::filesystem::is_empty(staging));
+}
+#endif
+
 }  // namespace tateyama::testing
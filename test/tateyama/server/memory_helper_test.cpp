@@ -0,0 +1,85 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "test_root.h"
+
+#include "tateyama/server/memory_helper.h"
+
+namespace tateyama::server {
+
+class memory_helper_test : public ::testing::Test {
+};
+
+TEST_F(memory_helper_test, maps_line_shm) {
+    auto region = parse_maps_line("7f00a0000000-7f00a4000000 rw-s 00000000 00:1a 123                        /dev/shm/tsurugi");
+    ASSERT_TRUE(region);
+    EXPECT_EQ(region->begin, 0x7f00a0000000UL);
+    EXPECT_EQ(region->end, 0x7f00a4000000UL);
+    EXPECT_TRUE(region->writable);
+    EXPECT_TRUE(region->shared);
+    EXPECT_EQ(region->path, "/dev/shm/tsurugi");
+}
+
+TEST_F(memory_helper_test, maps_line_anonymous) {
+    auto region = parse_maps_line("55d0a000-55d0c000 r--p 00000000 00:00 0 ");
+    ASSERT_TRUE(region);
+    EXPECT_FALSE(region->writable);
+    EXPECT_FALSE(region->shared);
+    EXPECT_TRUE(region->path.empty());
+}
+
+TEST_F(memory_helper_test, maps_line_malformed) {
+    EXPECT_FALSE(parse_maps_line(""));
+    EXPECT_FALSE(parse_maps_line("55d0a000 rw-p 00000000 00:00 0"));
+    EXPECT_FALSE(parse_maps_line("55d0c000-55d0a000 rw-p 00000000 00:00 0"));
+    EXPECT_FALSE(parse_maps_line("55d0a000-55d0c000 rw-p"));
+}
+
+
+TEST_F(memory_helper_test, backing_regions) {
+    std::vector<memory_region> regions{};
+    for (auto line : {
+            "55d0a000-55d0c000 rw-p 00000000 00:00 0                          [heap]",
+            "7f0000000000-7f0000001000 ---p 00000000 00:00 0 ",
+            "7f0000001000-7f0000801000 rw-p 00000000 00:00 0 ",  // the stack of a thread above its guard page
+            "7f0000900000-7f0000a00000 rw-p 00000000 00:00 0 ",
+            "7f0000a00000-7f0000b00000 r--p 00000000 00:00 0 ",
+            "7f00a0000000-7f00a4000000 rw-s 00000000 00:1a 123                        /dev/shm/tsurugi",
+            "7f00b0000000-7f00b4000000 rw-s 00000000 00:1a 124                        /dev/shm/other",
+            "7ffc00000000-7ffc00021000 rw-p 00000000 00:00 0                          [stack]",
+        }) {
+        regions.emplace_back(parse_maps_line(line).value());
+    }
+    auto selected = backing_regions(regions, "/dev/shm/tsurugi");
+    ASSERT_EQ(selected.size(), 3);
+    EXPECT_EQ(selected.at(0).path, "[heap]");
+    EXPECT_EQ(selected.at(1).begin, 0x7f0000900000UL);
+    EXPECT_EQ(selected.at(2).path, "/dev/shm/tsurugi");
+
+    // the private anonymous mapping, which can be a reservation, is not prefaulted
+    EXPECT_TRUE(prefaulted_region(selected.at(0)));
+    EXPECT_FALSE(prefaulted_region(selected.at(1)));
+    EXPECT_TRUE(prefaulted_region(selected.at(2)));
+
+    EXPECT_EQ(backing_regions(regions, "").size(), 2);
+}
+
+TEST_F(memory_helper_test, memlock_limit) {
+    EXPECT_TRUE(memlock_limit_sufficient(RLIM_INFINITY, 64UL << 30U));
+    EXPECT_TRUE(memlock_limit_sufficient(64UL << 30U, 64UL << 30U));
+    EXPECT_FALSE(memlock_limit_sufficient(8UL << 20U, 64UL << 30U));
+}
+
+}  // namespace tateyama::server
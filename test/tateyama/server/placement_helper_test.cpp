@@ -0,0 +1,61 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "test_root.h"
+
+#include "tateyama/server/placement_helper.h"
+
+namespace tateyama::server {
+
+class placement_helper_test : public ::testing::Test {
+};
+
+TEST_F(placement_helper_test, id_list) {
+    auto ids = parse_id_list("0-3,8, 10-11", CPU_SETSIZE);
+    ASSERT_TRUE(ids);
+    EXPECT_EQ(ids.value(), (std::set<std::size_t>{0, 1, 2, 3, 8, 10, 11}));
+
+    ids = parse_id_list("5", CPU_SETSIZE);
+    ASSERT_TRUE(ids);
+    EXPECT_EQ(ids.value(), (std::set<std::size_t>{5}));
+}
+
+TEST_F(placement_helper_test, id_list_malformed) {
+    EXPECT_FALSE(parse_id_list("", CPU_SETSIZE));
+    EXPECT_FALSE(parse_id_list("a", CPU_SETSIZE));
+    EXPECT_FALSE(parse_id_list("3-1", CPU_SETSIZE));
+    EXPECT_FALSE(parse_id_list("1,,2", CPU_SETSIZE));
+    EXPECT_FALSE(parse_id_list("-1", CPU_SETSIZE));
+    EXPECT_FALSE(parse_id_list("1-", CPU_SETSIZE));
+}
+
+TEST_F(placement_helper_test, id_list_out_of_limit) {
+    EXPECT_TRUE(parse_id_list("0-1023", CPU_SETSIZE));
+    EXPECT_FALSE(parse_id_list("1024", CPU_SETSIZE));
+    EXPECT_FALSE(parse_id_list("0-999999999", CPU_SETSIZE));  // rejected before the range is expanded
+    EXPECT_TRUE(parse_id_list("0-3", max_numa_nodes));
+    EXPECT_FALSE(parse_id_list("0,1024", max_numa_nodes));
+}
+
+TEST_F(placement_helper_test, memory_policy) {
+    EXPECT_EQ(numa_memory_policy_mode(""), MPOL_DEFAULT);
+    EXPECT_EQ(numa_memory_policy_mode("default"), MPOL_DEFAULT);
+    EXPECT_EQ(numa_memory_policy_mode("bind"), MPOL_BIND);
+    EXPECT_EQ(numa_memory_policy_mode("preferred"), MPOL_PREFERRED);
+    EXPECT_EQ(numa_memory_policy_mode("interleave"), MPOL_INTERLEAVE);
+    EXPECT_FALSE(numa_memory_policy_mode("local"));
+}
+
+}  // namespace tateyama::server
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "test_root.h"
+
+#include "tateyama/sql/record_reader.h"
+
+namespace tateyama::sql {
+
+class record_reader_test : public ::testing::Test {
+};
+
+TEST_F(record_reader_test, file_names) {
+    record_reader reader{};
+    std::string long_name(100, 'f');
+    std::string chunk{};
+    chunk += "\x80\x43" "a.pq";              // a row of an embedded character
+    chunk += "\x80\xf0\x64" + long_name;     // a row of a character with the length
+    chunk += "\x81\xe8\x05";                 // a row of null and an embedded integer
+    chunk += "\xff";                         // end of contents
+    reader.append(chunk);
+
+    std::vector<column_value> record{};
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_EQ(record.size(), 1);
+    EXPECT_EQ(std::get<std::string>(record.at(0)), "a.pq");
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(std::get<std::string>(record.at(0)), long_name);
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_EQ(record.size(), 2);
+    EXPECT_TRUE(std::holds_alternative<std::monostate>(record.at(0)));
+    EXPECT_EQ(std::get<std::int64_t>(record.at(1)), 5);
+    EXPECT_FALSE(reader.next(record));
+    EXPECT_TRUE(reader.end_of_contents());
+}
+
+TEST_F(record_reader_test, split_record) {
+    record_reader reader{};
+    std::vector<column_value> record{};
+    reader.append("\x80\xe9");
+    EXPECT_FALSE(reader.next(record));
+    reader.append("\xc3\x01");  // 195 in zigzag encoding is -98
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(std::get<std::int64_t>(record.at(0)), -98);
+    EXPECT_FALSE(reader.has_remaining());
+}
+
+TEST_F(record_reader_test, unsupported) {
+    record_reader reader{};
+    std::vector<column_value> record{};
+    reader.append("\x80\xea");  // float4
+    EXPECT_THROW(reader.next(record), std::runtime_error);
+}
+
+TEST_F(record_reader_test, split_statements) {
+    auto statements = split_statements(" SELECT * FROM a;\nselect ';' from b -- c;\n; /* d; */ ;select \"e;\" from f; -- end");
+    ASSERT_EQ(statements.size(), 3);
+    EXPECT_EQ(statements.at(0), "SELECT * FROM a");
+    EXPECT_EQ(statements.at(1), "select ';' from b -- c;");
+    EXPECT_EQ(statements.at(2), "select \"e;\" from f");
+}
+
+}  // namespace tateyama::sql
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unistd.h>
+#include <sstream>
+#include "test_root.h"
+
+namespace tateyama::testing {
+
+class tgctl_diagnostic_test : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        helper_ = std::make_unique<directory_helper>("tgctl_diagnostic_test", 20105);
+        pid_directory_ = helper_->abs_path("pid");
+        helper_->set_up("[system]\npid_directory=" + pid_directory_ + "\n");
+        std::filesystem::create_directories(pid_directory_);
+    }
+
+    virtual void TearDown() {
+        helper_->tear_down();
+    }
+
+protected:
+    std::unique_ptr<directory_helper> helper_{};
+    std::string pid_directory_{};
+
+    std::string read_file(const std::string& file) {
+        std::ifstream strm(file);
+        std::stringstream ss{};
+        ss << strm.rdbuf();
+        return ss.str();
+    }
+
+    std::size_t diagnostic_files() {
+        std::size_t count = 0;
+        for (auto&& entry : std::filesystem::directory_iterator(pid_directory_)) {
+            if (entry.path().filename().string().find("-diagnostic-") != std::string::npos) {
+                count++;
+            }
+        }
+        return count;
+    }
+};
+
+TEST_F(tgctl_diagnostic_test, basic) {
+    std::string command;
+
+    command = "tgctl start --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl start" << std::endl;
+        FAIL();
+    }
+    helper_->confirm_started();
+
+    command = "tgctl pid --conf ";
+    command += helper_->conf_file_path();
+    command += " > ";
+    command += helper_->abs_path("test/pid.log");
+    std::cout << command << std::endl;
+    EXPECT_EQ(system(command.c_str()), 0);
+    auto pid = read_file(helper_->abs_path("test/pid.log"));
+    pid.erase(pid.find_last_not_of('\n') + 1);
+
+    // taken twice in a row, each of which must be answered with its own file
+    for (int i = 0; i < 2; i++) {
+        command = "tgctl diagnostic --conf ";
+        command += helper_->conf_file_path();
+        command += " > ";
+        command += helper_->abs_path("test/diagnostic.log");
+        std::cout << command << std::endl;
+        EXPECT_EQ(system(command.c_str()), 0);
+        EXPECT_EQ(read_file(helper_->abs_path("test/diagnostic.log")).rfind("diagnostics of tsurugidb (pid " + pid + ")", 0), 0);
+    }
+
+    // taken at the same time, neither of which must be lost
+    command = "tgctl diagnostic --timeout 30 --conf ";
+    command += helper_->conf_file_path();
+    command += " > ";
+    command += helper_->abs_path("test/diagnostic_1.log");
+    command += " & tgctl diagnostic --timeout 30 --conf ";
+    command += helper_->conf_file_path();
+    command += " > ";
+    command += helper_->abs_path("test/diagnostic_2.log");
+    command += "; r=$?; wait $! && exit $r";
+    std::cout << command << std::endl;
+    EXPECT_EQ(system(command.c_str()), 0);
+    for (auto&& log : {"test/diagnostic_1.log", "test/diagnostic_2.log"}) {
+        EXPECT_EQ(read_file(helper_->abs_path(log)).rfind("diagnostics of tsurugidb (pid " + pid + ")", 0), 0);
+    }
+
+    // the files are removed once tgctl has printed them
+    EXPECT_EQ(diagnostic_files(), 0);
+
+    command = "tgctl shutdown --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl shutdown" << std::endl;
+        FAIL();
+    }
+}
+
+TEST_F(tgctl_diagnostic_test, not_running) {
+    std::string command;
+
+    command = "tgctl diagnostic --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    EXPECT_NE(system(command.c_str()), 0);
+}
+
+}  // namespace tateyama::testing
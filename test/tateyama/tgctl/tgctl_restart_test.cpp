@@ -0,0 +1,101 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <unistd.h>
+#include "test_root.h"
+
+namespace tateyama::testing {
+
+class tgctl_restart_test : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        helper_ = std::make_unique<directory_helper>("tgctl_restart_test", 20103);
+        helper_->set_up();
+    }
+
+    virtual void TearDown() {
+        helper_->tear_down();
+    }
+
+protected:
+    std::unique_ptr<directory_helper> helper_{};
+
+    int count_lines(const std::string& pattern, const std::string& file) {
+        FILE *fp;
+        std::string command = "grep '" + pattern + "' " + file + " | wc -l";
+        std::cout << command << std::endl;
+        if((fp = popen(command.c_str(), "r")) == nullptr){
+            std::cerr << "cannot grep and wc" << std::endl;
+            return -1;
+        }
+        int l;
+        auto rv = fscanf(fp, "%d", &l);
+        pclose(fp);
+        return rv == 1 ? l : -1;
+    }
+};
+
+TEST_F(tgctl_restart_test, running) {
+    std::string command;
+
+    command = "tgctl start --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl start" << std::endl;
+        FAIL();
+    }
+    helper_->confirm_started();
+
+    command = "tgctl restart --conf ";
+    command += helper_->conf_file_path();
+    command += " > ";
+    command += helper_->abs_path("test/restart.log");
+    std::cout << command << std::endl;
+    EXPECT_EQ(system(command.c_str()), 0);
+    helper_->confirm_started();
+    EXPECT_EQ(count_lines("successfully restarted tsurugidb, unavailable for [0-9]* ms", helper_->abs_path("test/restart.log")), 1);
+
+    command = "tgctl shutdown --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl shutdown" << std::endl;
+        FAIL();
+    }
+}
+
+TEST_F(tgctl_restart_test, not_running) {
+    std::string command;
+
+    command = "tgctl restart --conf ";
+    command += helper_->conf_file_path();
+    command += " > ";
+    command += helper_->abs_path("test/restart.log");
+    std::cout << command << std::endl;
+    EXPECT_EQ(system(command.c_str()), 0);
+    helper_->confirm_started();
+    EXPECT_EQ(count_lines("successfully launched tsurugidb", helper_->abs_path("test/restart.log")), 1);
+
+    command = "tgctl shutdown --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl shutdown" << std::endl;
+        FAIL();
+    }
+}
+
+}  // namespace tateyama::testing
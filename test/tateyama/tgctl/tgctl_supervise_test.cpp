@@ -0,0 +1,213 @@
+/*
+ * Copyright 2026-2026 Project Tsurugi.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <csignal>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+#include "test_root.h"
+
+namespace tateyama::testing {
+
+class tgctl_supervise_test : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        helper_ = std::make_unique<directory_helper>("tgctl_supervise_test", 20104);
+        helper_->set_up();
+    }
+
+    virtual void TearDown() {
+        helper_->tear_down();
+    }
+
+protected:
+    std::unique_ptr<directory_helper> helper_{};
+
+    int count_lines(const std::string& pattern, const std::string& file) {
+        FILE *fp;
+        std::string command = "grep '" + pattern + "' " + file + " | wc -l";
+        std::cout << command << std::endl;
+        if((fp = popen(command.c_str(), "r")) == nullptr){
+            std::cerr << "cannot grep and wc" << std::endl;
+            return -1;
+        }
+        int l;
+        auto rv = fscanf(fp, "%d", &l);
+        pclose(fp);
+        return rv == 1 ? l : -1;
+    }
+
+    pid_t server_pid() {
+        FILE *fp;
+        std::string command = "tgctl pid --conf " + helper_->conf_file_path();
+        std::cout << command << std::endl;
+        if((fp = popen(command.c_str(), "r")) == nullptr){
+            std::cerr << "cannot tgctl pid" << std::endl;
+            return 0;
+        }
+        int pid;
+        auto rv = fscanf(fp, "%d", &pid);
+        pclose(fp);
+        return rv == 1 ? pid : 0;
+    }
+
+    std::string command_line(pid_t pid) {
+        std::ifstream cmdline("/proc/" + std::to_string(pid) + "/cmdline");
+        std::string args{std::istreambuf_iterator<char>(cmdline), std::istreambuf_iterator<char>()};
+        std::replace(args.begin(), args.end(), '\0', ' ');
+        return args;
+    }
+
+    bool wait_for_event(const std::string& event, const std::string& file) {
+        for (std::size_t i = 0; i < 200; i++) {
+            if (count_lines("\"event\": \"" + event + "\"", file) > 0) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        return false;
+    }
+};
+
+TEST_F(tgctl_supervise_test, relaunch_after_crash) {
+    std::string command;
+    std::string supervisor_log = helper_->abs_path("test/supervisor.log");
+
+    command = "tgctl start --supervise --conf ";
+    command += helper_->conf_file_path();
+    command += " --supervisor_monitor ";
+    command += supervisor_log;
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl start" << std::endl;
+        FAIL();
+    }
+    helper_->confirm_started();
+    EXPECT_TRUE(wait_for_event("started", supervisor_log));
+
+    auto pid = server_pid();
+    ASSERT_NE(pid, 0);
+    kill(pid, SIGKILL);
+
+    EXPECT_TRUE(wait_for_event("crashed", supervisor_log));
+    EXPECT_TRUE(wait_for_event("relaunched", supervisor_log));
+    helper_->confirm_started();
+    EXPECT_NE(server_pid(), pid);
+
+    command = "tgctl shutdown --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl shutdown" << std::endl;
+        FAIL();
+    }
+    EXPECT_TRUE(wait_for_event("stopped", supervisor_log));
+    EXPECT_TRUE(validate_json(supervisor_log));
+}
+
+TEST_F(tgctl_supervise_test, shutdown) {
+    std::string command;
+    std::string supervisor_log = helper_->abs_path("test/supervisor.log");
+
+    command = "tgctl start --supervise --conf ";
+    command += helper_->conf_file_path();
+    command += " --supervisor_monitor ";
+    command += supervisor_log;
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl start" << std::endl;
+        FAIL();
+    }
+    helper_->confirm_started();
+
+    command = "tgctl shutdown --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl shutdown" << std::endl;
+        FAIL();
+    }
+    EXPECT_TRUE(wait_for_event("stopped", supervisor_log));
+    EXPECT_EQ(count_lines("\"event\": \"relaunch", supervisor_log), 0);
+}
+
+TEST_F(tgctl_supervise_test, relaunch_in_the_same_mode) {
+    std::string command;
+    std::string supervisor_log = helper_->abs_path("test/supervisor.log");
+
+    command = "tgctl start --supervise --quiesce --conf ";
+    command += helper_->conf_file_path();
+    command += " --supervisor_monitor ";
+    command += supervisor_log;
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl start" << std::endl;
+        FAIL();
+    }
+    helper_->confirm_started();
+    EXPECT_TRUE(wait_for_event("started", supervisor_log));
+
+    auto pid = server_pid();
+    ASSERT_NE(pid, 0);
+    EXPECT_NE(command_line(pid).find("--quiesce"), std::string::npos);
+    kill(pid, SIGKILL);
+
+    EXPECT_TRUE(wait_for_event("relaunched", supervisor_log));
+    helper_->confirm_started();
+    auto relaunched = server_pid();
+    ASSERT_NE(relaunched, 0);
+    EXPECT_NE(relaunched, pid);
+    EXPECT_NE(command_line(relaunched).find("--quiesce"), std::string::npos);
+
+    command = "tgctl shutdown --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl shutdown" << std::endl;
+        FAIL();
+    }
+    EXPECT_TRUE(wait_for_event("stopped", supervisor_log));
+}
+
+TEST_F(tgctl_supervise_test, start_through_pipe) {
+    std::string command;
+    std::string supervisor_log = helper_->abs_path("test/supervisor.log");
+
+    // the supervisor does not hold the pipe, so that the reader of the pipe finishes with tgctl start
+    command = "timeout 60 sh -c 'tgctl start --supervise --conf ";
+    command += helper_->conf_file_path();
+    command += " --supervisor_monitor ";
+    command += supervisor_log;
+    command += " | cat'";
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl start through the pipe" << std::endl;
+        FAIL();
+    }
+    helper_->confirm_started();
+    EXPECT_TRUE(wait_for_event("started", supervisor_log));
+
+    command = "tgctl shutdown --conf ";
+    command += helper_->conf_file_path();
+    std::cout << command << std::endl;
+    if (system(command.c_str()) != 0) {
+        std::cerr << "cannot tgctl shutdown" << std::endl;
+        FAIL();
+    }
+    EXPECT_TRUE(wait_for_event("stopped", supervisor_log));
+}
+
+}  // namespace tateyama::testing